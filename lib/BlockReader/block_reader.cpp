@@ -0,0 +1,123 @@
+#include "block_reader.h"
+#include <string.h>
+
+// ==========================================
+// CHARGEMENT DES BLOCS
+// ==========================================
+void BlockReader::begin(BlockReadFn read, void* readContext, uint32_t start, uint32_t endOffset) {
+    readFn = read;
+    context = readContext;
+    end = endOffset;
+    nextOffset = start - start % BLOCK_SIZE;
+    blockOffset[0] = blockOffset[1] = nextOffset;
+    blockLength[0] = blockLength[1] = 0;
+    current = 0;
+    pos = 0;
+    partial = false;
+    
+    if (start < end && load(current)) {
+        pos = start - blockOffset[current];
+    }
+}
+
+bool BlockReader::load(uint8_t slot) {
+    if (nextOffset >= end) return false;
+    
+    size_t wanted = end - nextOffset < BLOCK_SIZE ? end - nextOffset : BLOCK_SIZE;
+    size_t got = readFn(context, nextOffset, blocks[slot], wanted);
+    if (got == 0) {
+        end = nextOffset;               // Erreur de lecture : fin anticipée
+        return false;
+    }
+    blockOffset[slot] = nextOffset;
+    blockLength[slot] = got;
+    nextOffset += got;
+    return true;
+}
+
+bool BlockReader::prefetch() {
+    uint8_t spare = current ^ 1;
+    return blockLength[spare] == 0 && load(spare);
+}
+
+bool BlockReader::advance() {
+    uint8_t spare = current ^ 1;
+    if (blockLength[spare] == 0 && !load(spare)) return false;
+    blockLength[current] = 0;
+    current = spare;
+    pos = 0;
+    return true;
+}
+
+// ==========================================
+// LECTURE
+// ==========================================
+bool BlockReader::nextLine(const char** out, size_t* length) {
+    size_t copied = 0;
+    partial = false;
+    
+    for (;;) {
+        if (pos >= blockLength[current] && !advance()) {
+            // Dernière ligne sans '\n'
+            if (copied == 0) return false;
+            break;
+        }
+        
+        const uint8_t* start = blocks[current] + pos;
+        size_t available = blockLength[current] - pos;
+        const uint8_t* newline = (const uint8_t*)memchr(start, '\n', available);
+        size_t span = newline ? newline - start : available;
+        
+        // Ligne entière dans le bloc : rendue sans copie
+        if (newline && copied == 0) {
+            pos += span + 1;
+            *out = (const char*)start;
+            *length = span;
+            return true;
+        }
+        
+        // À cheval sur deux blocs : recopiée, par morceaux de BLOCK_LINE_MAX octets
+        size_t room = BLOCK_LINE_MAX - copied;
+        if (span > room) {
+            memcpy(line + copied, start, room);
+            pos += room;
+            copied += room;
+            partial = true;
+            break;
+        }
+        memcpy(line + copied, start, span);
+        pos += span + (newline ? 1 : 0);
+        copied += span;
+        if (newline) break;
+    }
+    
+    *out = line;
+    *length = copied;
+    return true;
+}
+
+bool BlockReader::readLine(char* out, size_t capacity) {
+    const char* piece;
+    size_t length;
+    if (!nextLine(&piece, &length)) return false;
+    
+    bool tooLong = partial || length >= capacity;
+    while (partial && nextLine(&piece, &length)) {}
+    if (tooLong) length = 0;
+    memcpy(out, piece, length);
+    out[length] = '\0';
+    return true;
+}
+
+size_t BlockReader::read(uint8_t* out, size_t length) {
+    size_t copied = 0;
+    while (copied < length) {
+        if (pos >= blockLength[current] && !advance()) break;
+        size_t available = blockLength[current] - pos;
+        size_t span = length - copied < available ? length - copied : available;
+        memcpy(out + copied, blocks[current] + pos, span);
+        pos += span;
+        copied += span;
+    }
+    return copied;
+}
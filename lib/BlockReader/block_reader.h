@@ -0,0 +1,72 @@
+#ifndef BLOCK_READER_H
+#define BLOCK_READER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ==========================================
+// LECTURE PAR BLOCS (export des fichiers SD)
+// ==========================================
+// Le fichier est lu par secteurs de BLOCK_SIZE octets alignés sur leur
+// position dans le fichier, dans deux tampons : pendant qu'un bloc est
+// consommé, le suivant peut être chargé par prefetch() (pendant la pause
+// entre deux notifications, par exemple). Les lignes sont rendues par
+// pointeur dans le bloc courant ; seule une ligne à cheval sur deux blocs
+// est recopiée.
+//
+// La lecture passe par une fonction fournie par l'appelant (SD sur la carte,
+// mémoire pour les tests natifs).
+
+#define BLOCK_SIZE 512
+#define BLOCK_LINE_MAX 128              // Ligne à cheval la plus longue rendue en un morceau
+
+// Lit length octets à offset (multiple de BLOCK_SIZE) ; retourne le nombre lu
+typedef size_t (*BlockReadFn)(void* context, uint32_t offset, uint8_t* buffer, size_t length);
+
+class BlockReader {
+public:
+    // Lecture de [start, end) ; le premier bloc est chargé tout de suite
+    void begin(BlockReadFn read, void* context, uint32_t start, uint32_t end);
+    
+    // Charge le bloc suivant dans le tampon libre ; false s'il n'y a rien à charger
+    bool prefetch();
+    
+    // Ligne suivante, sans son '\n' (un '\r' final est conservé : les octets
+    // du fichier sont rendus tels quels). Une ligne à cheval sur deux blocs
+    // de plus de BLOCK_LINE_MAX octets est rendue en plusieurs morceaux :
+    // lineContinues() indique que la suite vient à l'appel suivant.
+    // Le pointeur reste valide jusqu'à l'appel suivant. false à la fin.
+    bool nextLine(const char** line, size_t* length);
+    
+    // Le dernier morceau rendu par nextLine() n'est pas la fin de sa ligne
+    bool lineContinues() const { return partial; }
+    
+    // Ligne suivante recopiée dans out, terminée par '\0'. Une ligne plus
+    // longue que le tampon est consommée entière et rendue vide (illisible).
+    bool readLine(char* out, size_t capacity);
+    
+    // Copie jusqu'à length octets ; retourne le nombre copié (0 à la fin)
+    size_t read(uint8_t* out, size_t length);
+    
+    // Position du prochain octet rendu
+    uint32_t position() const { return blockOffset[current] + pos; }
+    
+private:
+    // Bloc courant épuisé : passe au suivant (chargé s'il ne l'est pas encore)
+    bool advance();
+    bool load(uint8_t slot);
+    
+    BlockReadFn readFn;
+    void* context;
+    uint32_t end;
+    uint32_t nextOffset;                // Prochain bloc à charger
+    uint8_t blocks[2][BLOCK_SIZE];
+    uint32_t blockOffset[2];
+    uint16_t blockLength[2];            // 0 = tampon libre
+    uint8_t current;
+    uint16_t pos;                       // Position dans le bloc courant
+    bool partial;                       // Morceau d'une ligne trop longue
+    char line[BLOCK_LINE_MAX];
+};
+
+#endif
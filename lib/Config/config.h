@@ -39,6 +39,31 @@
 #define SLEEP_TIME_US (SLEEP_TIME_MINUTES * 60 * 1000000ULL)  // Conversion en microsecondes
 #define BLE_SCAN_TIME 10                                // Temps de scan BLE en secondes (maître)
 #define BLE_ADVERTISE_TIME 15                           // Temps de diffusion BLE en secondes (esclave)
+#define BLE_SCAN_INTERVAL_MS 100                        // Intervalle de scan en ms (maître)
+#define BLE_SCAN_WINDOW_MS 99                           // Fenêtre de scan en ms, <= intervalle (maître)
+#define BLE_SCAN_MODE 2                                 // 0 = passif, 1 = actif, 2 = actif jusqu'à connaître tous les esclaves
+
+// ==========================================
+// TRANSPORT ESCLAVES -> MAÎTRE
+// ==========================================
+#define TRANSPORT_BLE 0                                 // Scan + connexion GATT
+#define TRANSPORT_ESPNOW 1                              // Trame unique acquittée, sans connexion
+#define SLAVE_TRANSPORT TRANSPORT_BLE
+#define ESPNOW_CHANNEL 1                                // Canal WiFi commun maître/esclaves
+#define ESPNOW_LISTEN_MS 5000                           // Écoute du maître à chaque réveil
+#define ESPNOW_ACK_TIMEOUT_MS 30                        // Attente d'un acquittement (esclave)
+#define ESPNOW_MAX_ATTEMPTS 5                           // Envois max d'un lot (esclave)
+
+// ==========================================
+// FENÊTRE DE SYNCHRONISATION ANDROID (carte maître)
+// ==========================================
+// Le maître n'est joignable par le téléphone que pendant une fenêtre planifiée,
+// ouverte au premier réveil de chaque période et/ou aux heures fixes du masque.
+#define ANDROID_SYNC_PERIOD_MINUTES 60                  // Période des fenêtres en minutes (0 = désactivé)
+#define ANDROID_SYNC_HOURS_MASK 0x000000UL              // Heures fixes : bit n = fenêtre à n h (0 = aucune)
+#define ANDROID_WAIT_TIMEOUT_S 20                       // Durée d'un timeout d'attente (fenêtre = MAX_TIMEOUT_COUNT timeouts)
+#define ANDROID_ADV_FAST_MIN_INTERVAL 0x20              // Intervalle d'advertising rapide min (x 0.625 ms = 20 ms)
+#define ANDROID_ADV_FAST_MAX_INTERVAL 0x30              // Intervalle d'advertising rapide max (x 0.625 ms = 30 ms)
 
 // ==========================================
 // UUIDs BLE
@@ -53,6 +78,15 @@
 #define HUMID_CHARACTERISTIC_UUID "72A7B435-989D-4369-8F58-D6E98B4AB262"
 #define OXY_CHARACTERISTIC_UUID "759E38A8-BB58-4F70-96EB-A4BDCEC3977A"
 
+// Lot de mesures mémorisées (lecture) et acquittement par numéro de séquence (écriture)
+#define BATCH_CHARACTERISTIC_UUID "3C1A7E52-5B0D-4F0B-9C2E-8E6A1D4B7F10"
+#define BATCH_ACK_CHARACTERISTIC_UUID "3C1A7E53-5B0D-4F0B-9C2E-8E6A1D4B7F10"
+
+// Service de configuration des esclaves (écrit par le maître, valeurs en hexadécimal)
+#define SLAVE_CONFIG_SERVICE_UUID "9D818D7B-A445-46F5-8A3F-B9F86EA5DE2F"
+#define SLEEP_TIME_CHARACTERISTIC_UUID "CEF11275-083B-4027-AD0E-0DDB904278A5"       // Durée de sommeil (µs)
+#define ADVERTISE_TIME_CHARACTERISTIC_UUID "CEF11276-083B-4027-AD0E-0DDB904278A5"   // Durée d'advertising (s)
+
 // Service UUID pour l'accès aux données (carte maître vers Android)
 #define ANDROID_SERVICE_UUID    "6e400001-b5a3-f393-e0a9-e50e24dcca9e"
 #define ANDROID_CHAR_TX_UUID    "6e400002-b5a3-f393-e0a9-e50e24dcca9e"  // Maître -> Android
@@ -82,6 +116,55 @@
 // ==========================================
 #define SD_FILENAME "/compost_data.csv"
 
+// Rétention par carte (jours, réglables par SET) : au-delà de l'horizon d'un
+// niveau, les mesures passent au niveau suivant (brut -> moyennes horaires ->
+// moyennes journalières). 0 pour le journalier = conservé indéfiniment.
+#define RETENTION_RAW_DAYS 31
+#define RETENTION_HOURLY_DAYS 92
+#define RETENTION_DAILY_DAYS 0
+
+// Prévision de retournement (lib/Forecast) : heure à laquelle la température
+// d'un bac passera sous son seuil (°C, réglable par SET, 0 = pas de prévision)
+#define FORECAST_TURN_TEMP_C 45
+#define FORECAST_ALPHA 0.3f             // Poids de la nouvelle mesure dans le niveau
+#define FORECAST_BETA 0.05f             // Poids de la nouvelle pente
+#define FORECAST_MIN_READINGS 12        // Mesures avant de publier une prévision
+
+// ==========================================
+// ACQUISITION CAPTEURS (cartes esclaves)
+// ==========================================
+#define SENSOR_BURST_COUNT 5            // Mesures forcées par réveil (1 = mesure unique)
+#define SENSOR_BURST_BUDGET_MS 80       // Budget temps max de la rafale BME280
+#define SENSOR_IIR_ALPHA 0.5f           // Filtre exponentiel sur la rafale (1.0 = dernière mesure)
+#define OXYGEN_BURST_COUNT 1            // Lectures O2 par réveil, après la rafale BME280 (> 1 : bruit estimé)
+#define OXYGEN_BURST_BUDGET_MS 250      // Budget des lectures O2 (le pilote SEN0322 attend à chaque lecture)
+
+// Mémoire tampon des mesures (RTC) et envoi par lots
+#define SLAVE_BUFFER_CAPACITY 48        // Mesures conservées (48 = 24 h à 30 min)
+#define SLAVE_UPLOAD_EVERY_K 4          // Advertising tous les K réveils
+#define SLAVE_UPLOAD_HIGH_WATER 40      // ... ou dès que le tampon atteint ce remplissage
+
+// Rôle relais (build flag -DSLAVE_RELAY) : l'esclave écoute les esclaves hors
+// de portée du maître et ajoute leurs mesures à son propre envoi
+#define RELAY_BUFFER_CAPACITY 48        // Mesures relayées conservées (RTC)
+#define RELAY_LISTEN_MS 3000            // Écoute des esclaves éloignés avant l'envoi
+#define RELAY_MAX_HOPS 3                // Au-delà, le lot est ignoré (boucle de relais)
+
+// ==========================================
+// BATTERIE ET MODES D'ÉNERGIE (toutes les cartes)
+// ==========================================
+// Tension batterie via un pont diviseur sur une entrée ADC1 (utilisable avec
+// la radio active). Seuils pour un accumulateur Li-ion 1S.
+#define BATTERY_MONITOR 1                       // 0 = pas de mesure (mode normal permanent)
+#define BATTERY_ADC_PIN 35
+#define BATTERY_DIVIDER_RATIO 2.0f              // Vbat / Vadc
+#define BATTERY_SAMPLES 8                       // Lectures moyennées par réveil
+#define BATTERY_FILTER_ALPHA 0.3f               // Filtre exponentiel entre réveils
+#define BATTERY_ECO_MV 3600                     // Sous ce seuil : mode eco
+#define BATTERY_CRITICAL_MV 3450                // ... critical (plus d'O2 ni d'Android)
+#define BATTERY_SURVIVAL_MV 3300                // ... survival
+#define BATTERY_HYSTERESIS_MV 50                // Marge avant de remonter d'un mode
+
 // ==========================================
 // SEUILS ET CALIBRATION
 // ==========================================
@@ -93,6 +176,7 @@
 // DEBUG
 // ==========================================
 #define SERIAL_BAUD 115200
+#define METRICS_SERIAL_EXPORT 1     // Export des métriques sur le port série en fin de cycle
 
 
 #ifdef DEBUG
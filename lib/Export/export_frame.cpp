@@ -0,0 +1,90 @@
+#include "export_frame.h"
+#include <stdlib.h>
+#include <string.h>
+
+// ==========================================
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+// ==========================================
+uint16_t crc16Ccitt(const uint8_t* data, size_t length, uint16_t crc) {
+    for (size_t i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+// ==========================================
+// TRAMES
+// ==========================================
+size_t buildExportFrame(uint8_t* out, uint16_t transferId, uint16_t seq, bool last,
+                        const uint8_t* payload, size_t length) {
+    ExportFrameHeader header;
+    header.magic = EXPORT_FRAME_MAGIC;
+    header.flags = last ? EXPORT_FRAME_LAST : 0;
+    header.transferId = transferId;
+    header.seq = seq;
+    header.crc = 0;
+    
+    // Données déjà en place (lues directement dans la trame) : rien à recopier
+    memcpy(out, &header, sizeof(header));
+    if (payload != out + sizeof(header)) {
+        memmove(out + sizeof(header), payload, length);
+    }
+    
+    uint16_t crc = crc16Ccitt(out, sizeof(header) + length);
+    memcpy(out + offsetof(ExportFrameHeader, crc), &crc, sizeof(crc));
+    return sizeof(header) + length;
+}
+
+bool parseExportFrame(const uint8_t* frame, size_t length, ExportFrameHeader* header,
+                      const uint8_t** payload, size_t* payloadLength) {
+    if (length < sizeof(ExportFrameHeader) || frame[0] != EXPORT_FRAME_MAGIC) return false;
+    
+    memcpy(header, frame, sizeof(*header));
+    uint16_t crc = crc16Ccitt(frame, offsetof(ExportFrameHeader, crc));
+    const uint8_t zero[2] = {0, 0};
+    crc = crc16Ccitt(zero, sizeof(zero), crc);
+    crc = crc16Ccitt(frame + sizeof(ExportFrameHeader), length - sizeof(ExportFrameHeader), crc);
+    if (crc != header->crc) return false;
+    
+    *payload = frame + sizeof(ExportFrameHeader);
+    *payloadLength = length - sizeof(ExportFrameHeader);
+    return true;
+}
+
+// ==========================================
+// PLAGES DE RETRANSMISSION
+// ==========================================
+int parseSeqRanges(const char* text, SeqRange* ranges, int maxRanges) {
+    int count = 0;
+    const char* p = text;
+    
+    while (*p != '\0') {
+        if (count == maxRanges) return -1;
+        
+        char* end;
+        unsigned long first = strtoul(p, &end, 10);
+        if (end == p || first > UINT16_MAX) return -1;
+        unsigned long last = first;
+        p = end;
+        
+        if (*p == '-') {
+            last = strtoul(p + 1, &end, 10);
+            if (end == p + 1 || last > UINT16_MAX || last < first) return -1;
+            p = end;
+        }
+        
+        ranges[count].first = (uint16_t)first;
+        ranges[count].last = (uint16_t)last;
+        count++;
+        
+        if (*p == ',') {
+            p++;
+        } else if (*p != '\0') {
+            return -1;
+        }
+    }
+    return count;
+}
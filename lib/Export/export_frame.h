@@ -0,0 +1,53 @@
+#ifndef EXPORT_FRAME_H
+#define EXPORT_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ==========================================
+// TRAMES D'EXPORT (maître -> Android)
+// ==========================================
+// Commande EXPORT : le maître écrit le flux texte de READ dans un fichier
+// d'export, puis l'envoie en trames de taille fixe (choisie d'après le MTU
+// au début du transfert). La trame seq porte les octets
+// [seq * payload, (seq + 1) * payload) du fichier : toute trame peut être
+// renvoyée, même après une déconnexion ou un réveil suivant.
+//
+//   magic (0xFE) | flags | transferId | seq | crc | données
+//
+// Le CRC-16/CCITT-FALSE couvre l'en-tête (crc à 0) et les données. Les
+// réponses JSON ('{') et les trames (0xFE, jamais en tête d'un texte UTF-8)
+// partagent la caractéristique TX. Champs en little-endian.
+
+#define EXPORT_FRAME_MAGIC 0xFE
+#define EXPORT_FRAME_LAST 0x01          // Dernière trame du transfert
+
+struct __attribute__((packed)) ExportFrameHeader {
+    uint8_t magic;
+    uint8_t flags;
+    uint16_t transferId;
+    uint16_t seq;
+    uint16_t crc;
+};
+
+uint16_t crc16Ccitt(const uint8_t* data, size_t length, uint16_t crc = 0xFFFF);
+
+// Construit une trame dans out (sizeof(ExportFrameHeader) + length octets).
+// payload peut déjà se trouver à out + sizeof(ExportFrameHeader) (trame en place).
+size_t buildExportFrame(uint8_t* out, uint16_t transferId, uint16_t seq, bool last,
+                        const uint8_t* payload, size_t length);
+
+// Vérifie une trame reçue (magic, CRC) ; false si elle est invalide
+bool parseExportFrame(const uint8_t* frame, size_t length, ExportFrameHeader* header,
+                      const uint8_t** payload, size_t* payloadLength);
+
+// Plage de trames à renvoyer (bornes incluses)
+struct SeqRange {
+    uint16_t first;
+    uint16_t last;
+};
+
+// "12-15,20,31-33" -> plages ; retourne leur nombre, -1 si le texte est invalide
+int parseSeqRanges(const char* text, SeqRange* ranges, int maxRanges);
+
+#endif
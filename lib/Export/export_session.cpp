@@ -0,0 +1,139 @@
+#include "export_session.h"
+#include <stdlib.h>
+#include <string.h>
+
+ExportSession::ExportSession(ExportTransfer& state, Storage& files, const char* exportPath)
+    : transfer(state), storage(files), path(exportPath) {}
+
+// ==========================================
+// DÉBUT ET FIN DU TRANSFERT
+// ==========================================
+bool ExportSession::start(uint32_t bytes, uint16_t payload) {
+    uint32_t frames = payload > 0 ? (bytes + payload - 1) / payload : 0;
+    if (payload == 0 || payload > EXPORT_FRAME_MAX - sizeof(ExportFrameHeader) || frames > UINT16_MAX) {
+        cancel();
+        return false;
+    }
+    
+    transfer.lastId = transfer.lastId == UINT16_MAX ? 1 : transfer.lastId + 1;
+    transfer.transferId = transfer.lastId;
+    transfer.frames = frames;
+    transfer.payload = payload;
+    transfer.bytes = bytes;
+    transfer.nextSeq = 0;
+    transfer.acked = 0;
+    nackCount = 0;
+    streaming = frames > 0;
+    return true;
+}
+
+void ExportSession::cancel() {
+    transfer.transferId = 0;
+    nackCount = 0;
+    streaming = false;
+}
+
+// ==========================================
+// COMMANDES DU TÉLÉPHONE
+// ==========================================
+ExportReply ExportSession::ack(const char* argument) {
+    char* end;
+    unsigned long seq = strtoul(argument, &end, 10);
+    if (!active() || end == argument || seq >= transfer.frames) return EXPORT_REPLY_INVALID;
+    
+    if (seq + 1 > transfer.acked) transfer.acked = seq + 1;
+    if (transfer.nextSeq < transfer.acked) transfer.nextSeq = transfer.acked;
+    streaming = true;               // La fenêtre avance
+    
+    if (transfer.acked < transfer.frames) return EXPORT_REPLY_OK;
+    storage.remove(path);
+    cancel();
+    return EXPORT_REPLY_COMPLETE;
+}
+
+ExportReply ExportSession::nack(const char* argument) {
+    SeqRange ranges[EXPORT_NACK_MAX];
+    int count = parseSeqRanges(argument, ranges, EXPORT_NACK_MAX);
+    if (!active() || count < 0) return EXPORT_REPLY_INVALID;
+    
+    for (int i = 0; i < count && nackCount < EXPORT_NACK_MAX; i++) {
+        if (ranges[i].first >= transfer.frames) continue;
+        if (ranges[i].last >= transfer.frames) ranges[i].last = transfer.frames - 1;
+        nackQueue[nackCount++] = ranges[i];
+    }
+    streaming = true;
+    return EXPORT_REPLY_OK;
+}
+
+ExportReply ExportSession::resume(const char* argument, uint16_t payload) {
+    char* end;
+    unsigned long id = strtoul(argument, &end, 10);
+    unsigned long seq = strtoul(end, &end, 10);
+    if (!active() || id != transfer.transferId || seq > transfer.frames || !storage.exists(path)) {
+        return EXPORT_REPLY_UNKNOWN;
+    }
+    
+    // Une trame ne doit pas dépasser le nouveau MTU
+    if (payload < transfer.payload) return EXPORT_REPLY_MTU;
+    
+    if (seq > transfer.acked) transfer.acked = seq;
+    transfer.nextSeq = seq;
+    nackCount = 0;
+    streaming = true;
+    return EXPORT_REPLY_OK;
+}
+
+// ==========================================
+// ENVOI DES TRAMES
+// ==========================================
+// Les trames qui se suivent sont lues par blocs (le suivant est chargé
+// pendant la pause) ; une retransmission repart du bloc de sa trame.
+bool ExportSession::sendFrame(StorageBlockFile& file, BlockReader& reader, uint16_t seq, bool retransmit,
+                              ExportSendFn send, void* context) {
+    uint8_t frame[EXPORT_FRAME_MAX];
+    uint8_t* payload = frame + sizeof(ExportFrameHeader);
+    
+    uint32_t offset = (uint32_t)seq * transfer.payload;
+    if (reader.position() != offset) {
+        reader.begin(storageReadBlock, &file, offset, transfer.bytes);
+    }
+    size_t length = reader.read(payload, transfer.payload);
+    if (length == 0) return false;
+    
+    bool last = seq + 1 == transfer.frames;
+    size_t size = buildExportFrame(frame, transfer.transferId, seq, last, payload, length);
+    send(context, frame, size, retransmit, reader);
+    return true;
+}
+
+int ExportSession::pump(BlockReader& reader, int burst, ExportSendFn send, void* context) {
+    if (!hasFrames()) return 0;
+    
+    StorageBlockFile file = {&storage, storage.open(path, STORAGE_READ)};
+    if (file.file == nullptr) {
+        streaming = false;
+        return 0;
+    }
+    reader.begin(storageReadBlock, &file, (uint32_t)transfer.nextSeq * transfer.payload, transfer.bytes);
+    
+    int sent = 0;
+    for (; sent < burst; sent++) {
+        if (nackCount > 0) {
+            SeqRange& range = nackQueue[0];
+            sendFrame(file, reader, range.first, true, send, context);
+            if (range.first == range.last) {
+                memmove(nackQueue, nackQueue + 1, --nackCount * sizeof(SeqRange));
+            } else {
+                range.first++;
+            }
+        } else if (transfer.nextSeq < transfer.frames && transfer.nextSeq < transfer.acked + EXPORT_WINDOW) {
+            sendFrame(file, reader, transfer.nextSeq++, false, send, context);
+        } else {
+            // Tout est parti (ou fenêtre pleine) : attente d'un ACK ou d'un NACK
+            streaming = false;
+            break;
+        }
+    }
+    storage.close(file.file);
+    return sent;
+}
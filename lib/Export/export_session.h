@@ -0,0 +1,88 @@
+#ifndef EXPORT_SESSION_H
+#define EXPORT_SESSION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <block_reader.h>
+#include <storage.h>
+#include "export_frame.h"
+
+// ==========================================
+// TRANSFERT EXPORT (fenêtre, ACK, NACK, RESUME)
+// ==========================================
+// Le fichier d'export et l'état du transfert (ExportTransfer, en RTC sur la
+// carte) survivent à une déconnexion comme au deep sleep : le téléphone
+// reprend avec RESUME là où il s'était arrêté. Jamais plus de EXPORT_WINDOW
+// trames ne sont envoyées au-delà du dernier ACK ; les NACK sont servis
+// avant les trames nouvelles. La file des NACK et l'état du flux ne sont pas
+// conservés : après un réveil, le téléphone relance RESUME.
+
+#define EXPORT_FRAME_MAX 244            // Trame la plus longue, en-tête compris (MTU 247)
+#define EXPORT_WINDOW 64                // Trames envoyées au-delà du dernier ACK au plus
+#define EXPORT_NACK_MAX 8               // Plages de retransmission en attente
+
+// Transfert en cours (conservé en RTC pour la reprise)
+struct ExportTransfer {
+    uint16_t transferId;            // 0 = aucun
+    uint16_t frames;
+    uint16_t payload;               // Octets de données par trame
+    uint16_t nextSeq;               // Prochaine trame du flux
+    uint16_t acked;                 // Trames [0, acked) reçues par le téléphone
+    uint32_t bytes;                 // Taille du fichier d'export
+    uint16_t lastId;                // Dernier identifiant attribué (jamais 0)
+};
+
+// Réponse à une commande du téléphone
+enum ExportReply : uint8_t {
+    EXPORT_REPLY_OK,
+    EXPORT_REPLY_COMPLETE,          // Dernier ACK : fichier supprimé, transfert terminé
+    EXPORT_REPLY_INVALID,           // Argument illisible ou hors du transfert
+    EXPORT_REPLY_UNKNOWN,           // Aucun transfert de cet identifiant (ou fichier perdu)
+    EXPORT_REPLY_MTU                // MTU trop petit pour les trames du transfert
+};
+
+// Envoie une trame (notification). reader : lecteur du fichier, dont le
+// bloc suivant peut être chargé pendant la pause entre deux trames.
+typedef void (*ExportSendFn)(void* context, const uint8_t* frame, size_t length, bool retransmit,
+                             BlockReader& reader);
+
+class ExportSession {
+public:
+    ExportSession(ExportTransfer& transfer, Storage& storage, const char* path);
+
+    // Nouveau transfert du fichier (bytes octets) en trames de payload
+    // octets. false si le fichier demande plus de 65535 trames.
+    bool start(uint32_t bytes, uint16_t payload);
+
+    // Abandon (fichier effacé) ; pause : le flux s'arrête, RESUME le reprend
+    void cancel();
+    void pause() { streaming = false; }
+
+    bool active() const { return transfer.transferId != 0; }
+    bool hasFrames() const { return streaming && active(); }
+
+    // "n" : trames [0, n] reçues
+    ExportReply ack(const char* argument);
+    // "a-b,c" : trames à renvoyer (EXPORT_NACK_MAX plages en attente au plus)
+    ExportReply nack(const char* argument);
+    // "id seq" : reprise à la trame seq ; payload : octets par trame du MTU actuel
+    ExportReply resume(const char* argument, uint16_t payload);
+
+    // Envoie jusqu'à burst trames (retransmissions d'abord) lues par reader.
+    // Retourne le nombre envoyé ; le flux s'arrête quand tout est parti ou
+    // que la fenêtre est pleine (attente d'un ACK ou d'un NACK).
+    int pump(BlockReader& reader, int burst, ExportSendFn send, void* context);
+
+private:
+    bool sendFrame(StorageBlockFile& file, BlockReader& reader, uint16_t seq, bool retransmit,
+                   ExportSendFn send, void* context);
+
+    ExportTransfer& transfer;
+    Storage& storage;
+    const char* path;
+    bool streaming = false;         // Trames à envoyer (sinon attente d'ACK/NACK)
+    SeqRange nackQueue[EXPORT_NACK_MAX];
+    uint8_t nackCount = 0;
+};
+
+#endif
@@ -0,0 +1,44 @@
+#include "forecast.h"
+
+void holtReset(HoltState& state) {
+    state.level = 0.0f;
+    state.trend = 0.0f;
+    state.lastTime = 0;
+    state.count = 0;
+}
+
+void holtUpdate(HoltState& state, float value, uint32_t time, float alpha, float beta) {
+    if (state.count == 0) {
+        state.level = value;
+        state.trend = 0.0f;
+        state.lastTime = time;
+        state.count = 1;
+        return;
+    }
+    if (time <= state.lastTime) return;
+    
+    float hours = (time - state.lastTime) / 3600.0f;
+    float previous = state.level;
+    if (state.count == 1) {
+        // Deuxième mesure : première estimation de la pente
+        state.level = value;
+        state.trend = (value - previous) / hours;
+    } else {
+        float predicted = previous + state.trend * hours;
+        state.level = alpha * value + (1.0f - alpha) * predicted;
+        state.trend = beta * (state.level - previous) / hours + (1.0f - beta) * state.trend;
+    }
+    state.lastTime = time;
+    if (state.count < UINT16_MAX) state.count++;
+}
+
+float holtPredict(const HoltState& state, uint32_t time) {
+    float hours = time > state.lastTime ? (time - state.lastTime) / 3600.0f : 0.0f;
+    return state.level + state.trend * hours;
+}
+
+float holtHoursUntilBelow(const HoltState& state, float threshold) {
+    if (state.trend >= 0.0f) return HOLT_NOT_FALLING;
+    if (state.level < threshold) return 0.0f;
+    return (threshold - state.level) / state.trend;
+}
@@ -0,0 +1,42 @@
+#ifndef FORECAST_H
+#define FORECAST_H
+
+#include <stdint.h>
+
+// ==========================================
+// PRÉVISION DE TENDANCE (HOLT)
+// ==========================================
+// Lissage exponentiel double : un niveau et une pente (unités par heure),
+// mis à jour à chaque mesure en O(1), sans historique. Les mesures peuvent
+// être irrégulières (cycle allongé, carte absente) : le niveau est d'abord
+// projeté jusqu'à la nouvelle mesure, la pente est rapportée à l'écart réel.
+//
+//   prévu  = niveau + pente * dt
+//   niveau = alpha * mesure + (1 - alpha) * prévu
+//   pente  = beta * (niveau - ancien niveau) / dt + (1 - beta) * pente
+//
+// L'état tient en 16 octets : il est conservé en RTC entre deux cycles.
+
+struct HoltState {
+    float level;
+    float trend;                // Par heure
+    uint32_t lastTime;          // Secondes depuis 1970 de la dernière mesure (0 = aucune)
+    uint16_t count;             // Mesures prises en compte (plafonné)
+};
+
+void holtReset(HoltState& state);
+
+// Mesure à `time` (ignorée si elle n'est pas postérieure à la précédente)
+void holtUpdate(HoltState& state, float value, uint32_t time, float alpha, float beta);
+
+// Valeur prévue à `time`
+float holtPredict(const HoltState& state, uint32_t time);
+
+#define HOLT_NOT_FALLING -1.0f      // Pente nulle ou montante : pas de prévision
+
+// Heures, depuis la dernière mesure, avant que la prévision passe sous
+// threshold : 0 si elle y est déjà en baissant, HOLT_NOT_FALLING si la pente
+// ne descend pas (tas encore en chauffe, même sous le seuil)
+float holtHoursUntilBelow(const HoltState& state, float threshold);
+
+#endif
@@ -0,0 +1,268 @@
+#include "format.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+// ==========================================
+// FORMATER DATE EN ISO 8601
+// ==========================================
+void formatISO8601(char* buffer, DateTime dt) {
+    sprintf(buffer, "%04d-%02d-%02dT%02d:%02d:%02d",
+        dt.year, dt.month, dt.day,
+        dt.hour, dt.minute, dt.second);
+}
+
+// ==========================================
+// LIRE UNE DATE ISO 8601
+// ==========================================
+static bool parseDigits(const char* text, int count, int* value) {
+    int result = 0;
+    for (int i = 0; i < count; i++) {
+        if (text[i] < '0' || text[i] > '9') return false;
+        result = result * 10 + (text[i] - '0');
+    }
+    *value = result;
+    return true;
+}
+
+bool parseISO8601(const char* text, DateTime* dt) {
+    DateTime result;
+    if (!parseDigits(text, 4, &result.year) || text[4] != '-' ||
+        !parseDigits(text + 5, 2, &result.month) || text[7] != '-' ||
+        !parseDigits(text + 8, 2, &result.day) || text[10] != 'T' ||
+        !parseDigits(text + 11, 2, &result.hour) || text[13] != ':' ||
+        !parseDigits(text + 14, 2, &result.minute) || text[16] != ':' ||
+        !parseDigits(text + 17, 2, &result.second)) {
+        return false;
+    }
+    *dt = result;
+    return true;
+}
+
+// ==========================================
+// INCRÉMENTER LA DATE
+// ==========================================
+void advanceDateTime(DateTime& dt, int seconds) {
+    dt.second += seconds;
+    
+    // Gestion des dépassements
+    while (dt.second >= 60) {
+        dt.second -= 60;
+        dt.minute++;
+    }
+    
+    while (dt.minute >= 60) {
+        dt.minute -= 60;
+        dt.hour++;
+    }
+    
+    while (dt.hour >= 24) {
+        dt.hour -= 24;
+        dt.day++;
+    }
+    
+    // Gestion simplifiée des jours par mois (peut être amélioré)
+    int daysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    
+    // Année bissextile
+    if ((dt.year % 4 == 0 && dt.year % 100 != 0) || 
+        (dt.year % 400 == 0)) {
+        daysInMonth[1] = 29;
+    }
+    
+    while (dt.day > daysInMonth[dt.month - 1]) {
+        dt.day -= daysInMonth[dt.month - 1];
+        dt.month++;
+        
+        if (dt.month > 12) {
+            dt.month = 1;
+            dt.year++;
+        }
+    }
+}
+
+// ==========================================
+// DÉCALER UNE DATE (secondes positives ou négatives)
+// ==========================================
+// Conversion en jours depuis le 1970-01-01 (algorithme "days from civil")
+static long daysFromCivil(int y, int m, int d) {
+    y -= m <= 2;
+    long era = (y >= 0 ? y : y - 399) / 400;
+    long yoe = y - era * 400;
+    long doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+long long dateTimeToEpoch(const DateTime& dt) {
+    return (long long)daysFromCivil(dt.year, dt.month, dt.day) * 86400LL +
+           dt.hour * 3600L + dt.minute * 60L + dt.second;
+}
+
+DateTime offsetDateTime(DateTime dt, long seconds) {
+    return epochToDateTime(dateTimeToEpoch(dt) + seconds);
+}
+
+DateTime epochToDateTime(long long t) {
+    long days = (long)(t / 86400LL);
+    long rem = (long)(t % 86400LL);
+    if (rem < 0) {
+        rem += 86400;
+        days--;
+    }
+    
+    // Conversion inverse ("civil from days")
+    days += 719468;
+    long era = (days >= 0 ? days : days - 146096) / 146097;
+    long doe = days - era * 146097;
+    long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    long mp = (5 * doy + 2) / 153;
+    
+    DateTime result;
+    result.day = doy - (153 * mp + 2) / 5 + 1;
+    result.month = mp < 10 ? mp + 3 : mp - 9;
+    result.year = yoe + era * 400 + (result.month <= 2);
+    result.hour = rem / 3600;
+    result.minute = (rem % 3600) / 60;
+    result.second = rem % 60;
+    return result;
+}
+
+// ==========================================
+// FORMAT DES LIGNES CSV PAR CARTE
+// ==========================================
+// Valeur à `decimals` décimales suivie de ';' (arrondi au plus proche, comme
+// encodeCenti). Retourne la longueur écrite, -1 si room est trop petit.
+static int appendFixed(char* out, size_t room, float value, uint8_t decimals) {
+    char digits[16];
+    int length = 0;
+    
+    long scale = 1;
+    for (uint8_t d = 0; d < decimals; d++) scale *= 10;
+    double scaled = (double)value * scale;
+    if (isnan(value) || scaled >= 1e9 || scaled <= -1e9) {
+        // nan, ou hors de l'arrondi entier : printf
+        length = snprintf(out, room, "%.*f;", decimals, (double)value);
+        return length < 0 || (size_t)length >= room ? -1 : length;
+    }
+    
+    long fixed = lround(scaled);
+    bool negative = fixed < 0;
+    unsigned long magnitude = negative ? -fixed : fixed;
+    int count = 0;
+    do {
+        digits[count++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude > 0 || count <= decimals);
+    
+    if ((size_t)(count + negative + (decimals > 0) + 1) >= room) return -1;
+    if (negative) out[length++] = '-';
+    while (count > 0) {
+        out[length++] = digits[--count];
+        if (count == decimals && decimals > 0) out[length++] = '.';
+    }
+    out[length++] = ';';
+    out[length] = '\0';
+    return length;
+}
+
+// Colonnes et décimales d'après lib/Schema : aucun cas particulier par carte
+size_t formatCsvRow(char* out, size_t maxLen, uint8_t boardId, const char* isoTime, const float* values) {
+    if (maxLen < ISO8601_LENGTH + 3) return 0;
+    size_t length = 0;
+    while (isoTime[length] != '\0' && length < ISO8601_LENGTH) {
+        out[length] = isoTime[length];
+        length++;
+    }
+    out[length++] = ';';
+    
+    uint8_t fields = boardFieldCount(boardId);
+    for (uint8_t n = 0; n < fields; n++) {
+        int written = appendFixed(out + length, maxLen - length, values[n],
+                                  FIELD_SPECS[boardField(boardId, n)].decimals);
+        if (written < 0) return 0;
+        length += written;
+    }
+    if (length + 1 >= maxLen) {
+        return 0;
+    }
+    out[length++] = '\n';
+    out[length] = '\0';
+    return length;
+}
+
+size_t formatCsvHeader(char* out, size_t maxLen, uint8_t boardId) {
+    uint8_t fields = boardFieldCount(boardId);
+    int length = snprintf(out, maxLen, "date;");
+    for (uint8_t n = 0; n < fields && length >= 0 && (size_t)length < maxLen; n++) {
+        int written = snprintf(out + length, maxLen - length, "%s;", FIELD_SPECS[boardField(boardId, n)].column);
+        length = written < 0 ? -1 : length + written;
+    }
+    if (length < 0 || (size_t)length >= maxLen) {
+        return 0;
+    }
+    return length;
+}
+
+// ==========================================
+// LECTURE D'UNE LIGNE CSV
+// ==========================================
+// Valeur écrite par formatCsvRow ("-12.34") : lue sans strtod. Les autres
+// écritures ("nan", exposant, plus de 2 décimales) passent par strtod. Une
+// valeur hors de l'int32_t (ligne corrompue) rend la ligne illisible.
+#define CENTI_MAX_DIGITS 7              // Partie entière lue sans strtod : 9999999.99 au plus
+
+static const char* parseCenti(const char* p, int32_t* centi) {
+    const char* q = p;
+    bool negative = *q == '-';
+    if (negative) q++;
+    
+    // 8 chiffres entiers + 3 décimales au plus : tient dans un int64_t
+    int64_t value = 0;
+    int digits = 0;
+    while (*q >= '0' && *q <= '9' && digits <= CENTI_MAX_DIGITS) {
+        value = value * 10 + (*q++ - '0');
+        digits++;
+    }
+    int decimals = 0;
+    if (digits > 0 && *q == '.') {
+        q++;
+        while (*q >= '0' && *q <= '9' && decimals < 3) {
+            value = value * 10 + (*q++ - '0');
+            decimals++;
+        }
+    }
+    if (digits > 0 && digits <= CENTI_MAX_DIGITS && decimals <= 2 && *q == ';') {
+        for (; decimals < 2; decimals++) value *= 10;
+        *centi = (int32_t)(negative ? -value : value);
+        return q;
+    }
+    
+    char* end;
+    double parsed = strtod(p, &end);
+    if (end == p) return nullptr;
+    if (isnan(parsed)) {
+        *centi = CSV_NO_VALUE;
+        return end;
+    }
+    if (fabs(parsed) * 100.0 >= (double)INT32_MAX) return nullptr;
+    *centi = (int32_t)lround(parsed * 100.0);
+    return end;
+}
+
+int parseCsvRow(const char* line, DateTime* dt, int32_t* centi, int maxValues) {
+    if (!parseISO8601(line, dt) || line[ISO8601_LENGTH] != ';') {
+        return -1;
+    }
+    
+    const char* p = line + ISO8601_LENGTH + 1;
+    int count = 0;
+    while (count < maxValues && *p != '\0' && *p != '\n' && *p != '\r') {
+        const char* end = parseCenti(p, &centi[count]);
+        if (end == nullptr || *end != ';') return -1;
+        count++;
+        p = end + 1;
+    }
+    return count;
+}
@@ -0,0 +1,60 @@
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <schema.h>
+
+// ==========================================
+// DATES ET LIGNES CSV (carte maître)
+// ==========================================
+// Fonctions pures, sans Arduino ni allocation : compilées telles quelles par
+// le firmware et par les benchmarks natifs (test/test_bench).
+
+#define ISO8601_LENGTH 19           // "YYYY-MM-DDTHH:MM:SS"
+#define CSV_ROW_MAX 64              // Ligne CSV la plus longue (date + valeurs + qualité)
+
+// Date, valeurs ("-327.68;"), colonne qualité (une lettre par champ + ';'), "\n\0"
+static_assert(ISO8601_LENGTH + 1 + SCHEMA_MAX_FIELDS * 8 + SCHEMA_MAX_FIELDS + 3 <= CSV_ROW_MAX,
+              "CSV_ROW_MAX trop petit pour le schéma");
+
+struct DateTime {
+    int year;
+    int month;
+    int day;
+    int hour;
+    int minute;
+    int second;
+};
+
+// buffer : au moins ISO8601_LENGTH + 1 octets
+void formatISO8601(char* buffer, DateTime dt);
+
+// Lecture de "YYYY-MM-DDTHH:MM:SS" (caractères suivants ignorés)
+bool parseISO8601(const char* text, DateTime* dt);
+
+// Avance une date de `seconds` secondes (>= 0)
+void advanceDateTime(DateTime& dt, int seconds);
+
+// Décale une date de `seconds` secondes, positives ou négatives
+DateTime offsetDateTime(DateTime dt, long seconds);
+
+// Secondes depuis le 1970-01-01T00:00:00 (horodatage des blocs compactés)
+long long dateTimeToEpoch(const DateTime& dt);
+DateTime epochToDateTime(long long seconds);
+
+// Ligne CSV d'une carte : "date;" puis une valeur par champ du schéma
+// (values[n] = champ n, voir lib/Schema), terminée par '\n'. Retourne la
+// longueur écrite (0 si out est trop petit).
+size_t formatCsvRow(char* out, size_t maxLen, uint8_t boardId, const char* isoTime, const float* values);
+
+// En-tête correspondant, sans fin de ligne : "date;temperature;humidity;"
+size_t formatCsvHeader(char* out, size_t maxLen, uint8_t boardId);
+
+// Lecture inverse : date puis jusqu'à maxValues valeurs en centièmes
+// (CSV_NO_VALUE pour "nan"). Retourne le nombre de valeurs lues, -1 si la
+// ligne n'est pas une ligne de mesures (en-tête, ligne tronquée).
+#define CSV_NO_VALUE INT32_MIN
+int parseCsvRow(const char* line, DateTime* dt, int32_t* centi, int maxValues);
+
+#endif // FORMAT_H
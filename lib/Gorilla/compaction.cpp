@@ -0,0 +1,340 @@
+#include "compaction.h"
+#include <string.h>
+#include <format.h>
+#include <retention.h>
+#include <screening.h>
+
+// ==========================================
+// INDEX DES BLOCS
+// ==========================================
+uint32_t archiveLastTime(Storage& storage, uint8_t boardId) {
+    uint32_t periods[RETENTION_MAX_PERIODS];
+    int count = listTierPeriods(storage, boardId, TIER_RAW, ".idx", periods, RETENTION_MAX_PERIODS);
+    if (count == 0) return 0;
+
+    char idxPath[32];
+    tierPath(idxPath, sizeof(idxPath), boardId, TIER_RAW, periods[count - 1], ".idx");
+    StorageFile idx = storage.open(idxPath, STORAGE_READ);
+    if (idx == nullptr) return 0;
+
+    uint32_t lastTime = 0;
+    uint32_t entries = storage.size(idx) / sizeof(ArchiveIndexEntry);
+    ArchiveIndexEntry entry;
+    if (entries > 0 && storage.read(idx, (entries - 1) * sizeof(entry), (uint8_t*)&entry,
+                                    sizeof(entry)) == sizeof(entry)) {
+        lastTime = entry.header.lastTime;
+    }
+    storage.close(idx);
+    return lastTime;
+}
+
+// Écrit le bloc courant dans le fichier du mois de sa première mesure, puis
+// son entrée d'index
+static bool appendArchiveBlock(Storage& storage, CompactionJob& job, GorillaEncoder& encoder,
+                               const uint8_t* block, CompactionReport* report) {
+    GorillaBlockHeader header;
+    size_t bytes = encoder.finish(&header);
+
+    char dir[16];
+    char gorPath[32];
+    char idxPath[32];
+    uint32_t period = tierPeriod(TIER_RAW, header.firstTime);
+    boardArchivePath(dir, sizeof(dir), job.boardId, "");
+    tierPath(gorPath, sizeof(gorPath), job.boardId, TIER_RAW, period, ".gor");
+    tierPath(idxPath, sizeof(idxPath), job.boardId, TIER_RAW, period, ".idx");
+    if (!storage.exists(dir)) storage.mkdir(dir);
+
+    StorageFile gor = storage.open(gorPath, STORAGE_APPEND);
+    if (gor == nullptr) return false;
+    ArchiveIndexEntry entry;
+    entry.offset = storage.size(gor);
+    entry.header = header;
+    bool ok = storage.write(gor, (const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              storage.write(gor, block, bytes) == bytes;
+    storage.close(gor);
+
+    ok = ok && storageAppend(storage, idxPath, (const uint8_t*)&entry, sizeof(entry));
+    if (!ok) return false;
+
+    job.lastTime = header.lastTime;
+    report->blocks++;
+    report->records += header.count;
+    report->blockBytes += sizeof(header) + bytes;
+    report->indexBytes += sizeof(entry);
+    return true;
+}
+
+// ==========================================
+// ENCODAGE DES LIGNES ANCIENNES
+// ==========================================
+// Encode les lignes à partir de job.readPos. Retourne true quand la partie
+// ancienne du CSV est entièrement archivée.
+static bool compactEncode(Storage& storage, CompactionJob& job, uint32_t now, uint32_t deadline,
+                          StorageClock clock, ArchiveScratch& scratch, CompactionReport* report) {
+    uint8_t channels = boardFieldCount(job.boardId);
+
+    StorageBlockFile csv = {&storage, storage.open(BOARD_SPECS[job.boardId - 1].file, STORAGE_READ)};
+    if (csv.file == nullptr) {
+        job.phase = COMPACT_IDLE;
+        return false;
+    }
+
+    char line[CSV_ROW_MAX + 16];
+    BlockReader& reader = scratch.reader;
+    reader.begin(storageReadBlock, &csv, job.readPos, storage.size(csv.file));
+    if (job.readPos == 0) {
+        reader.readLine(line, sizeof(line));       // En-tête
+        job.dataPos = reader.position();
+        job.readPos = job.dataPos;
+    }
+
+    uint32_t cutoff = now - COMPACT_AGE_DAYS * 86400UL;
+    // Le code qualité de chaque ligne est archivé comme un champ de plus
+    GorillaEncoder encoder;
+    encoder.begin(scratch.block, sizeof(scratch.block), channels + 1);
+
+    // pos n'est reporté dans job.readPos qu'une fois le bloc écrit
+    uint32_t pos = job.readPos;
+    uint32_t blockPeriod = 0;
+    uint32_t blockLastTime = 0;
+    bool reachedRecent = false;
+    bool atEnd = false;
+    bool ok = true;
+
+    while ((int32_t)(deadline - clock()) > 0) {
+        if (!reader.readLine(line, sizeof(line))) {
+            atEnd = true;
+            break;
+        }
+        uint32_t next = reader.position();
+
+        DateTime dt;
+        int32_t values[GORILLA_MAX_CHANNELS];
+        int count = parseCsvRow(line, &dt, values, channels);
+        if (count < 0) {
+            report->skippedLines++;
+            pos = next;
+            continue;
+        }
+        for (int c = count; c < channels; c++) values[c] = CSV_NO_VALUE;
+        values[channels] = parseQualityColumn(line, channels);     // QUALITY_UNKNOWN si illisible
+
+        uint32_t time = (uint32_t)dateTimeToEpoch(dt);
+        if (time >= cutoff) {
+            reachedRecent = true;
+            break;
+        }
+
+        // Lignes en tête du CSV déjà archivées (compaction interrompue avant
+        // la recopie) : elles s'arrêtent à la dernière mesure du dernier bloc.
+        // Au-delà, une ligne plus ancienne (horloge recalée en arrière) est
+        // archivée comme les autres : la recopie la retire du CSV.
+        if (job.skipArchived) {
+            if (time <= job.lastTime) {
+                if (time == job.lastTime) job.skipArchived = 0;
+                pos = next;
+                continue;
+            }
+            job.skipArchived = 0;
+        }
+
+        // Un bloc ne couvre qu'un mois (les fichiers mensuels sont supprimés en
+        // entier) et reste chronologique : retour en arrière = nouveau bloc
+        bool newBlock = encoder.count() > 0 &&
+                        (tierPeriod(TIER_RAW, time) != blockPeriod || time < blockLastTime);
+        if (newBlock || !encoder.append(time, values)) {
+            // Bloc plein, mois suivant ou retour en arrière : écrit, puis on repart d'un bloc vide
+            ok = appendArchiveBlock(storage, job, encoder, scratch.block, report);
+            if (!ok) break;
+            job.readPos = pos;
+            encoder.begin(scratch.block, sizeof(scratch.block), channels + 1);
+            encoder.append(time, values);
+        }
+        if (encoder.count() == 1) blockPeriod = tierPeriod(TIER_RAW, time);
+        blockLastTime = time;
+        pos = next;
+    }
+    storage.close(csv.file);
+    bool finished = ok && (reachedRecent || atEnd);
+
+    // Bloc partiel : écrit tel quel, l'encodeur ne survit pas à l'appel
+    if (ok && encoder.count() > 0) {
+        ok = appendArchiveBlock(storage, job, encoder, scratch.block, report);
+    }
+    if (!ok) {
+        report->writeFailed = true;
+        job.phase = COMPACT_IDLE;
+        return false;
+    }
+    job.readPos = pos;
+    return finished;
+}
+
+// ==========================================
+// RECOPIE DE LA PARTIE RÉCENTE
+// ==========================================
+// Recopie l'en-tête et la partie récente du CSV dans /<carte>.tmp, puis
+// remplace le CSV. Retourne true une fois le CSV remplacé.
+static bool compactTrim(Storage& storage, CompactionJob& job, uint32_t deadline, StorageClock clock,
+                        CompactionReport* report) {
+    const char* csvPath = BOARD_SPECS[job.boardId - 1].file;
+    char tmpPath[24];
+    boardArchivePath(tmpPath, sizeof(tmpPath), job.boardId, ".tmp");
+
+    StorageFile src = storage.open(csvPath, STORAGE_READ);
+    if (src == nullptr) {
+        job.phase = COMPACT_IDLE;
+        return false;
+    }
+
+    uint8_t buffer[COMPACT_COPY_CHUNK];
+    StorageFile tmp;
+    if (job.copyPos == 0) {
+        // En-tête : [0, dataPos)
+        tmp = storage.open(tmpPath, STORAGE_WRITE);
+        size_t n = job.dataPos <= sizeof(buffer) ? storage.read(src, 0, buffer, job.dataPos) : 0;
+        if (tmp == nullptr || n != job.dataPos || storage.write(tmp, buffer, n) != n) {
+            if (tmp) storage.close(tmp);
+            storage.close(src);
+            report->writeFailed = true;
+            job.phase = COMPACT_IDLE;
+            return false;
+        }
+        job.copyPos = job.readPos;
+    } else {
+        tmp = storage.open(tmpPath, STORAGE_APPEND);
+        if (tmp == nullptr) {
+            storage.close(src);
+            report->writeFailed = true;
+            job.phase = COMPACT_IDLE;
+            return false;
+        }
+    }
+
+    // La partie récente est recopiée par morceaux (les mesures du cycle sont déjà écrites)
+    uint32_t size = storage.size(src);
+    while (job.copyPos < size) {
+        if ((int32_t)(deadline - clock()) <= 0) {
+            storage.close(src);
+            storage.close(tmp);
+            return false;
+        }
+        size_t n = storage.read(src, job.copyPos, buffer, sizeof(buffer));
+        if (n == 0 || storage.write(tmp, buffer, n) != n) {
+            storage.close(src);
+            storage.close(tmp);
+            report->writeFailed = true;
+            job.phase = COMPACT_IDLE;
+            return false;
+        }
+        job.copyPos += n;
+    }
+    storage.close(src);
+    storage.close(tmp);
+
+    storage.remove(csvPath);
+    storage.rename(tmpPath, csvPath);
+    return true;
+}
+
+// ==========================================
+// CHOIX DE LA CARTE ET ÉTAPES
+// ==========================================
+uint8_t compactionPickBoard(Storage& storage, uint8_t* nextBoard, uint32_t now, ArchiveScratch& scratch) {
+    uint32_t batchCutoff = now - (COMPACT_AGE_DAYS + COMPACT_BATCH_DAYS) * 86400UL;
+    uint8_t start = schemaValidBoard(*nextBoard) ? *nextBoard : 1;
+
+    for (int i = 0; i < SCHEMA_BOARDS; i++) {
+        uint8_t candidate = (start - 1 + i) % SCHEMA_BOARDS + 1;
+        StorageBlockFile csv = {&storage, storage.open(BOARD_SPECS[candidate - 1].file, STORAGE_READ)};
+        if (csv.file == nullptr) continue;
+
+        char line[CSV_ROW_MAX + 16];
+        scratch.reader.begin(storageReadBlock, &csv, 0, storage.size(csv.file));
+        bool hasRow = scratch.reader.readLine(line, sizeof(line)) &&     // En-tête
+                      scratch.reader.readLine(line, sizeof(line));
+        storage.close(csv.file);
+
+        DateTime dt;
+        if (hasRow && parseISO8601(line, &dt) && (uint32_t)dateTimeToEpoch(dt) < batchCutoff) {
+            *nextBoard = candidate % SCHEMA_BOARDS + 1;
+            return candidate;
+        }
+    }
+    return 0;
+}
+
+void runCompaction(Storage& storage, CompactionJob& job, uint8_t* nextBoard, uint32_t now,
+                   uint32_t deadline, StorageClock clock, ArchiveScratch& scratch,
+                   CompactionReport* report) {
+    memset(report, 0, sizeof(*report));
+
+    if (job.phase == COMPACT_IDLE) {
+        uint8_t boardId = compactionPickBoard(storage, nextBoard, now, scratch);
+        if (boardId == 0) return;
+
+        job.boardId = boardId;
+        job.phase = COMPACT_ENCODE;
+        job.dataPos = 0;
+        job.readPos = 0;
+        job.copyPos = 0;
+        job.lastTime = archiveLastTime(storage, boardId);
+        job.skipArchived = job.lastTime > 0;
+    }
+
+    if (job.phase == COMPACT_ENCODE) {
+        if (!compactEncode(storage, job, now, deadline, clock, scratch, report)) return;
+
+        // Rien d'ancien dans ce CSV : pas de réécriture
+        if (job.readPos == job.dataPos) {
+            job.phase = COMPACT_IDLE;
+            return;
+        }
+        job.phase = COMPACT_TRIM;
+        job.copyPos = 0;
+    }
+
+    if (job.phase == COMPACT_TRIM && compactTrim(storage, job, deadline, clock, report)) {
+        report->compacted = true;
+        job.phase = COMPACT_IDLE;
+    }
+}
+
+// ==========================================
+// LECTURE DES BLOCS D'UN MOIS
+// ==========================================
+bool ArchivePeriod::open(Storage& target, uint8_t boardId, uint32_t period, uint8_t* buffer) {
+    char idxPath[32];
+    char gorPath[32];
+    tierPath(idxPath, sizeof(idxPath), boardId, TIER_RAW, period, ".idx");
+    tierPath(gorPath, sizeof(gorPath), boardId, TIER_RAW, period, ".gor");
+
+    storage = &target;
+    block = buffer;
+    idx = storage->open(idxPath, STORAGE_READ);
+    gor = idx ? storage->open(gorPath, STORAGE_READ) : nullptr;
+    if (gor == nullptr) {
+        if (idx) storage->close(idx);
+        idx = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void ArchivePeriod::close() {
+    if (idx) storage->close(idx);
+    if (gor) storage->close(gor);
+    idx = nullptr;
+    gor = nullptr;
+}
+
+ArchiveBlockStatus ArchivePeriod::read(uint32_t index, ArchiveIndexEntry* entry, GorillaDecoder* decoder) {
+    if (storage->read(idx, index * sizeof(*entry), (uint8_t*)entry, sizeof(*entry)) != sizeof(*entry)) {
+        return ARCHIVE_BLOCK_END;
+    }
+    bool ok = entry->header.bytes <= GORILLA_BLOCK_MAX_BYTES &&
+              storage->read(gor, entry->offset + sizeof(GorillaBlockHeader), block,
+                            entry->header.bytes) == entry->header.bytes &&
+              decoder->begin(entry->header, block);
+    return ok ? ARCHIVE_BLOCK_OK : ARCHIVE_BLOCK_CORRUPT;
+}
@@ -0,0 +1,108 @@
+#ifndef COMPACTION_H
+#define COMPACTION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <block_reader.h>
+#include <storage.h>
+#include "gorilla.h"
+
+// ==========================================
+// COMPACTION DES MESURES ANCIENNES
+// ==========================================
+// Les lignes de plus de COMPACT_AGE_DAYS jours du CSV d'une carte sont
+// encodées en blocs ajoutés au fichier mensuel /<carte>/rAAAAMM.gor, avec
+// une entrée par bloc dans rAAAAMM.idx, puis le CSV est réécrit sans elles.
+// Le travail est découpé pour tenir dans un budget de temps : l'état
+// (CompactionJob) est conservé par l'appelant, en RTC sur la carte, et
+// chaque étape est reprise sans perte après une coupure (lignes déjà
+// archivées reconnues à leur horodatage, copie .tmp renommée au démarrage).
+//
+// Les dates sont locales, en secondes depuis 1970 (dateTimeToEpoch).
+
+#define COMPACT_AGE_DAYS 3              // Mesures plus anciennes : compactées
+#define COMPACT_BATCH_DAYS 5            // Compacter dès qu'un bloc plein de mesures dépasse l'âge
+#define COMPACT_COPY_CHUNK 512          // Recopie de la partie récente du CSV
+
+// Entrée de l'index des blocs d'un mois (/apport/r202601.idx, ...)
+struct __attribute__((packed)) ArchiveIndexEntry {
+    uint32_t offset;                // Position du bloc dans le .gor
+    GorillaBlockHeader header;      // Copie de l'en-tête du bloc
+};
+
+enum CompactionPhase : uint8_t {
+    COMPACT_IDLE,
+    COMPACT_ENCODE,                 // Lignes anciennes -> blocs
+    COMPACT_TRIM                    // Recopie de la partie récente du CSV
+};
+
+struct CompactionJob {
+    uint8_t boardId;
+    CompactionPhase phase;
+    uint32_t dataPos;               // Début des mesures (après l'en-tête)
+    uint32_t readPos;               // Première ligne du CSV non encore archivée
+    uint32_t copyPos;               // Recopie : position source (0 = à démarrer)
+    uint32_t lastTime;              // Dernier horodatage archivé de la carte
+    uint8_t skipArchived;           // Début du CSV déjà archivé, pas encore dépassé
+};
+
+// Tampons de travail (hors de la pile de la tâche appelante)
+struct ArchiveScratch {
+    uint8_t block[GORILLA_BLOCK_MAX_BYTES]; // Bloc en cours d'encodage ou de décodage
+    BlockReader reader;
+};
+
+// Bilan d'un appel de runCompaction (métriques et journal)
+struct CompactionReport {
+    uint16_t blocks;                // Blocs écrits
+    uint32_t records;               // Mesures archivées
+    uint32_t blockBytes;            // Octets des blocs (en-têtes compris)
+    uint32_t indexBytes;            // Octets des entrées d'index
+    uint16_t skippedLines;          // Lignes illisibles laissées de côté
+    bool writeFailed;               // Écriture en échec : travail abandonné
+    bool compacted;                 // CSV de job.boardId réécrit sans ses mesures anciennes
+};
+
+// Horodatage du dernier bloc archivé d'une carte (0 si aucun)
+uint32_t archiveLastTime(Storage& storage, uint8_t boardId);
+
+// Prochaine carte, à partir de *nextBoard, dont la plus ancienne ligne du
+// CSV a dépassé COMPACT_AGE_DAYS + COMPACT_BATCH_DAYS : de quoi remplir un
+// bloc sans réécrire le CSV à chaque cycle. 0 si aucune ; sinon *nextBoard
+// passe à la carte suivante (tourniquet).
+uint8_t compactionPickBoard(Storage& storage, uint8_t* nextBoard, uint32_t now, ArchiveScratch& scratch);
+
+// Avance la compaction jusqu'à deadline (horloge clock). Sans travail en
+// cours, choisit une carte (une au plus par appel).
+void runCompaction(Storage& storage, CompactionJob& job, uint8_t* nextBoard, uint32_t now,
+                   uint32_t deadline, StorageClock clock, ArchiveScratch& scratch,
+                   CompactionReport* report);
+
+// ==========================================
+// LECTURE DES BLOCS D'UN MOIS
+// ==========================================
+enum ArchiveBlockStatus : uint8_t {
+    ARCHIVE_BLOCK_OK,
+    ARCHIVE_BLOCK_END,              // Plus d'entrée dans l'index
+    ARCHIVE_BLOCK_CORRUPT           // Bloc illisible, à ignorer
+};
+
+// Index et données d'un mois ouverts ensemble. Un bloc écrit sans son entrée
+// d'index (coupure entre les deux) n'est jamais lu.
+class ArchivePeriod {
+public:
+    // false si l'un des deux fichiers manque
+    bool open(Storage& storage, uint8_t boardId, uint32_t period, uint8_t* block);
+    void close();
+
+    // Bloc n de l'index, décodé depuis le tampon block
+    ArchiveBlockStatus read(uint32_t index, ArchiveIndexEntry* entry, GorillaDecoder* decoder);
+
+private:
+    Storage* storage;
+    StorageFile idx;
+    StorageFile gor;
+    uint8_t* block;
+};
+
+#endif
@@ -0,0 +1,162 @@
+#include "gorilla.h"
+#include <string.h>
+
+// Pire cas d'un enregistrement : '1111' + 32 bits par champ
+#define ROW_MAX_BITS(channels) ((4 + 32) * (1 + (channels)))
+
+// ==========================================
+// ENCODAGE
+// ==========================================
+void GorillaEncoder::begin(uint8_t* buffer, size_t capacity, uint8_t channelCount) {
+    out = buffer;
+    capacityBits = capacity * 8;
+    bitPos = 0;
+    channels = channelCount > GORILLA_MAX_CHANNELS ? GORILLA_MAX_CHANNELS : channelCount;
+    rows = 0;
+    firstTime = 0;
+    prevTime = 0;
+    prevDelta = 0;
+    memset(prevValues, 0, sizeof(prevValues));
+    memset(out, 0, capacity);
+}
+
+void GorillaEncoder::writeBits(uint32_t value, uint8_t bits) {
+    // MSB d'abord ; le tampon a été mis à zéro par begin()
+    while (bits > 0) {
+        uint8_t room = 8 - (bitPos & 7);
+        uint8_t take = bits < room ? bits : room;
+        uint8_t chunk = (uint8_t)((value >> (bits - take)) & ((1u << take) - 1));
+        out[bitPos >> 3] |= chunk << (room - take);
+        bitPos += take;
+        bits -= take;
+    }
+}
+
+void GorillaEncoder::writeDelta(int32_t delta) {
+    if (delta == 0) {
+        writeBits(0x0, 1);
+    } else if (delta >= -63 && delta <= 64) {
+        writeBits(0x2, 2);
+        writeBits((uint32_t)(delta + 63), 7);
+    } else if (delta >= -255 && delta <= 256) {
+        writeBits(0x6, 3);
+        writeBits((uint32_t)(delta + 255), 9);
+    } else if (delta >= -2047 && delta <= 2048) {
+        writeBits(0xE, 4);
+        writeBits((uint32_t)(delta + 2047), 12);
+    } else {
+        writeBits(0xF, 4);
+        writeBits((uint32_t)delta, 32);
+    }
+}
+
+bool GorillaEncoder::append(uint32_t time, const int32_t* values) {
+    if (rows >= GORILLA_BLOCK_MAX_ROWS || bitPos + ROW_MAX_BITS(channels) > capacityBits) {
+        return false;
+    }
+    
+    if (rows == 0) {
+        firstTime = time;
+        writeBits(time, 32);
+        for (uint8_t c = 0; c < channels; c++) {
+            writeBits((uint32_t)values[c], 32);
+        }
+    } else {
+        // Différences calculées modulo 2^32 : réversibles quelles que soient les valeurs
+        int32_t delta = (int32_t)(time - prevTime);
+        writeDelta((int32_t)((uint32_t)delta - (uint32_t)prevDelta));
+        prevDelta = delta;
+        for (uint8_t c = 0; c < channels; c++) {
+            writeDelta((int32_t)((uint32_t)values[c] - (uint32_t)prevValues[c]));
+        }
+    }
+    
+    prevTime = time;
+    memcpy(prevValues, values, channels * sizeof(int32_t));
+    rows++;
+    return true;
+}
+
+size_t GorillaEncoder::finish(GorillaBlockHeader* header) {
+    size_t bytes = (bitPos + 7) / 8;
+    header->version = GORILLA_VERSION;
+    header->channels = channels;
+    header->count = rows;
+    header->firstTime = firstTime;
+    header->lastTime = prevTime;
+    header->bytes = (uint16_t)bytes;
+    return bytes;
+}
+
+// ==========================================
+// DÉCODAGE
+// ==========================================
+bool GorillaDecoder::begin(const GorillaBlockHeader& header, const uint8_t* data) {
+    if (header.version != GORILLA_VERSION || header.channels > GORILLA_MAX_CHANNELS ||
+        header.count > GORILLA_BLOCK_MAX_ROWS || header.bytes > GORILLA_BLOCK_MAX_BYTES) {
+        remaining = 0;
+        return false;
+    }
+    in = data;
+    sizeBits = (size_t)header.bytes * 8;
+    bitPos = 0;
+    channels = header.channels;
+    remaining = header.count;
+    rows = 0;
+    prevTime = 0;
+    prevDelta = 0;
+    memset(prevValues, 0, sizeof(prevValues));
+    return true;
+}
+
+uint32_t GorillaDecoder::readBits(uint8_t bits) {
+    uint32_t value = 0;
+    while (bits > 0) {
+        if (bitPos >= sizeBits) {
+            // Bloc tronqué : la suite est ignorée
+            remaining = 0;
+            return bits >= 32 ? 0 : value << bits;
+        }
+        uint8_t room = 8 - (bitPos & 7);
+        uint8_t take = bits < room ? bits : room;
+        uint8_t chunk = (in[bitPos >> 3] >> (room - take)) & ((1u << take) - 1);
+        value = (value << take) | chunk;
+        bitPos += take;
+        bits -= take;
+    }
+    return value;
+}
+
+int32_t GorillaDecoder::readDelta() {
+    if (readBits(1) == 0) return 0;
+    if (readBits(1) == 0) return (int32_t)readBits(7) - 63;
+    if (readBits(1) == 0) return (int32_t)readBits(9) - 255;
+    if (readBits(1) == 0) return (int32_t)readBits(12) - 2047;
+    return (int32_t)readBits(32);
+}
+
+bool GorillaDecoder::next(uint32_t* time, int32_t* values) {
+    if (remaining == 0) return false;
+    
+    if (rows == 0) {
+        prevTime = readBits(32);
+        for (uint8_t c = 0; c < channels; c++) {
+            prevValues[c] = (int32_t)readBits(32);
+        }
+    } else {
+        prevDelta = (int32_t)((uint32_t)prevDelta + (uint32_t)readDelta());
+        prevTime += (uint32_t)prevDelta;
+        for (uint8_t c = 0; c < channels; c++) {
+            prevValues[c] = (int32_t)((uint32_t)prevValues[c] + (uint32_t)readDelta());
+        }
+    }
+    
+    // Lecture au-delà des données : bloc corrompu
+    if (remaining == 0) return false;
+    
+    *time = prevTime;
+    memcpy(values, prevValues, channels * sizeof(int32_t));
+    rows++;
+    remaining--;
+    return true;
+}
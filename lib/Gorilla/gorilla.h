@@ -0,0 +1,90 @@
+#ifndef GORILLA_H
+#define GORILLA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ==========================================
+// BLOCS DE SÉRIES TEMPORELLES COMPRESSÉS
+// ==========================================
+// Format inspiré de Gorilla (Pelkonen et al., VLDB 2015) pour des mesures à
+// pas quasi constant : horodatage en delta-of-delta, valeurs en centièmes
+// (entiers) codées par différence avec la précédente. Chaque différence
+// utilise les classes de longueur variable de Gorilla :
+//   0                -> '0'
+//   [-63, 64]        -> '10'   + 7 bits
+//   [-255, 256]      -> '110'  + 9 bits
+//   [-2047, 2048]    -> '1110' + 12 bits
+//   sinon            -> '1111' + 32 bits
+// Les valeurs étant des décimales quantifiées (et non des flottants bruts),
+// la différence entière est plus compacte que le XOR des flottants.
+// Le premier enregistrement est écrit en clair (32 bits par champ).
+//
+// Un bloc = GorillaBlockHeader + `bytes` octets de données, indépendant des
+// autres : il se décode seul.
+
+#define GORILLA_VERSION 1
+#define GORILLA_MAX_CHANNELS 4          // T, H, O2 + code qualité
+#define GORILLA_BLOCK_MAX_ROWS 240          // 5 jours à 30 min
+#define GORILLA_BLOCK_MAX_BYTES 1024
+
+struct __attribute__((packed)) GorillaBlockHeader {
+    uint8_t version;            // GORILLA_VERSION
+    uint8_t channels;           // Valeurs par enregistrement
+    uint16_t count;             // Enregistrements
+    uint32_t firstTime;         // Secondes depuis 1970 (premier enregistrement)
+    uint32_t lastTime;          // ... dernier enregistrement
+    uint16_t bytes;             // Taille des données qui suivent l'en-tête
+};
+
+class GorillaEncoder {
+public:
+    void begin(uint8_t* buffer, size_t capacity, uint8_t channels);
+    
+    // Ajoute un enregistrement ; false si le bloc est plein (rien n'est écrit)
+    bool append(uint32_t time, const int32_t* values);
+    
+    // Remplit l'en-tête du bloc courant et retourne la taille des données
+    size_t finish(GorillaBlockHeader* header);
+    
+    uint16_t count() const { return rows; }
+    
+private:
+    void writeBits(uint32_t value, uint8_t bits);
+    void writeDelta(int32_t delta);
+    
+    uint8_t* out;
+    size_t capacityBits;
+    size_t bitPos;
+    uint8_t channels;
+    uint16_t rows;
+    uint32_t firstTime;
+    uint32_t prevTime;
+    int32_t prevDelta;
+    int32_t prevValues[GORILLA_MAX_CHANNELS];
+};
+
+class GorillaDecoder {
+public:
+    // false si l'en-tête est invalide
+    bool begin(const GorillaBlockHeader& header, const uint8_t* data);
+    
+    // Enregistrement suivant ; false à la fin du bloc
+    bool next(uint32_t* time, int32_t* values);
+    
+private:
+    uint32_t readBits(uint8_t bits);
+    int32_t readDelta();
+    
+    const uint8_t* in;
+    size_t sizeBits;
+    size_t bitPos;
+    uint8_t channels;
+    uint16_t remaining;
+    uint16_t rows;
+    uint32_t prevTime;
+    int32_t prevDelta;
+    int32_t prevValues[GORILLA_MAX_CHANNELS];
+};
+
+#endif
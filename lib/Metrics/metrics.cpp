@@ -0,0 +1,164 @@
+#include "metrics.h"
+#include <stdio.h>
+#include <string.h>
+
+#define METRICS_MAGIC 0x4D455452
+
+// ==========================================
+// ÉTAT DU REGISTRE
+// ==========================================
+// Initialisé à zéro avant les constructeurs des métriques globales
+static Metric* registry[METRICS_MAX];
+static int registered = 0;
+static uint16_t slotsUsed = 0;
+static uint32_t layoutHash = 2166136261UL;  // FNV-1a des noms et tailles
+
+// Avant metricsBegin() (ou si le registre déborde) : stockage en RAM
+static MetricsStorage fallback;
+static MetricsStorage* storage = &fallback;
+static uint32_t overflowSlot;
+
+static void hashBytes(const void* data, size_t length) {
+    const uint8_t* p = (const uint8_t*)data;
+    for (size_t i = 0; i < length; i++) {
+        layoutHash = (layoutHash ^ p[i]) * 16777619UL;
+    }
+}
+
+Metric::Metric(const char* name, const char* help, MetricType type, uint8_t slotCount)
+    : name(name), help(help), type(type), slot(METRICS_MAX_SLOTS) {
+    if (registered >= METRICS_MAX || slotsUsed + slotCount > METRICS_MAX_SLOTS) {
+        return;
+    }
+    
+    slot = slotsUsed;
+    slotsUsed += slotCount;
+    registry[registered++] = this;
+    hashBytes(name, strlen(name));
+    hashBytes(&slotCount, sizeof(slotCount));
+}
+
+// Métrique non enregistrée : les mises à jour vont dans une case poubelle
+uint32_t* Metric::slots() const {
+    if (slot >= METRICS_MAX_SLOTS) {
+        overflowSlot = 0;
+        return &overflowSlot;
+    }
+    return &storage->slots[slot];
+}
+
+void metricsBegin(MetricsStorage* target) {
+    storage = target;
+    if (storage->magic != METRICS_MAGIC || storage->layout != layoutHash) {
+        memset(storage->slots, 0, sizeof(storage->slots));
+        storage->magic = METRICS_MAGIC;
+        storage->layout = layoutHash;
+    }
+}
+
+int metricsCount() {
+    return registered;
+}
+
+// ==========================================
+// MISES À JOUR
+// ==========================================
+void Counter::inc(uint32_t n) {
+    slots()[0] += n;
+}
+
+uint32_t Counter::value() const {
+    return slots()[0];
+}
+
+void Gauge::set(float value) {
+    memcpy(slots(), &value, sizeof(value));
+}
+
+float Gauge::value() const {
+    float value;
+    memcpy(&value, slots(), sizeof(value));
+    return value;
+}
+
+// Cases : [bucket 0..boundCount-1][+Inf][somme (float)]
+Histogram::Histogram(const char* name, const char* help, const float* bounds, uint8_t boundCount)
+    : Metric(name, help, METRIC_HISTOGRAM,
+             (boundCount > METRICS_MAX_BUCKETS ? METRICS_MAX_BUCKETS : boundCount) + 2),
+      bounds(bounds),
+      boundCount(boundCount > METRICS_MAX_BUCKETS ? METRICS_MAX_BUCKETS : boundCount) {}
+
+void Histogram::observe(float value) {
+    if (slot >= METRICS_MAX_SLOTS) return;
+    
+    uint32_t* s = slots();
+    uint8_t i = 0;
+    while (i < boundCount && value > bounds[i]) i++;
+    s[i]++;                                 // Bucket non cumulatif, cumulé à l'export
+    
+    float sum;
+    memcpy(&sum, &s[boundCount + 1], sizeof(sum));
+    sum += value;
+    memcpy(&s[boundCount + 1], &sum, sizeof(sum));
+}
+
+uint32_t Histogram::count() const {
+    if (slot >= METRICS_MAX_SLOTS) return 0;
+    
+    const uint32_t* s = slots();
+    uint32_t total = 0;
+    for (uint8_t i = 0; i <= boundCount; i++) total += s[i];
+    return total;
+}
+
+// ==========================================
+// EXPORT TEXTE (format Prometheus)
+// ==========================================
+void metricsExport(MetricsWriter writer, void* context) {
+    static const char* TYPE_NAMES[] = {"counter", "gauge", "histogram"};
+    char line[METRICS_LINE_MAX];
+    
+    for (int m = 0; m < registered; m++) {
+        const Metric* metric = registry[m];
+        const uint32_t* s = &storage->slots[metric->slot];
+        
+        snprintf(line, sizeof(line), "# HELP %s %s", metric->name, metric->help);
+        writer(line, context);
+        snprintf(line, sizeof(line), "# TYPE %s %s", metric->name, TYPE_NAMES[metric->type]);
+        writer(line, context);
+        
+        switch (metric->type) {
+            case METRIC_COUNTER:
+                snprintf(line, sizeof(line), "%s %lu", metric->name, (unsigned long)s[0]);
+                writer(line, context);
+                break;
+                
+            case METRIC_GAUGE:
+                snprintf(line, sizeof(line), "%s %g", metric->name, (double)((const Gauge*)metric)->value());
+                writer(line, context);
+                break;
+                
+            case METRIC_HISTOGRAM: {
+                const Histogram* histogram = (const Histogram*)metric;
+                uint32_t cumulative = 0;
+                for (uint8_t i = 0; i < histogram->boundCount; i++) {
+                    cumulative += s[i];
+                    snprintf(line, sizeof(line), "%s_bucket{le=\"%g\"} %lu", metric->name,
+                             (double)histogram->bounds[i], (unsigned long)cumulative);
+                    writer(line, context);
+                }
+                cumulative += s[histogram->boundCount];
+                snprintf(line, sizeof(line), "%s_bucket{le=\"+Inf\"} %lu", metric->name, (unsigned long)cumulative);
+                writer(line, context);
+                
+                float sum;
+                memcpy(&sum, &s[histogram->boundCount + 1], sizeof(sum));
+                snprintf(line, sizeof(line), "%s_sum %g", metric->name, (double)sum);
+                writer(line, context);
+                snprintf(line, sizeof(line), "%s_count %lu", metric->name, (unsigned long)cumulative);
+                writer(line, context);
+                break;
+            }
+        }
+    }
+}
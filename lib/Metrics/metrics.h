@@ -0,0 +1,87 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ==========================================
+// REGISTRE DE MÉTRIQUES
+// ==========================================
+// Les métriques sont des objets globaux : le constructeur les enregistre et
+// leur réserve des cases dans un MetricsStorage fourni par l'application
+// (en RTC sur la carte, pour cumuler les cycles de deep sleep). Aucune
+// allocation, ni à l'enregistrement ni à la mise à jour.
+//
+// Export au format texte Prometheus, une ligne à la fois :
+//   metricsExport(writer, context);
+
+#define METRICS_MAX 32              // Métriques enregistrées au plus
+#define METRICS_MAX_SLOTS 96        // Cases de stockage (compteur/jauge : 1, histogramme : buckets + 2)
+#define METRICS_MAX_BUCKETS 8       // Bornes d'un histogramme (hors +Inf)
+#define METRICS_LINE_MAX 128        // Longueur max d'une ligne exportée
+
+struct MetricsStorage {
+    uint32_t magic;
+    uint32_t layout;                // Empreinte des métriques enregistrées
+    uint32_t slots[METRICS_MAX_SLOTS];
+};
+
+enum MetricType {
+    METRIC_COUNTER,
+    METRIC_GAUGE,
+    METRIC_HISTOGRAM
+};
+
+class Metric {
+public:
+    Metric(const char* name, const char* help, MetricType type, uint8_t slotCount);
+    
+    const char* name;
+    const char* help;
+    MetricType type;
+    uint16_t slot;                  // Première case dans MetricsStorage::slots
+    
+protected:
+    uint32_t* slots() const;
+};
+
+// Compteur monotone (cumulé sur tous les cycles)
+class Counter : public Metric {
+public:
+    Counter(const char* name, const char* help) : Metric(name, help, METRIC_COUNTER, 1) {}
+    void inc(uint32_t n = 1);
+    uint32_t value() const;
+};
+
+// Dernière valeur observée
+class Gauge : public Metric {
+public:
+    Gauge(const char* name, const char* help) : Metric(name, help, METRIC_GAUGE, 1) {}
+    void set(float value);
+    float value() const;
+};
+
+// Histogramme à bornes fixes (croissantes), cumulatif à l'export
+class Histogram : public Metric {
+public:
+    Histogram(const char* name, const char* help, const float* bounds, uint8_t boundCount);
+    void observe(float value);
+    uint32_t count() const;
+    
+    const float* bounds;
+    uint8_t boundCount;
+};
+
+// Ligne de texte exportée (sans '\n')
+typedef void (*MetricsWriter)(const char* line, void* context);
+
+// Associe le stockage ; il est remis à zéro si les métriques ont changé
+// (nouveau firmware) ou si le stockage n'a jamais été initialisé
+void metricsBegin(MetricsStorage* storage);
+
+// Export texte de toutes les métriques enregistrées
+void metricsExport(MetricsWriter writer, void* context);
+
+int metricsCount();
+
+#endif // METRICS_H
@@ -0,0 +1,104 @@
+#include "power.h"
+#include <string.h>
+#include <config.h>
+
+// ==========================================
+// PROFILS
+// ==========================================
+const PowerProfile POWER_PROFILES[POWER_MODE_COUNT] = {
+    // nom        entrée (mV)           sommeil  scan  O2     Android
+    {"normal",   0,                     1,       100,  true,  true},
+    {"eco",      BATTERY_ECO_MV,        2,       70,   true,  true},
+    {"critical", BATTERY_CRITICAL_MV,   4,       50,   false, false},
+    {"survival", BATTERY_SURVIVAL_MV,   8,       30,   false, false},
+};
+
+// ==========================================
+// MESURE
+// ==========================================
+uint16_t batteryReadMv(uint32_t (*readAdcMv)(uint8_t pin)) {
+#if BATTERY_MONITOR
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < BATTERY_SAMPLES; i++) {
+        sum += readAdcMv(BATTERY_ADC_PIN);
+    }
+    return (uint16_t)(sum / BATTERY_SAMPLES * BATTERY_DIVIDER_RATIO);
+#else
+    (void)readAdcMv;
+    return 0;
+#endif
+}
+
+// ==========================================
+// SÉLECTION DU MODE
+// ==========================================
+PowerMode selectPowerMode(uint16_t mv, PowerMode current) {
+    if (mv == 0) return current;
+    
+    // Descente directe vers le mode le plus économe dont le seuil est franchi
+    for (int m = POWER_MODE_COUNT - 1; m > current; m--) {
+        if (mv < POWER_PROFILES[m].enterMv) return (PowerMode)m;
+    }
+    
+    // Remontée d'un seul mode, avec hystérésis
+    if (current > POWER_NORMAL && mv > POWER_PROFILES[current].enterMv + BATTERY_HYSTERESIS_MV) {
+        return (PowerMode)(current - 1);
+    }
+    return current;
+}
+
+bool powerUpdate(BatteryState& state, uint16_t sampleMv) {
+    if (sampleMv == 0) return false;
+    
+    if (!state.valid) {
+        state.filteredMv = sampleMv;
+        state.mode = POWER_NORMAL;
+        state.valid = 1;
+    } else {
+        state.filteredMv = (uint16_t)(BATTERY_FILTER_ALPHA * sampleMv +
+                                      (1.0f - BATTERY_FILTER_ALPHA) * state.filteredMv + 0.5f);
+    }
+    
+    PowerMode next = selectPowerMode(state.filteredMv, (PowerMode)state.mode);
+    if (next == state.mode) return false;
+    state.mode = next;
+    return true;
+}
+
+uint16_t powerSleepMinutes(uint16_t minutes, PowerMode mode) {
+    uint32_t scaled = (uint32_t)minutes * POWER_PROFILES[mode].sleepFactor;
+    return scaled > 1440 ? 1440 : (uint16_t)scaled;
+}
+
+// ==========================================
+// BILAN ÉNERGÉTIQUE
+// ==========================================
+uint32_t energyDayKey(const DateTime& dt) {
+    return (uint32_t)dt.year * 10000 + dt.month * 100 + dt.day;
+}
+
+bool energyRollover(EnergyLedger& ledger, const DateTime& now, EnergyLedger* finished) {
+    uint32_t key = energyDayKey(now);
+    if (ledger.dayKey == key) return false;
+    
+    bool hadDay = ledger.dayKey != 0;
+    if (hadDay && finished != nullptr) {
+        *finished = ledger;
+    }
+    memset(&ledger, 0, sizeof(ledger));
+    ledger.dayKey = key;
+    return hadDay;
+}
+
+void energyAdd(EnergyLedger& ledger, uint8_t state, uint32_t ms) {
+    if (state >= ENERGY_MAX_STATES) return;
+    ledger.activeMs[state] += ms;
+}
+
+float energyTotalMah(const EnergyLedger& ledger, const float* stateMa, uint8_t stateCount, float sleepMa) {
+    float mAms = ledger.sleepMs * sleepMa;
+    for (uint8_t i = 0; i < stateCount && i < ENERGY_MAX_STATES; i++) {
+        mAms += ledger.activeMs[i] * stateMa[i];
+    }
+    return mAms / 3600000.0f;
+}
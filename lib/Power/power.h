@@ -0,0 +1,85 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdint.h>
+#include <format.h>
+
+// ==========================================
+// MODES DE FONCTIONNEMENT SELON LA BATTERIE
+// ==========================================
+// La tension filtrée fait descendre la carte d'un mode à l'autre dès qu'elle
+// passe sous le seuil d'entrée ; elle ne remonte que d'un mode à la fois, une
+// fois le seuil dépassé de BATTERY_HYSTERESIS_MV (pas d'oscillation due à la
+// chute de tension sous charge). Une tension nulle (pas de mesure) ne change
+// rien.
+
+enum PowerMode : uint8_t {
+    POWER_NORMAL,
+    POWER_ECO,          // Sommeil allongé, scan raccourci
+    POWER_CRITICAL,     // + plus d'O2 ni de fenêtre Android
+    POWER_SURVIVAL,     // Juste assez pour ne pas perdre les mesures
+    POWER_MODE_COUNT
+};
+
+struct PowerProfile {
+    const char* name;
+    uint16_t enterMv;           // Mode adopté sous cette tension (0 = mode normal)
+    uint8_t sleepFactor;        // Multiplicateur de la durée de sommeil
+    uint8_t scanPercent;        // Durée de scan en % de la configuration
+    bool oxygen;                // Lecture du SEN0322 (SLAVE_APPORT)
+    bool androidWindows;        // Fenêtres de synchronisation Android
+};
+
+extern const PowerProfile POWER_PROFILES[POWER_MODE_COUNT];
+
+// État conservé en RTC entre deux réveils
+struct BatteryState {
+    uint16_t filteredMv;
+    uint8_t mode;               // PowerMode
+    uint8_t valid;
+};
+
+// Tension batterie : moyenne de BATTERY_SAMPLES lectures de l'ADC (mV au
+// pont diviseur, analogReadMilliVolts sur la carte), corrigée du rapport
+// BATTERY_DIVIDER_RATIO. 0 si BATTERY_MONITOR est désactivé.
+uint16_t batteryReadMv(uint32_t (*readAdcMv)(uint8_t pin));
+
+// Mode visé pour une tension filtrée, en partant du mode courant
+PowerMode selectPowerMode(uint16_t mv, PowerMode current);
+
+// Ajoute une mesure (filtre exponentiel) et met le mode à jour.
+// Retourne true si le mode a changé.
+bool powerUpdate(BatteryState& state, uint16_t sampleMv);
+
+// Durée de sommeil allongée selon le mode (plafonnée à une journée)
+uint16_t powerSleepMinutes(uint16_t minutes, PowerMode mode);
+
+// ==========================================
+// BILAN ÉNERGÉTIQUE JOURNALIER
+// ==========================================
+// Temps passé dans chaque état du cycle (et en sommeil) pour la journée
+// courante ; la consommation s'en déduit avec le courant moyen de chaque état.
+
+#define ENERGY_MAX_STATES 8
+
+struct EnergyLedger {
+    uint32_t dayKey;            // AAAAMMJJ de la journée comptée (0 = vide)
+    uint32_t activeMs[ENERGY_MAX_STATES];
+    uint32_t sleepMs;
+    uint16_t wakeups;
+    uint16_t batteryMv;         // Dernière tension filtrée de la journée
+    uint8_t mode;               // Dernier mode de la journée (PowerMode)
+};
+
+uint32_t energyDayKey(const DateTime& dt);
+
+// Change de journée si besoin : retourne true si `ledger` contenait une
+// journée terminée, copiée dans `finished` avant remise à zéro
+bool energyRollover(EnergyLedger& ledger, const DateTime& now, EnergyLedger* finished);
+
+void energyAdd(EnergyLedger& ledger, uint8_t state, uint32_t ms);
+
+// mAh consommés : stateMa[i] pour l'état i, sleepMa en sommeil
+float energyTotalMah(const EnergyLedger& ledger, const float* stateMa, uint8_t stateCount, float sleepMa);
+
+#endif
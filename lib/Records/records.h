@@ -0,0 +1,171 @@
+#ifndef RECORDS_H
+#define RECORDS_H
+
+#include <stdint.h>
+#include <math.h>
+#include <schema.h>
+
+// ==========================================
+// FORMAT DES LOTS DE MESURES (esclave -> maître)
+// ==========================================
+// Un esclave conserve ses mesures en mémoire RTC et les envoie par lots :
+// un en-tête SlaveBatchHeader suivi de `count` SlaveRecord, du plus ancien au
+// plus récent. Le maître acquitte en écrivant le dernier numéro de séquence
+// reçu (uint16_t, little-endian) sur la caractéristique d'acquittement.
+//
+// Un esclave relais ajoute après son propre lot ceux qu'il a reçus d'esclaves
+// hors de portée du maître : un lot par carte d'origine (boardId = origine,
+// hops > 0). Le maître élimine les doublons par (origine, seq).
+
+#define RECORD_FORMAT_VERSION 3
+#define RECORD_NO_VALUE INT16_MIN       // Valeur absente (capteur manquant ou invalide)
+
+struct __attribute__((packed)) SlaveBatchHeader {
+    uint8_t version;        // RECORD_FORMAT_VERSION
+    uint8_t boardId;        // ID de la carte émettrice
+    uint8_t count;          // Nombre d'enregistrements qui suivent
+    uint8_t hops;           // Relais traversés (0 = lot de l'émetteur lui-même)
+};
+
+struct __attribute__((packed)) SlaveRecord {
+    uint16_t seq;           // Numéro de séquence (croissant, propre à chaque carte)
+    uint16_t ageMinutes;    // Minutes dormies depuis la mesure (0 = réveil courant, plafonné à 0xFFFF)
+    int16_t values[FIELD_COUNT];    // Centièmes, par grandeur du schéma (RECORD_NO_VALUE si absente)
+    uint16_t battery;       // Tension batterie de l'émetteur en mV (0 = non mesurée)
+};
+
+// Taille max d'un lot (une lecture GATT longue est limitée à 512 octets)
+#define RECORD_BATCH_MAX_BYTES 512
+#define RECORD_BATCH_MAX_COUNT \
+    ((RECORD_BATCH_MAX_BYTES - sizeof(SlaveBatchHeader)) / sizeof(SlaveRecord))
+
+inline int16_t encodeCenti(float value) {
+    if (isnan(value)) return RECORD_NO_VALUE;
+    float scaled = value * 100.0f;
+    if (scaled > INT16_MAX) return INT16_MAX;
+    if (scaled <= INT16_MIN) return INT16_MIN + 1;
+    return (int16_t)lroundf(scaled);
+}
+
+inline float decodeCenti(int16_t value) {
+    if (value == RECORD_NO_VALUE) return NAN;
+    return value / 100.0f;
+}
+
+// Âge d'une mesure en minutes, plafonné au champ de SlaveRecord
+inline uint16_t clampAgeMinutes(uint32_t minutes) {
+    return minutes > UINT16_MAX ? UINT16_MAX : (uint16_t)minutes;
+}
+
+// Comparaison de numéros de séquence avec rebouclage sur 16 bits
+inline bool seqAtOrBefore(uint16_t a, uint16_t b) {
+    return (int16_t)(a - b) <= 0;
+}
+
+// ==========================================
+// ÉLIMINATION DES DOUBLONS (maître)
+// ==========================================
+// Fenêtre glissante par carte d'origine : bit i de `seen` = séquence
+// (highest - i) déjà reçue. Une mesure peut arriver en double par le relais et
+// en direct, ou être renvoyée après un acquittement perdu.
+#define SEQ_WINDOW_SIZE 64
+#define SEQ_RESTART_GAP 1024    // Recul au-delà duquel la carte a perdu son RTC (séquences remises à 0)
+
+struct SeqWindow {
+    uint64_t seen;
+    uint16_t highest;
+    uint8_t valid;
+};
+
+// Verdict de la fenêtre pour une séquence
+enum SeqStatus : uint8_t {
+    SEQ_NEW,            // Jamais reçue
+    SEQ_DUPLICATE,      // Déjà reçue
+    SEQ_TOO_OLD         // Antérieure à la fenêtre : impossible à vérifier
+};
+
+// Examine seq sans modifier la fenêtre
+inline SeqStatus seqWindowCheck(const SeqWindow& window, uint16_t seq) {
+    int16_t diff = (int16_t)(seq - window.highest);
+    if (!window.valid || diff <= -SEQ_RESTART_GAP || diff > 0) {
+        return SEQ_NEW;
+    }
+    
+    uint16_t behind = (uint16_t)(-diff);
+    if (behind >= SEQ_WINDOW_SIZE) {
+        return SEQ_TOO_OLD;
+    }
+    return (window.seen & (1ULL << behind)) ? SEQ_DUPLICATE : SEQ_NEW;
+}
+
+// Marque seq comme reçue, une fois la mesure enregistrée
+inline void seqWindowMark(SeqWindow& window, uint16_t seq) {
+    int16_t diff = (int16_t)(seq - window.highest);
+    
+    if (!window.valid || diff <= -SEQ_RESTART_GAP) {
+        window.valid = 1;
+        window.highest = seq;
+        window.seen = 1;
+        return;
+    }
+    
+    if (diff > 0) {
+        window.seen = (diff >= SEQ_WINDOW_SIZE) ? 0 : window.seen << diff;
+        window.seen |= 1;
+        window.highest = seq;
+        return;
+    }
+    
+    uint16_t behind = (uint16_t)(-diff);
+    if (behind < SEQ_WINDOW_SIZE) {
+        window.seen |= 1ULL << behind;
+    }
+}
+
+// Retourne true si seq n'a jamais été reçue (et la marque comme reçue)
+inline bool seqWindowAccept(SeqWindow& window, uint16_t seq) {
+    if (seqWindowCheck(window, seq) != SEQ_NEW) {
+        return false;
+    }
+    seqWindowMark(window, seq);
+    return true;
+}
+
+// ==========================================
+// AJOUT DES MESURES D'UN LOT (maître)
+// ==========================================
+struct StoreResult {
+    uint8_t stored;
+    uint8_t duplicates;
+    uint8_t tooOld;         // Antérieures à la fenêtre, ignorées
+    bool complete;          // false : `out` plein avant la fin du lot
+};
+
+// Ajoute à out[*count] (capacity au plus) les mesures jamais reçues. Une
+// séquence n'est marquée reçue qu'une fois sa mesure ajoutée : les mesures
+// qui ne tiennent pas seront acceptées lorsque le lot sera renvoyé.
+inline StoreResult storeNewRecords(SeqWindow& window, const SlaveRecord* records, uint8_t n,
+                                   SlaveRecord* out, uint8_t* count, uint8_t capacity) {
+    StoreResult result = {0, 0, 0, true};
+    for (uint8_t i = 0; i < n; i++) {
+        SeqStatus status = seqWindowCheck(window, records[i].seq);
+        if (status == SEQ_DUPLICATE) {
+            result.duplicates++;
+            continue;
+        }
+        if (status == SEQ_TOO_OLD) {
+            result.tooOld++;
+            continue;
+        }
+        if (*count >= capacity) {
+            result.complete = false;
+            break;
+        }
+        out[(*count)++] = records[i];
+        seqWindowMark(window, records[i].seq);
+        result.stored++;
+    }
+    return result;
+}
+
+#endif // RECORDS_H
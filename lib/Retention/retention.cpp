@@ -0,0 +1,125 @@
+#include "retention.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const char TIER_PREFIX[TIER_COUNT] = {'r', 'h', 'd'};
+
+// ==========================================
+// FICHIERS DES NIVEAUX
+// ==========================================
+void boardArchivePath(char* out, size_t len, uint8_t boardId, const char* ext) {
+    const char* name = schemaValidBoard(boardId) ? BOARD_SPECS[boardId - 1].name : "carte";
+    snprintf(out, len, "/%s%s", name, ext);
+}
+
+void tierPath(char* out, size_t len, uint8_t boardId, RetentionTier tier, uint32_t period, const char* ext) {
+    const char* name = schemaValidBoard(boardId) ? BOARD_SPECS[boardId - 1].name : "carte";
+    snprintf(out, len, "/%s/%c%lu%s", name, TIER_PREFIX[tier], (unsigned long)period, ext);
+}
+
+struct PeriodList {
+    RetentionTier tier;
+    const char* ext;
+    uint32_t* periods;
+    int max;
+    int count;
+};
+
+static void addPeriod(void* context, const char* name) {
+    PeriodList* list = (PeriodList*)context;
+    char* end;
+    uint32_t period = name[0] == TIER_PREFIX[list->tier] ? strtoul(name + 1, &end, 10) : 0;
+    if (period == 0 || strcmp(end, list->ext) != 0 || list->count >= list->max) return;
+
+    // Insertion triée (quelques dizaines de fichiers au plus)
+    int i = list->count++;
+    while (i > 0 && list->periods[i - 1] > period) {
+        list->periods[i] = list->periods[i - 1];
+        i--;
+    }
+    list->periods[i] = period;
+}
+
+int listTierPeriods(Storage& storage, uint8_t boardId, RetentionTier tier, const char* ext,
+                    uint32_t* periods, int maxPeriods) {
+    char dir[16];
+    boardArchivePath(dir, sizeof(dir), boardId, "");
+    PeriodList list = {tier, ext, periods, maxPeriods, 0};
+    storage.list(dir, addPeriod, &list);
+    return list.count;
+}
+
+// ==========================================
+// PÉRIODES DES FICHIERS
+// ==========================================
+uint32_t tierPeriod(RetentionTier tier, uint32_t time) {
+    DateTime dt = epochToDateTime(time);
+    if (tier == TIER_DAILY) return dt.year;
+    return dt.year * 100 + dt.month;
+}
+
+uint32_t tierPeriodEnd(RetentionTier tier, uint32_t period) {
+    DateTime next = {0, 1, 1, 0, 0, 0};
+    if (tier == TIER_DAILY) {
+        next.year = period + 1;
+    } else {
+        next.year = period / 100;
+        next.month = period % 100 + 1;
+        if (next.month > 12) {
+            next.month = 1;
+            next.year++;
+        }
+    }
+    return (uint32_t)dateTimeToEpoch(next);
+}
+
+bool tierExpired(RetentionTier tier, uint32_t period, uint32_t now, uint16_t keepDays) {
+    if (keepDays == 0) return false;
+    uint32_t horizon = (uint32_t)keepDays * 86400UL;
+    return now > horizon && tierPeriodEnd(tier, period) <= now - horizon;
+}
+
+uint32_t tierStep(RetentionTier tier) {
+    switch (tier) {
+        case TIER_HOURLY: return 3600UL;
+        case TIER_DAILY:  return 86400UL;
+        default:          return 0;
+    }
+}
+
+// ==========================================
+// AGRÉGATS
+// ==========================================
+void bucketReset(TierBucket& bucket, uint32_t start) {
+    memset(&bucket, 0, sizeof(bucket));
+    bucket.start = start;
+}
+
+bool bucketEmpty(const TierBucket& bucket, uint8_t channels) {
+    for (int c = 0; c < channels; c++) {
+        if (bucket.count[c] > 0) return false;
+    }
+    return true;
+}
+
+void bucketAdd(TierBucket& bucket, const int32_t* values, uint8_t channels) {
+    for (int c = 0; c < channels; c++) {
+        if (values[c] == CSV_NO_VALUE) continue;
+        bucket.sum[c] += values[c];
+        bucket.count[c]++;
+    }
+}
+
+void bucketMean(const TierBucket& bucket, int32_t* values, uint8_t channels) {
+    for (int c = 0; c < channels; c++) {
+        if (bucket.count[c] == 0) {
+            values[c] = CSV_NO_VALUE;
+            continue;
+        }
+        // Arrondi au plus proche, symétrique autour de zéro
+        int32_t half = bucket.count[c] / 2;
+        values[c] = bucket.sum[c] >= 0 ? (bucket.sum[c] + half) / bucket.count[c]
+                                       : (bucket.sum[c] - half) / bucket.count[c];
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef RETENTION_H
+#define RETENTION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <format.h>
+#include <storage.h>
+
+// ==========================================
+// NIVEAUX DE RÉTENTION DES MESURES
+// ==========================================
+// Une carte conserve ses mesures sur trois niveaux de résolution :
+//   brut     (pas du cycle)  fichiers mensuels, blocs compactés
+//   horaire  (moyennes)      fichiers mensuels, CSV
+//   journée  (moyennes)      fichiers annuels, CSV
+// Un fichier plus ancien que l'horizon de son niveau est agrégé dans le
+// niveau suivant puis supprimé : la place occupée reste bornée et aucun
+// fichier n'est jamais réécrit en entier.
+//
+// Les dates sont locales, en secondes depuis 1970 (dateTimeToEpoch).
+
+enum RetentionTier : uint8_t {
+    TIER_RAW,
+    TIER_HOURLY,
+    TIER_DAILY,
+    TIER_COUNT
+};
+
+#define TIER_MAX_CHANNELS 3
+#define RETENTION_MAX_PERIODS 128       // Fichiers d'un niveau examinés au plus
+
+// Préfixe des fichiers de chaque niveau ("r202601.gor", "h202601.csv", "d2026.csv")
+extern const char TIER_PREFIX[TIER_COUNT];
+
+// Dossier des fichiers d'une carte ("/apport", ext = "") ou fichier voisin
+// du CSV ("/apport.tmp", ext = ".tmp")
+void boardArchivePath(char* out, size_t len, uint8_t boardId, const char* ext);
+
+// Fichier d'un niveau : "/apport/r202601.gor", "/apport/d2026.csv"
+void tierPath(char* out, size_t len, uint8_t boardId, RetentionTier tier, uint32_t period, const char* ext);
+
+// Périodes présentes pour un niveau, dans l'ordre chronologique
+int listTierPeriods(Storage& storage, uint8_t boardId, RetentionTier tier, const char* ext,
+                    uint32_t* periods, int maxPeriods);
+
+// Période d'un fichier : AAAAMM (brut, horaire) ou AAAA (journée)
+uint32_t tierPeriod(RetentionTier tier, uint32_t time);
+
+// Début de la période suivante (la période est entièrement passée à cette date)
+uint32_t tierPeriodEnd(RetentionTier tier, uint32_t period);
+
+// Fichier à agréger (ou à supprimer) : toute la période dépasse l'horizon.
+// keepDays = 0 : conservé indéfiniment.
+bool tierExpired(RetentionTier tier, uint32_t period, uint32_t now, uint16_t keepDays);
+
+// Durée d'un agrégat de ce niveau (0 pour le brut)
+uint32_t tierStep(RetentionTier tier);
+
+// Agrégat en cours (moyenne d'une heure ou d'une journée)
+struct TierBucket {
+    uint32_t start;                         // Début de l'heure ou du jour
+    uint16_t count[TIER_MAX_CHANNELS];      // Valeurs présentes par champ
+    int32_t sum[TIER_MAX_CHANNELS];         // En centièmes
+};
+
+void bucketReset(TierBucket& bucket, uint32_t start);
+bool bucketEmpty(const TierBucket& bucket, uint8_t channels);
+
+// values en centièmes, CSV_NO_VALUE ignorée
+void bucketAdd(TierBucket& bucket, const int32_t* values, uint8_t channels);
+
+// Moyennes arrondies (CSV_NO_VALUE pour un champ sans valeur)
+void bucketMean(const TierBucket& bucket, int32_t* values, uint8_t channels);
+
+#endif
@@ -0,0 +1,288 @@
+#include "rollup.h"
+#include <math.h>
+#include <string.h>
+#include <format.h>
+#include <screening.h>
+
+enum RollupProgress : uint8_t {
+    ROLLUP_MORE,                    // Reste des mesures à lire
+    ROLLUP_DONE,                    // Fichier source entièrement lu
+    ROLLUP_FAILED                   // Écriture en échec
+};
+
+// ==========================================
+// LIGNES DES FICHIERS AGRÉGÉS
+// ==========================================
+size_t formatArchiveRow(char* out, size_t maxLen, uint8_t boardId, uint32_t time,
+                        const int32_t* values, int32_t quality) {
+    char isoTime[ISO8601_LENGTH + 1];
+    formatISO8601(isoTime, epochToDateTime(time));
+    uint8_t channels = boardFieldCount(boardId);
+    float decoded[SCHEMA_MAX_FIELDS];
+    for (int c = 0; c < channels; c++) {
+        decoded[c] = values[c] == CSV_NO_VALUE ? NAN : values[c] / 100.0f;
+    }
+
+    size_t length = formatCsvRow(out, maxLen, boardId, isoTime, decoded);
+    if (length > 0 && quality >= 0) {
+        // Qualité inconnue : colonne vide, comme les lignes antérieures au contrôle
+        length = appendQualityColumn(out, length, maxLen, (uint16_t)quality,
+                                     quality == QUALITY_UNKNOWN ? 0 : channels);
+    }
+    return length;
+}
+
+bool rolledUp(const RetentionJob& job, uint8_t boardId, RetentionTier tier, uint32_t period, uint32_t time) {
+    if (job.boardId != boardId || job.source != tier || job.period != period) return false;
+    uint32_t step = tierStep((RetentionTier)(tier + 1));
+    return time - time % step <= job.lastTime;
+}
+
+void rollupTargetPath(const RetentionJob& job, char* out, size_t len) {
+    RetentionTier target = (RetentionTier)(job.source + 1);
+    uint32_t period = target == TIER_DAILY ? job.period / 100 : job.period;
+    tierPath(out, len, job.boardId, target, period, ".csv");
+}
+
+uint32_t lastRowTime(Storage& storage, const char* path, uint8_t channels, BlockReader& reader) {
+    StorageBlockFile csv = {&storage, storage.open(path, STORAGE_READ)};
+    if (csv.file == nullptr) return 0;
+
+    uint32_t lastTime = 0;
+    uint32_t size = storage.size(csv.file);
+    reader.begin(storageReadBlock, &csv, size > 2 * CSV_ROW_MAX ? size - 2 * CSV_ROW_MAX : 0, size);
+    char line[CSV_ROW_MAX + 16];
+    while (reader.readLine(line, sizeof(line))) {
+        DateTime dt;
+        int32_t values[TIER_MAX_CHANNELS];
+        if (parseCsvRow(line, &dt, values, channels) >= 0) {
+            lastTime = (uint32_t)dateTimeToEpoch(dt);
+        }
+    }
+    storage.close(csv.file);
+    return lastTime;
+}
+
+// ==========================================
+// AGRÉGATS
+// ==========================================
+// Écrit l'agrégat terminé dans le fichier cible (s'il n'y est pas déjà)
+static bool emitBucket(Storage& storage, StorageFile target, RetentionJob& work, RetentionReport* report) {
+    uint8_t channels = boardFieldCount(work.boardId);
+    if (bucketEmpty(work.bucket, channels) || work.bucket.start <= work.lastTime) return true;
+
+    int32_t means[TIER_MAX_CHANNELS];
+    bucketMean(work.bucket, means, channels);
+    char row[CSV_ROW_MAX];
+    size_t length = formatArchiveRow(row, sizeof(row), work.boardId, work.bucket.start, means);
+    if (length == 0 || storage.write(target, (const uint8_t*)row, length) != length) return false;
+
+    work.lastTime = work.bucket.start;
+    report->rows++;
+    report->bytes += length;
+    return true;
+}
+
+// Ajoute une mesure à l'agrégat de son heure (ou de son jour), après avoir
+// écrit le précédent
+static bool addToBucket(Storage& storage, StorageFile target, RetentionJob& work, uint32_t time,
+                        const int32_t* values, RetentionReport* report) {
+    uint32_t step = tierStep((RetentionTier)(work.source + 1));
+    uint32_t start = time - time % step;
+    if (start != work.bucket.start) {
+        if (!emitBucket(storage, target, work, report)) return false;
+        bucketReset(work.bucket, start);
+    }
+    bucketAdd(work.bucket, values, boardFieldCount(work.boardId));
+    return true;
+}
+
+// Agrège le bloc work.position du fichier brut
+static RollupProgress rollupRawBlock(Storage& storage, StorageFile target, ArchivePeriod& archive,
+                                     RetentionJob& work, RetentionReport* report) {
+    ArchiveIndexEntry entry;
+    GorillaDecoder decoder;
+    ArchiveBlockStatus status = archive.read(work.position, &entry, &decoder);
+    if (status == ARCHIVE_BLOCK_END) return ROLLUP_DONE;
+    work.position++;
+    if (status == ARCHIVE_BLOCK_CORRUPT) {
+        // Bloc illisible : ignoré, comme à l'export
+        report->corruptBlocks++;
+        return ROLLUP_MORE;
+    }
+
+    uint8_t channels = boardFieldCount(work.boardId);
+    bool hasQuality = entry.header.channels > channels;
+    uint32_t time;
+    int32_t values[GORILLA_MAX_CHANNELS];
+    while (decoder.next(&time, values)) {
+        // Valeurs suspectes ou rejetées : hors des moyennes
+        // (qualité inconnue : mesure antérieure au contrôle, gardée)
+        for (uint8_t c = 0; hasQuality && values[channels] != QUALITY_UNKNOWN && c < channels; c++) {
+            if (!qualityUsable(values[channels], c)) values[c] = CSV_NO_VALUE;
+        }
+        if (!addToBucket(storage, target, work, time, values, report)) return ROLLUP_FAILED;
+    }
+    return ROLLUP_MORE;
+}
+
+// Agrège des lignes du fichier horaire jusqu'à deadline
+static RollupProgress rollupHourlyLines(Storage& storage, StorageFile target, BlockReader& reader,
+                                        RetentionJob& work, uint32_t deadline, StorageClock clock,
+                                        RetentionReport* report) {
+    char line[CSV_ROW_MAX + 16];
+    if (work.position == 0) {
+        reader.readLine(line, sizeof(line));        // En-tête
+        work.position = reader.position();
+    }
+
+    uint8_t channels = boardFieldCount(work.boardId);
+    while ((int32_t)(deadline - clock()) > 0) {
+        if (!reader.readLine(line, sizeof(line))) return ROLLUP_DONE;
+        work.position = reader.position();
+
+        DateTime dt;
+        int32_t values[TIER_MAX_CHANNELS];
+        int count = parseCsvRow(line, &dt, values, channels);
+        if (count < 0) continue;
+        for (int c = count; c < channels; c++) values[c] = CSV_NO_VALUE;
+
+        if (!addToBucket(storage, target, work, (uint32_t)dateTimeToEpoch(dt), values, report)) {
+            return ROLLUP_FAILED;
+        }
+    }
+    return ROLLUP_MORE;
+}
+
+// ==========================================
+// CHOIX DU TRAVAIL ET ÉTAPES
+// ==========================================
+bool retentionPickJob(Storage& storage, RetentionJob& job, const RetentionHorizons& keepDays,
+                      uint32_t now, ArchiveScratch& scratch, RetentionReport* report) {
+    uint32_t periods[RETENTION_MAX_PERIODS];
+    char path[32];
+
+    for (uint8_t boardId = 1; boardId <= SCHEMA_BOARDS; boardId++) {
+        // Journalier : suppression directe des années trop anciennes
+        int count = listTierPeriods(storage, boardId, TIER_DAILY, ".csv", periods, RETENTION_MAX_PERIODS);
+        for (int p = 0; p < count; p++) {
+            if (!tierExpired(TIER_DAILY, periods[p], now, keepDays[boardId - 1][TIER_DAILY])) break;
+            tierPath(path, sizeof(path), boardId, TIER_DAILY, periods[p], ".csv");
+            if (storage.remove(path)) report->dropped++;
+        }
+
+        // Brut puis horaire : le plus ancien fichier, s'il a dépassé l'horizon
+        for (int tier = TIER_RAW; tier <= TIER_HOURLY; tier++) {
+            count = listTierPeriods(storage, boardId, (RetentionTier)tier, tier == TIER_RAW ? ".idx" : ".csv",
+                                    periods, RETENTION_MAX_PERIODS);
+            if (count == 0 || !tierExpired((RetentionTier)tier, periods[0], now, keepDays[boardId - 1][tier])) {
+                continue;
+            }
+
+            memset(&job, 0, sizeof(job));
+            job.boardId = boardId;
+            job.source = tier;
+            job.period = periods[0];
+            rollupTargetPath(job, path, sizeof(path));
+            job.lastTime = lastRowTime(storage, path, boardFieldCount(boardId), scratch.reader);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool rollupStep(Storage& storage, RetentionJob& job, uint32_t deadline, StorageClock clock,
+                ArchiveScratch& scratch, RetentionReport* report) {
+    char path[32];
+    rollupTargetPath(job, path, sizeof(path));
+    if (!storage.exists(path)) {
+        char header[CSV_ROW_MAX + 1];
+        size_t length = formatCsvHeader(header, CSV_ROW_MAX, job.boardId);
+        header[length++] = '\n';
+        if (!storageAppend(storage, path, (const uint8_t*)header, length)) {
+            storage.remove(path);           // Pas de fichier cible sans en-tête
+            report->writeFailed = true;
+            job.boardId = 0;
+            return false;
+        }
+        report->bytes += length;
+    }
+    StorageFile target = storage.open(path, STORAGE_APPEND);
+    if (target == nullptr) {
+        report->writeFailed = true;
+        job.boardId = 0;
+        return false;
+    }
+
+    // Source absente (supprimée à la main) : agrégation terminée
+    bool raw = job.source == TIER_RAW;
+    ArchivePeriod archive;
+    StorageBlockFile source = {&storage, nullptr};
+    bool opened;
+    if (raw) {
+        opened = archive.open(storage, job.boardId, job.period, scratch.block);
+    } else {
+        tierPath(path, sizeof(path), job.boardId, TIER_HOURLY, job.period, ".csv");
+        source.file = storage.open(path, STORAGE_READ);
+        opened = source.file != nullptr;
+        if (opened) scratch.reader.begin(storageReadBlock, &source, job.position, storage.size(source.file));
+    }
+
+    // Copie de travail : l'état n'avance qu'une fois les agrégats écrits
+    RetentionJob work = job;
+    RollupProgress progress = ROLLUP_MORE;
+    while (progress == ROLLUP_MORE && (int32_t)(deadline - clock()) > 0) {
+        if (!opened) {
+            progress = ROLLUP_DONE;
+        } else if (raw) {
+            progress = rollupRawBlock(storage, target, archive, work, report);
+        } else {
+            progress = rollupHourlyLines(storage, target, scratch.reader, work, deadline, clock, report);
+        }
+        if (progress == ROLLUP_DONE && !emitBucket(storage, target, work, report)) progress = ROLLUP_FAILED;
+        if (progress != ROLLUP_FAILED) job = work;
+    }
+
+    storage.close(target);
+    if (raw && opened) archive.close();
+    if (source.file) storage.close(source.file);
+
+    if (progress == ROLLUP_FAILED) {
+        report->writeFailed = true;
+        job.boardId = 0;
+        return false;
+    }
+    if (progress == ROLLUP_MORE) return false;
+
+    // Source entièrement agrégée : suppression
+    if (raw) {
+        tierPath(path, sizeof(path), job.boardId, TIER_RAW, job.period, ".idx");
+        storage.remove(path);
+        tierPath(path, sizeof(path), job.boardId, TIER_RAW, job.period, ".gor");
+        storage.remove(path);
+    } else {
+        tierPath(path, sizeof(path), job.boardId, TIER_HOURLY, job.period, ".csv");
+        storage.remove(path);
+    }
+    report->rollups++;
+    return true;
+}
+
+void runRetention(Storage& storage, RetentionJob& job, uint32_t* checkedDay, uint32_t today,
+                  const RetentionHorizons& keepDays, uint32_t now, uint32_t deadline,
+                  StorageClock clock, ArchiveScratch& scratch, RetentionReport* report) {
+    memset(report, 0, sizeof(*report));
+
+    while ((int32_t)(deadline - clock()) > 0) {
+        if (job.boardId == 0) {
+            if (*checkedDay == today) return;
+            if (!retentionPickJob(storage, job, keepDays, now, scratch, report)) {
+                *checkedDay = today;
+                report->checked = true;
+                return;
+            }
+        }
+        if (!rollupStep(storage, job, deadline, clock, scratch, report)) return;
+        job.boardId = 0;
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef ROLLUP_H
+#define ROLLUP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <compaction.h>
+#include <schema.h>
+#include <storage.h>
+#include "retention.h"
+
+// ==========================================
+// AGRÉGATION DES FICHIERS EXPIRÉS
+// ==========================================
+// Un fichier mensuel brut (ou horaire) qui dépasse l'horizon de son niveau
+// est agrégé en moyennes horaires (ou journalières) ajoutées au fichier du
+// niveau suivant, puis supprimé ; un fichier journalier trop ancien est
+// simplement supprimé. Le travail avance d'un bloc (ou de quelques lignes)
+// à la fois dans le budget du cycle : l'état (RetentionJob) est conservé
+// par l'appelant, en RTC sur la carte. Après une coupure, le fichier est
+// repris depuis le début : les agrégats déjà écrits (date <= dernière date
+// du fichier cible) sont ignorés.
+
+// Agrégation en cours d'un fichier vers le niveau de rétention suivant
+struct RetentionJob {
+    uint8_t boardId;                // 0 = aucune
+    uint8_t source;                 // RetentionTier du fichier agrégé (brut ou horaire)
+    uint32_t period;                // Fichier source (AAAAMM)
+    uint32_t position;              // Bloc (brut) ou octet (horaire) suivant
+    uint32_t lastTime;              // Dernier agrégat écrit dans le fichier cible
+    TierBucket bucket;              // Agrégat en cours
+};
+
+// Horizon (jours) de chaque niveau, par carte ; 0 = conservé indéfiniment
+typedef uint16_t RetentionHorizons[SCHEMA_BOARDS][TIER_COUNT];
+
+// Bilan d'un appel de runRetention (métriques et journal)
+struct RetentionReport {
+    uint16_t rollups;               // Fichiers agrégés puis supprimés
+    uint16_t dropped;               // Fichiers journaliers expirés supprimés
+    uint32_t rows;                  // Agrégats écrits
+    uint32_t bytes;                 // Octets ajoutés aux fichiers cibles
+    uint16_t corruptBlocks;         // Blocs bruts illisibles, ignorés
+    bool writeFailed;               // Écriture en échec : agrégation abandonnée
+    bool checked;                   // Plus rien à faire : examen du jour terminé
+};
+
+// Ligne CSV d'une mesure archivée ou d'un agrégat (valeurs en centièmes),
+// terminée par '\n'. quality : colonne qualité d'une mesure brute (-1 pour
+// un agrégat ou un bloc archivé avant le contrôle des mesures).
+size_t formatArchiveRow(char* out, size_t maxLen, uint8_t boardId, uint32_t time,
+                        const int32_t* values, int32_t quality = -1);
+
+// Mesure d'un fichier en cours d'agrégation déjà présente dans le niveau
+// suivant (l'export ne la répète pas)
+bool rolledUp(const RetentionJob& job, uint8_t boardId, RetentionTier tier, uint32_t period, uint32_t time);
+
+// Fichier cible de l'agrégation en cours
+void rollupTargetPath(const RetentionJob& job, char* out, size_t len);
+
+// Date de la dernière ligne d'un CSV (0 si aucune)
+uint32_t lastRowTime(Storage& storage, const char* path, uint8_t channels, BlockReader& reader);
+
+// Supprime les fichiers journaliers expirés et cherche le plus ancien
+// fichier brut ou horaire à agréger. true si un travail est prêt dans job.
+bool retentionPickJob(Storage& storage, RetentionJob& job, const RetentionHorizons& keepDays,
+                      uint32_t now, ArchiveScratch& scratch, RetentionReport* report);
+
+// Avance l'agrégation en cours jusqu'à deadline. true une fois le fichier
+// source agrégé et supprimé.
+bool rollupStep(Storage& storage, RetentionJob& job, uint32_t deadline, StorageClock clock,
+                ArchiveScratch& scratch, RetentionReport* report);
+
+// Avance la rétention jusqu'à deadline (horloge clock). Sans travail en
+// cours, les fichiers ne sont examinés qu'une fois par jour : *checkedDay
+// (AAAAMMJJ) reçoit today quand il n'y a plus rien à faire.
+void runRetention(Storage& storage, RetentionJob& job, uint32_t* checkedDay, uint32_t today,
+                  const RetentionHorizons& keepDays, uint32_t now, uint32_t deadline,
+                  StorageClock clock, ArchiveScratch& scratch, RetentionReport* report);
+
+#endif
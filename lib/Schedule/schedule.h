@@ -0,0 +1,61 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <stdint.h>
+#include <config.h>
+#include <format.h>
+
+// ==========================================
+// POLITIQUE D'ORDONNANCEMENT
+// ==========================================
+// Décisions de cycle sans Arduino ni état global : appelées par le maître
+// (src/main.cpp), l'esclave (test/readings.cpp) et le simulateur de flotte
+// (tools/fleetsim) pour que les résultats simulés suivent le firmware.
+
+#define ACQUISITION_CONCURRENCY 3     // Liens GATT ouverts simultanément (établis un par un ; 1 = séquentiel)
+#define ACQUISITION_BUDGET_MS 20000   // Temps max consacré aux slaves par cycle (tentatives comprises)
+#define SLAVE_MAX_ATTEMPTS 3          // Tentatives de connexion par slave et par cycle
+#define SLAVE_RETRY_BASE_MS 250       // Attente avant la 2e tentative, doublée ensuite
+#define CONNECT_TIMEOUT_MIN_MS 1500   // Bornes du timeout de connexion ajusté par slave
+#define CONNECT_TIMEOUT_MAX_MS 6000
+
+// Vrai si le réveil courant doit ouvrir une fenêtre pour le téléphone :
+// premier réveil de chaque période syncPeriodMinutes, ou premier réveil
+// d'une heure présente dans hoursMask.
+inline bool syncWindowDue(const DateTime& dt, uint16_t syncPeriodMinutes,
+                          uint16_t sleepMinutes, uint32_t hoursMask) {
+    int minuteOfDay = dt.hour * 60 + dt.minute;
+    
+    if (syncPeriodMinutes > 0 && minuteOfDay % syncPeriodMinutes < sleepMinutes) {
+        return true;
+    }
+    
+    if ((hoursMask & (1UL << dt.hour)) && dt.minute < sleepMinutes) {
+        return true;
+    }
+    
+    return false;
+}
+
+// Timeout de connexion : 3x la latence habituelle du slave, borné.
+// Sans connexion réussie connue, on laisse le maximum.
+inline uint32_t connectTimeoutMs(bool everConnected, uint32_t avgConnectMs) {
+    if (!everConnected) return CONNECT_TIMEOUT_MAX_MS;
+    uint32_t timeoutMs = avgConnectMs * 3;
+    if (timeoutMs < CONNECT_TIMEOUT_MIN_MS) timeoutMs = CONNECT_TIMEOUT_MIN_MS;
+    if (timeoutMs > CONNECT_TIMEOUT_MAX_MS) timeoutMs = CONNECT_TIMEOUT_MAX_MS;
+    return timeoutMs;
+}
+
+// Attente avant la tentative suivante (attempt = tentative qui vient d'échouer)
+inline uint32_t retryBackoffMs(int attempt) {
+    return (uint32_t)SLAVE_RETRY_BASE_MS << (attempt - 1);
+}
+
+// Côté esclave : annoncer le lot tous les K réveils ou dès le seuil haut
+inline bool uploadDue(uint8_t count, uint8_t cyclesSinceUpload) {
+    if (count == 0) return false;
+    return cyclesSinceUpload >= SLAVE_UPLOAD_EVERY_K || count >= SLAVE_UPLOAD_HIGH_WATER;
+}
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef SCHEMA_H
+#define SCHEMA_H
+
+#include <stdint.h>
+#include <config.h>
+
+// ==========================================
+// SCHÉMA DES MESURES (esclaves et maître)
+// ==========================================
+// Décrit à la compilation les grandeurs mesurées et les cartes qui les
+// portent. Le reste en est déduit : disposition de SlaveRecord,
+// caractéristiques GATT lues par le maître, en-têtes et lignes CSV, nombre
+// de champs compactés, contrôlés et agrégés, résumé du cycle. Ajouter un
+// capteur = une entrée dans SensorField et FIELD_SPECS, son bit dans
+// BOARD_SPECS (et RECORD_FORMAT_VERSION, le lot changeant de taille).
+//
+// Les champs d'une carte sont numérotés dans l'ordre de SensorField, en
+// sautant les absents : la colonne n d'une ligne CSV (ou le champ n d'un
+// bloc compacté) est boardField(carte, n).
+
+enum SensorField : uint8_t {
+    FIELD_TEMPERATURE,
+    FIELD_HUMIDITY,
+    FIELD_OXYGEN,
+    FIELD_COUNT
+};
+
+// Échelle commune des valeurs transmises et archivées (centièmes, int16)
+#define SCHEMA_DECIMALS 2
+
+struct FieldSpec {
+    const char* column;         // Colonne CSV
+    const char* label;          // Journaux
+    const char* uuid;           // Caractéristique GATT de la valeur courante (float)
+    uint8_t decimals;           // Décimales transmises (SCHEMA_DECIMALS)
+};
+
+constexpr FieldSpec FIELD_SPECS[FIELD_COUNT] = {
+    {"temperature", "T",  TEMP_CHARACTERISTIC_UUID,  2},
+    {"humidity",    "H",  HUMID_CHARACTERISTIC_UUID, 2},
+    {"oxygene",     "O2", OXY_CHARACTERISTIC_UUID,   2},
+};
+
+constexpr uint8_t fieldBit(SensorField field) {
+    return 1 << field;
+}
+
+struct BoardSpec {
+    const char* name;           // Export ("apport") et dossier des archives
+    const char* file;           // CSV des mesures récentes
+    uint8_t fields;             // Bits fieldBit() des grandeurs présentes
+};
+
+#define SCHEMA_BOARDS 3
+
+// Index boardId - 1
+constexpr BoardSpec BOARD_SPECS[SCHEMA_BOARDS] = {
+    {"apport",     "/apport.csv",     fieldBit(FIELD_TEMPERATURE) | fieldBit(FIELD_HUMIDITY) | fieldBit(FIELD_OXYGEN)},
+    {"maturation", "/maturation.csv", fieldBit(FIELD_TEMPERATURE) | fieldBit(FIELD_HUMIDITY)},
+    {"exterieur",  "/exterieur.csv",  fieldBit(FIELD_TEMPERATURE) | fieldBit(FIELD_HUMIDITY)},
+};
+
+// ==========================================
+// REQUÊTES (évaluées à la compilation quand la carte est connue)
+// ==========================================
+constexpr bool schemaValidBoard(uint8_t boardId) {
+    return boardId >= 1 && boardId <= SCHEMA_BOARDS;
+}
+
+constexpr uint8_t boardFieldMask(uint8_t boardId) {
+    return schemaValidBoard(boardId) ? BOARD_SPECS[boardId - 1].fields : 0;
+}
+
+constexpr bool boardHasField(uint8_t boardId, SensorField field) {
+    return (boardFieldMask(boardId) & fieldBit(field)) != 0;
+}
+
+constexpr uint8_t countFields(uint8_t mask) {
+    return mask == 0 ? 0 : (mask & 1) + countFields(mask >> 1);
+}
+
+// Nombre de champs d'une carte (colonnes de valeurs du CSV)
+constexpr uint8_t boardFieldCount(uint8_t boardId) {
+    return countFields(boardFieldMask(boardId));
+}
+
+// Grandeur du champ n d'une carte (recherche à partir de la grandeur `from`)
+constexpr SensorField nthField(uint8_t mask, uint8_t n, uint8_t from) {
+    return from >= FIELD_COUNT ? FIELD_COUNT
+         : !(mask & (1 << from)) ? nthField(mask, n, from + 1)
+         : n == 0 ? (SensorField)from
+         : nthField(mask, n - 1, from + 1);
+}
+
+constexpr SensorField boardField(uint8_t boardId, uint8_t n) {
+    return nthField(boardFieldMask(boardId), n, 0);
+}
+
+// Plus grand nombre de champs d'une carte
+constexpr uint8_t maxBoardFields(uint8_t boardId = 1) {
+    return boardId > SCHEMA_BOARDS ? 0
+         : boardFieldCount(boardId) > maxBoardFields(boardId + 1) ? boardFieldCount(boardId)
+         : maxBoardFields(boardId + 1);
+}
+
+#define SCHEMA_MAX_FIELDS maxBoardFields()
+
+// Vue d'une carte connue à la compilation (esclave : BoardSchema<BOARD_ID>)
+template <uint8_t BoardId>
+struct BoardSchema {
+    static_assert(schemaValidBoard(BoardId), "carte absente de BOARD_SPECS");
+    static constexpr uint8_t mask = boardFieldMask(BoardId);
+    static constexpr uint8_t fieldCount = countFields(mask);
+    static constexpr bool has(SensorField field) { return (mask & fieldBit(field)) != 0; }
+    static constexpr SensorField field(uint8_t n) { return nthField(mask, n, 0); }
+};
+
+// Vérifications du schéma
+constexpr bool schemaDecimalsOk(uint8_t field = 0) {
+    return field >= FIELD_COUNT ||
+           (FIELD_SPECS[field].decimals == SCHEMA_DECIMALS && schemaDecimalsOk(field + 1));
+}
+static_assert(schemaDecimalsOk(), "toutes les grandeurs sont transmises et archivées en centièmes");
+static_assert(FIELD_COUNT <= 8, "BoardSpec::fields tient sur 8 bits");
+static_assert(boardField(1, 2) == FIELD_OXYGEN && boardField(2, 1) == FIELD_HUMIDITY, "ordre des champs");
+
+#endif // SCHEMA_H
@@ -0,0 +1,85 @@
+#include "screening.h"
+#include <records.h>
+
+const char QUALITY_LETTERS[QUALITY_CODE_COUNT] = {'-', 'M', 'R', 'D', 'S'};
+
+// ==========================================
+// CONTRÔLE D'UNE VALEUR
+// ==========================================
+QualityCode screenValue(const ScreenLimits& limits, ScreenState& state, int16_t centi, uint32_t time) {
+    if (centi == RECORD_NO_VALUE) return QUALITY_MISSING;
+    if (centi < limits.min || centi > limits.max) return QUALITY_RANGE;
+    
+    // Première valeur (ou horloge revenue en arrière) : référence
+    if (state.lastTime == 0 || time < state.lastTime) {
+        state.last = centi;
+        state.lastTime = time;
+        state.repeats = 0;
+        state.rateRun = 0;
+        return QUALITY_OK;
+    }
+    
+    // Vitesse : |écart| * 3600 > limite * durée (au moins une minute d'écart)
+    if (limits.maxRatePerHour > 0) {
+        uint32_t elapsed = time - state.lastTime;
+        if (elapsed < 60) elapsed = 60;
+        int32_t delta = (int32_t)centi - state.last;
+        if (delta < 0) delta = -delta;
+        if ((uint64_t)delta * 3600 > (uint64_t)limits.maxRatePerHour * elapsed) {
+            // Pointe isolée : la référence est gardée. Plusieurs de suite :
+            // changement de niveau réel, la nouvelle valeur devient la référence.
+            if (++state.rateRun < SCREEN_REBASE_COUNT) return QUALITY_RATE;
+        }
+    }
+    state.rateRun = 0;
+    
+    // Capteur bloqué : même valeur au centième près
+    bool stuck = false;
+    if (centi == state.last) {
+        if (state.repeats < UINT8_MAX) state.repeats++;
+        stuck = limits.stuckCount > 0 && state.repeats >= limits.stuckCount;
+    } else {
+        state.repeats = 0;
+    }
+    state.last = centi;
+    state.lastTime = time;
+    return stuck ? QUALITY_STUCK : QUALITY_OK;
+}
+
+// ==========================================
+// COLONNE QUALITÉ DU CSV
+// ==========================================
+size_t appendQualityColumn(char* row, size_t length, size_t maxLen, uint16_t quality, uint8_t channels) {
+    if (length == 0 || row[length - 1] != '\n' || length + channels + 2 > maxLen) return 0;
+    
+    char* p = row + length - 1;
+    for (uint8_t c = 0; c < channels; c++) {
+        QualityCode code = qualityCode(quality, c);
+        *p++ = code < QUALITY_CODE_COUNT ? QUALITY_LETTERS[code] : '?';
+    }
+    *p++ = ';';
+    *p++ = '\n';
+    *p = '\0';
+    return p - row;
+}
+
+uint16_t parseQualityColumn(const char* line, uint8_t channels) {
+    // Date puis une colonne par valeur
+    const char* p = line;
+    for (uint8_t field = 0; field <= channels; field++) {
+        while (*p != ';') {
+            if (*p == '\0' || *p == '\n') return QUALITY_UNKNOWN;
+            p++;
+        }
+        p++;
+    }
+    
+    uint16_t quality = 0;
+    for (uint8_t c = 0; c < channels; c++, p++) {
+        uint8_t code = 0;
+        while (code < QUALITY_CODE_COUNT && QUALITY_LETTERS[code] != *p) code++;
+        if (code == QUALITY_CODE_COUNT) return QUALITY_UNKNOWN;
+        quality = withQuality(quality, c, (QualityCode)code);
+    }
+    return *p == ';' ? quality : QUALITY_UNKNOWN;
+}
@@ -0,0 +1,82 @@
+#ifndef SCREENING_H
+#define SCREENING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ==========================================
+// CONTRÔLE DES MESURES (maître)
+// ==========================================
+// Chaque valeur reçue est contrôlée une seule fois, dans l'ordre
+// chronologique, au moment où sa ligne CSV est formée :
+//   plage     hors des bornes physiques de la carte      -> rejetée
+//   vitesse   variation trop rapide depuis la dernière
+//             valeur retenue                             -> suspecte
+//   bloqué    valeur identique trop de fois de suite     -> suspecte
+// Une valeur rejetée est écrite "nan" ; une valeur suspecte est conservée.
+// Les deux sont exclues des agrégats horaires et journaliers.
+//
+// Le code qualité d'une mesure tient sur 4 bits par champ (champ 0 en bits
+// 0-3) et s'écrit dans le CSV en une lettre par champ ("--S").
+
+#define SCREEN_MAX_CHANNELS 3
+#define SCREEN_REBASE_COUNT 3       // Variations rapides de suite acceptées comme nouveau niveau
+
+enum QualityCode : uint8_t {
+    QUALITY_OK,
+    QUALITY_MISSING,                // Absente (capteur non branché ou lecture invalide)
+    QUALITY_RANGE,                  // Hors plage : rejetée
+    QUALITY_RATE,                   // Variation trop rapide : suspecte
+    QUALITY_STUCK,                  // Capteur bloqué : suspecte
+    QUALITY_CODE_COUNT
+};
+
+// Qualité d'une mesure sans colonne qualité lisible (antérieure au contrôle,
+// ligne tronquée, code inconnu) : jamais un code valide (4 bits par champ,
+// SCREEN_MAX_CHANNELS champs au plus)
+#define QUALITY_UNKNOWN 0xFFFF
+
+// Lettre de chaque code dans la colonne qualité du CSV
+extern const char QUALITY_LETTERS[QUALITY_CODE_COUNT];
+
+// Bornes d'un champ d'une carte (centièmes)
+struct ScreenLimits {
+    int16_t min;
+    int16_t max;
+    uint16_t maxRatePerHour;        // Variation maximale par heure (0 = pas de contrôle)
+    uint8_t stuckCount;             // Valeurs identiques de suite tolérées (0 = pas de contrôle)
+};
+
+// Dernière valeur retenue d'un champ (conservée en RTC entre deux cycles)
+struct ScreenState {
+    int16_t last;
+    uint32_t lastTime;              // 0 = aucune valeur retenue
+    uint8_t repeats;                // Répétitions de last
+    uint8_t rateRun;                // Variations rapides de suite
+};
+
+// Contrôle une valeur (RECORD_NO_VALUE si absente) et met l'état à jour
+QualityCode screenValue(const ScreenLimits& limits, ScreenState& state, int16_t centi, uint32_t time);
+
+inline QualityCode qualityCode(uint16_t quality, uint8_t channel) {
+    return (QualityCode)((quality >> (4 * channel)) & 0x0F);
+}
+
+inline uint16_t withQuality(uint16_t quality, uint8_t channel, QualityCode code) {
+    return (uint16_t)((quality & ~(0x0F << (4 * channel))) | (code << (4 * channel)));
+}
+
+// Valeur utilisable dans un agrégat
+inline bool qualityUsable(uint16_t quality, uint8_t channel) {
+    return qualityCode(quality, channel) == QUALITY_OK;
+}
+
+// Remplace le '\n' final d'une ligne CSV de length octets par "--S;\n".
+// Retourne la nouvelle longueur (0 si out est trop petit).
+size_t appendQualityColumn(char* row, size_t length, size_t maxLen, uint16_t quality, uint8_t channels);
+
+// Colonne qualité d'une ligne CSV, après la date et `channels` valeurs
+// (QUALITY_UNKNOWN si elle est absente, incomplète ou porte un code inconnu)
+uint16_t parseQualityColumn(const char* line, uint8_t channels);
+
+#endif
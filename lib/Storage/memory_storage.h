@@ -0,0 +1,180 @@
+#ifndef MEMORY_STORAGE_H
+#define MEMORY_STORAGE_H
+
+#include <string.h>
+#include "storage.h"
+
+// ==========================================
+// BACKEND EN MÉMOIRE (tests sur PC, sans carte SD)
+// ==========================================
+// Fichiers de taille bornée dans des tableaux statiques ; les dossiers
+// n'existent que par mkdir(). Comme sur la carte SD, rename() échoue si la
+// cible existe. failWrites simule une carte pleine. Aucune dépendance
+// Arduino.
+class MemoryStorage : public Storage {
+public:
+    static const int MAX_FILES = 24;
+    static const int MAX_DIRS = 8;
+    static const int PATH_MAX = 40;
+    static const uint32_t FILE_CAPACITY = 32768;
+
+    bool failWrites = false;
+
+    void reset() {
+        memset(files, 0, sizeof(files));
+        memset(dirs, 0, sizeof(dirs));
+        failWrites = false;
+    }
+
+    StorageFile open(const char* path, StorageMode mode) override {
+        Entry* entry = find(path);
+        if (mode == STORAGE_READ) return entry;
+        if (entry == nullptr) {
+            if (!parentExists(path)) return nullptr;
+            entry = create(path);
+            if (entry == nullptr) return nullptr;
+        }
+        if (mode == STORAGE_WRITE) entry->size = 0;
+        return entry;
+    }
+
+    void close(StorageFile file) override {
+        (void)file;
+    }
+
+    uint32_t size(StorageFile file) override {
+        return ((Entry*)file)->size;
+    }
+
+    size_t read(StorageFile file, uint32_t offset, uint8_t* buffer, size_t length) override {
+        Entry* entry = (Entry*)file;
+        if (offset >= entry->size) return 0;
+        if (length > entry->size - offset) length = entry->size - offset;
+        memcpy(buffer, entry->data + offset, length);
+        return length;
+    }
+
+    size_t write(StorageFile file, const uint8_t* data, size_t length) override {
+        Entry* entry = (Entry*)file;
+        if (failWrites) return 0;
+        if (length > FILE_CAPACITY - entry->size) length = FILE_CAPACITY - entry->size;
+        memcpy(entry->data + entry->size, data, length);
+        entry->size += length;
+        return length;
+    }
+
+    bool exists(const char* path) override {
+        return find(path) != nullptr || findDir(path) >= 0;
+    }
+
+    bool remove(const char* path) override {
+        Entry* entry = find(path);
+        if (entry == nullptr) return false;
+        entry->used = false;
+        return true;
+    }
+
+    bool rename(const char* from, const char* to) override {
+        Entry* entry = find(from);
+        if (entry == nullptr || find(to) != nullptr || strlen(to) >= PATH_MAX) return false;
+        strcpy(entry->path, to);
+        return true;
+    }
+
+    bool mkdir(const char* path) override {
+        if (findDir(path) >= 0) return true;
+        for (int i = 0; i < MAX_DIRS; i++) {
+            if (dirs[i][0] == '\0' && strlen(path) < PATH_MAX) {
+                strcpy(dirs[i], path);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool list(const char* dir, StorageVisitFn visit, void* context) override {
+        if (findDir(dir) < 0) return false;
+        size_t length = strlen(dir);
+        for (int i = 0; i < MAX_FILES; i++) {
+            const char* path = files[i].path;
+            if (files[i].used && strncmp(path, dir, length) == 0 && path[length] == '/' &&
+                strchr(path + length + 1, '/') == nullptr) {
+                visit(context, path + length + 1);
+            }
+        }
+        return true;
+    }
+
+    // ==========================================
+    // ACCÈS DIRECT (préparation et vérification des tests)
+    // ==========================================
+    bool put(const char* path, const char* text) {
+        StorageFile file = open(path, STORAGE_WRITE);
+        return file != nullptr && write(file, (const uint8_t*)text, strlen(text)) == strlen(text);
+    }
+
+    // Contenu d'un fichier texte terminé par '\0' (nullptr s'il est absent)
+    const char* text(const char* path) {
+        Entry* entry = find(path);
+        if (entry == nullptr || entry->size >= FILE_CAPACITY) return nullptr;
+        entry->data[entry->size] = '\0';
+        return (const char*)entry->data;
+    }
+
+    uint32_t fileSize(const char* path) {
+        Entry* entry = find(path);
+        return entry ? entry->size : 0;
+    }
+
+private:
+    struct Entry {
+        bool used;
+        char path[PATH_MAX];
+        uint32_t size;
+        uint8_t data[FILE_CAPACITY];
+    };
+
+    Entry* find(const char* path) {
+        for (int i = 0; i < MAX_FILES; i++) {
+            if (files[i].used && strcmp(files[i].path, path) == 0) return &files[i];
+        }
+        return nullptr;
+    }
+
+    int findDir(const char* path) {
+        for (int i = 0; i < MAX_DIRS; i++) {
+            if (dirs[i][0] != '\0' && strcmp(dirs[i], path) == 0) return i;
+        }
+        return -1;
+    }
+
+    // Fichiers à la racine, ou dans un dossier créé par mkdir()
+    bool parentExists(const char* path) {
+        const char* slash = strrchr(path, '/');
+        if (slash == nullptr || slash == path) return true;
+        char dir[PATH_MAX];
+        size_t length = slash - path;
+        if (length >= PATH_MAX) return false;
+        memcpy(dir, path, length);
+        dir[length] = '\0';
+        return findDir(dir) >= 0;
+    }
+
+    Entry* create(const char* path) {
+        if (strlen(path) >= PATH_MAX) return nullptr;
+        for (int i = 0; i < MAX_FILES; i++) {
+            if (!files[i].used) {
+                files[i].used = true;
+                strcpy(files[i].path, path);
+                files[i].size = 0;
+                return &files[i];
+            }
+        }
+        return nullptr;
+    }
+
+    Entry files[MAX_FILES];
+    char dirs[MAX_DIRS][PATH_MAX];
+};
+
+#endif
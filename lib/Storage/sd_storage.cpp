@@ -0,0 +1,77 @@
+#if defined(ESP_PLATFORM)
+
+#include "sd_storage.h"
+#include <SD.h>
+#include <string.h>
+
+// ==========================================
+// FICHIERS
+// ==========================================
+StorageFile SdStorage::open(const char* path, StorageMode mode) {
+    const char* sdMode = mode == STORAGE_READ ? FILE_READ : mode == STORAGE_WRITE ? FILE_WRITE : FILE_APPEND;
+    File file = SD.open(path, sdMode);
+    if (!file) return nullptr;
+    return new File(file);
+}
+
+void SdStorage::close(StorageFile file) {
+    File* sdFile = (File*)file;
+    sdFile->close();
+    delete sdFile;
+}
+
+uint32_t SdStorage::size(StorageFile file) {
+    return ((File*)file)->size();
+}
+
+size_t SdStorage::read(StorageFile file, uint32_t offset, uint8_t* buffer, size_t length) {
+    File* sdFile = (File*)file;
+    if (sdFile->position() != offset && !sdFile->seek(offset)) return 0;
+    return sdFile->read(buffer, length);
+}
+
+size_t SdStorage::write(StorageFile file, const uint8_t* data, size_t length) {
+    return ((File*)file)->write(data, length);
+}
+
+// ==========================================
+// DOSSIERS
+// ==========================================
+bool SdStorage::exists(const char* path) {
+    return SD.exists(path);
+}
+
+bool SdStorage::remove(const char* path) {
+    return SD.remove(path);
+}
+
+bool SdStorage::rename(const char* from, const char* to) {
+    return SD.rename(from, to);
+}
+
+bool SdStorage::mkdir(const char* path) {
+    return SD.mkdir(path);
+}
+
+bool SdStorage::list(const char* dir, StorageVisitFn visit, void* context) {
+    File root = SD.open(dir);
+    if (!root) return false;
+    if (!root.isDirectory()) {
+        root.close();
+        return false;
+    }
+
+    File file = root.openNextFile();
+    while (file) {
+        // Selon la version du core, name() inclut ou non le dossier
+        const char* name = file.name();
+        const char* slash = strrchr(name, '/');
+        visit(context, slash ? slash + 1 : name);
+        file.close();
+        file = root.openNextFile();
+    }
+    root.close();
+    return true;
+}
+
+#endif
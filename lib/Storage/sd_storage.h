@@ -0,0 +1,25 @@
+#ifndef SD_STORAGE_H
+#define SD_STORAGE_H
+
+#include "storage.h"
+
+// ==========================================
+// BACKEND CARTE SD (carte maître)
+// ==========================================
+// Un StorageFile est un File alloué à l'ouverture et libéré par close().
+// La carte doit déjà être montée (SD.begin).
+class SdStorage : public Storage {
+public:
+    StorageFile open(const char* path, StorageMode mode) override;
+    void close(StorageFile file) override;
+    uint32_t size(StorageFile file) override;
+    size_t read(StorageFile file, uint32_t offset, uint8_t* buffer, size_t length) override;
+    size_t write(StorageFile file, const uint8_t* data, size_t length) override;
+    bool exists(const char* path) override;
+    bool remove(const char* path) override;
+    bool rename(const char* from, const char* to) override;
+    bool mkdir(const char* path) override;
+    bool list(const char* dir, StorageVisitFn visit, void* context) override;
+};
+
+#endif
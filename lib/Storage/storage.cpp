@@ -0,0 +1,14 @@
+#include "storage.h"
+
+size_t storageReadBlock(void* context, uint32_t offset, uint8_t* buffer, size_t length) {
+    StorageBlockFile* file = (StorageBlockFile*)context;
+    return file->storage->read(file->file, offset, buffer, length);
+}
+
+bool storageAppend(Storage& storage, const char* path, const uint8_t* data, size_t length) {
+    StorageFile file = storage.open(path, STORAGE_APPEND);
+    if (file == nullptr) return false;
+    bool ok = storage.write(file, data, length) == length;
+    storage.close(file);
+    return ok;
+}
@@ -0,0 +1,63 @@
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ==========================================
+// ACCÈS AUX FICHIERS (compaction, rétention, export)
+// ==========================================
+// Les travaux sur les fichiers de la carte SD (lib/Gorilla, lib/Retention,
+// lib/Export) ne connaissent que cette interface. Backends : carte SD
+// (sd_storage.h, sur la carte) et fichiers en mémoire pour les tests sur PC
+// (memory_storage.h). Chemins absolus ("/apport/r202601.gor").
+
+typedef void* StorageFile;              // nullptr : fichier absent ou erreur
+
+enum StorageMode : uint8_t {
+    STORAGE_READ,
+    STORAGE_WRITE,                      // Créé ou vidé
+    STORAGE_APPEND                      // Créé si absent, écriture à la fin
+};
+
+// Horloge des budgets de temps (millis() sur la carte)
+typedef uint32_t (*StorageClock)();
+
+// Appelé pour chaque fichier d'un dossier (nom sans le dossier)
+typedef void (*StorageVisitFn)(void* context, const char* name);
+
+class Storage {
+public:
+    virtual ~Storage() {}
+
+    virtual StorageFile open(const char* path, StorageMode mode) = 0;
+    virtual void close(StorageFile file) = 0;
+    virtual uint32_t size(StorageFile file) = 0;
+
+    // Lit jusqu'à length octets à offset ; retourne le nombre lu
+    virtual size_t read(StorageFile file, uint32_t offset, uint8_t* buffer, size_t length) = 0;
+
+    // Écrit à la fin du fichier ; retourne le nombre écrit
+    virtual size_t write(StorageFile file, const uint8_t* data, size_t length) = 0;
+
+    virtual bool exists(const char* path) = 0;
+    virtual bool remove(const char* path) = 0;
+    virtual bool rename(const char* from, const char* to) = 0;
+    virtual bool mkdir(const char* path) = 0;
+
+    // false si le dossier n'existe pas
+    virtual bool list(const char* dir, StorageVisitFn visit, void* context) = 0;
+};
+
+// Fichier ouvert lu par BlockReader (context de storageReadBlock)
+struct StorageBlockFile {
+    Storage* storage;
+    StorageFile file;
+};
+
+size_t storageReadBlock(void* context, uint32_t offset, uint8_t* buffer, size_t length);
+
+// Ajoute data à la fin de path (créé si absent) ; false en cas d'erreur
+bool storageAppend(Storage& storage, const char* path, const uint8_t* data, size_t length);
+
+#endif
@@ -0,0 +1,178 @@
+#if defined(ESP_PLATFORM)
+
+#include "espnow_transport.h"
+#include "config.h"
+#include <WiFi.h>
+#include <esp_wifi.h>
+#include <string.h>
+
+#define ESPNOW_RX_QUEUE_DEPTH 8
+
+static const uint8_t BROADCAST_ADDRESS[ESP_NOW_ETH_ALEN] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+QueueHandle_t EspNowTransport::rxQueue = nullptr;
+
+EspNowTransport::EspNowTransport(uint8_t channel, uint32_t ackTimeoutMs, uint8_t maxAttempts)
+    : channel(channel), ackTimeoutMs(ackTimeoutMs), maxAttempts(maxAttempts) {
+    memcpy(peerAddress, BROADCAST_ADDRESS, ESP_NOW_ETH_ALEN);
+}
+
+// ==========================================
+// INITIALISATION
+// ==========================================
+bool EspNowTransport::begin() {
+    WiFi.mode(WIFI_STA);
+    esp_wifi_set_channel(channel, WIFI_SECOND_CHAN_NONE);
+    
+    if (esp_now_init() != ESP_OK) {
+        DEBUG_PRINTLN("[ESPNOW] Init failed");
+        return false;
+    }
+    
+    if (rxQueue == nullptr) {
+        rxQueue = xQueueCreate(ESPNOW_RX_QUEUE_DEPTH, sizeof(Frame));
+    }
+    xQueueReset(rxQueue);
+    esp_now_register_recv_cb(onReceive);
+    
+    DEBUG_PRINT("[ESPNOW] Ready on channel ");
+    DEBUG_PRINTLN(channel);
+    return true;
+}
+
+void EspNowTransport::end() {
+    esp_now_unregister_recv_cb();
+    esp_now_deinit();
+    WiFi.mode(WIFI_OFF);
+}
+
+void EspNowTransport::setPeer(const uint8_t* mac) {
+    memcpy(peerAddress, mac, ESP_NOW_ETH_ALEN);
+}
+
+// Contexte de la tâche WiFi : simple copie dans la file
+void EspNowTransport::onReceive(const uint8_t* mac, const uint8_t* data, int length) {
+    if (length <= 0 || length > TRANSPORT_FRAME_MAX_BYTES) {
+        return;
+    }
+    
+    Frame frame;
+    memcpy(frame.mac, mac, ESP_NOW_ETH_ALEN);
+    memcpy(frame.data, data, length);
+    frame.length = length;
+    xQueueSend(rxQueue, &frame, 0);
+}
+
+bool EspNowTransport::ensurePeer(const uint8_t* mac) {
+    if (esp_now_is_peer_exist(mac)) {
+        return true;
+    }
+    
+    esp_now_peer_info_t info = {};
+    memcpy(info.peer_addr, mac, ESP_NOW_ETH_ALEN);
+    info.channel = 0;           // Canal courant
+    info.ifidx = WIFI_IF_STA;
+    info.encrypt = false;
+    return esp_now_add_peer(&info) == ESP_OK;
+}
+
+// ==========================================
+// MAÎTRE : RÉCEPTION ET ACQUITTEMENT DES LOTS
+// ==========================================
+int EspNowTransport::acquire(uint32_t deadlineMs, int expected, BatchHandler handler, void* context) {
+    uint32_t boards = 0;
+    Frame frame;
+    
+    while (countBoards(boards) < expected) {
+        int32_t remaining = (int32_t)(deadlineMs - millis());
+        if (remaining <= 0 || xQueueReceive(rxQueue, &frame, pdMS_TO_TICKS(remaining)) != pdTRUE) {
+            break;
+        }
+        
+        if (frame.data[0] != TRANSPORT_FRAME_BATCH) {
+            continue;
+        }
+        
+        // Un lot répété (acquittement perdu) est de nouveau accepté et acquitté,
+        // les doublons sont éliminés par le handler
+        SlaveBatchHeader header;
+        const SlaveRecord* records;
+        if (!dispatchUpload(frame.data + 1, frame.length - 1, handler, context,
+                            &header, &records, &boards)) {
+            DEBUG_PRINTLN("[ESPNOW] Batch rejected");
+            continue;
+        }
+        
+        TransportAck ack = makeAck(header, records, schedule);
+        if (ensurePeer(frame.mac)) {
+            esp_now_send(frame.mac, (const uint8_t*)&ack, sizeof(ack));
+        }
+        
+        DEBUG_PRINT("[ESPNOW] Batch from board ");
+        DEBUG_PRINT(header.boardId);
+        DEBUG_PRINT(", records: ");
+        DEBUG_PRINTLN(header.count);
+    }
+    
+    return countBoards(boards);
+}
+
+// ==========================================
+// ESCLAVE : ENVOI AVEC ACQUITTEMENT ET RETRIES
+// ==========================================
+bool EspNowTransport::deliver(const uint8_t* batch, size_t length, TransportAck* ack) {
+    SlaveBatchHeader header;
+    const SlaveRecord* records;
+    if (length + 1 > TRANSPORT_FRAME_MAX_BYTES || !parseBatch(batch, length, &header, &records)) {
+        DEBUG_PRINTLN("[ESPNOW] Batch does not fit in a frame");
+        return false;
+    }
+    uint16_t lastSeq = header.count > 0 ? records[header.count - 1].seq : 0;
+    
+    uint8_t out[TRANSPORT_FRAME_MAX_BYTES];
+    out[0] = TRANSPORT_FRAME_BATCH;
+    memcpy(out + 1, batch, length);
+    
+    if (!ensurePeer(peerAddress)) {
+        return false;
+    }
+    
+    for (int attempt = 0; attempt < maxAttempts; attempt++) {
+        esp_now_send(peerAddress, out, length + 1);
+        
+        // Attendre l'acquittement de ce lot (les autres trames sont ignorées)
+        uint32_t deadline = millis() + ackTimeoutMs;
+        Frame frame;
+        int32_t remaining;
+        while ((remaining = (int32_t)(deadline - millis())) > 0 &&
+               xQueueReceive(rxQueue, &frame, pdMS_TO_TICKS(remaining)) == pdTRUE) {
+            if (frame.length < sizeof(TransportAck) || frame.data[0] != TRANSPORT_FRAME_ACK) {
+                continue;
+            }
+            
+            TransportAck reply;
+            memcpy(&reply, frame.data, sizeof(reply));
+            if (reply.boardId != header.boardId || reply.lastSeq != lastSeq) {
+                continue;
+            }
+            
+            // Adresse du maître apprise pour les prochains envois (unicast)
+            setPeer(frame.mac);
+            if (ack != nullptr) {
+                *ack = reply;
+            }
+            return true;
+        }
+        
+        // Backoff exponentiel avec gigue : désynchronise les esclaves en collision
+        if (attempt + 1 < maxAttempts) {
+            uint32_t backoff = (ackTimeoutMs << attempt) + esp_random() % ackTimeoutMs;
+            vTaskDelay(pdMS_TO_TICKS(backoff));
+        }
+    }
+    
+    DEBUG_PRINTLN("[ESPNOW] No acknowledgement, batch kept for next wake");
+    return false;
+}
+
+#endif // ESP_PLATFORM
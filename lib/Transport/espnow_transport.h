@@ -0,0 +1,49 @@
+#ifndef ESPNOW_TRANSPORT_H
+#define ESPNOW_TRANSPORT_H
+
+#include <Arduino.h>
+#include <esp_now.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include "transport.h"
+
+// ==========================================
+// BACKEND ESP-NOW (sans connexion)
+// ==========================================
+// L'esclave envoie son lot dans une seule trame (TRANSPORT_FRAME_MAX_RECORDS
+// mesures au plus) et attend un TransportAck ; sans réponse il réémet avec un
+// délai exponentiel aléatoire. Le premier envoi part en broadcast, l'adresse
+// du maître est ensuite apprise de l'acquittement (à conserver en RTC).
+// Le maître écoute pendant la fenêtre d'acquisition et acquitte chaque lot.
+class EspNowTransport : public SlaveTransport {
+public:
+    EspNowTransport(uint8_t channel, uint32_t ackTimeoutMs, uint8_t maxAttempts);
+    
+    const char* name() const override { return "ESP-NOW"; }
+    bool begin() override;
+    void end() override;
+    int acquire(uint32_t deadlineMs, int expected, BatchHandler handler, void* context) override;
+    bool deliver(const uint8_t* batch, size_t length, TransportAck* ack) override;
+    
+    // Adresse du pair (maître côté esclave), broadcast par défaut
+    void setPeer(const uint8_t* mac);
+    const uint8_t* peer() const { return peerAddress; }
+    
+private:
+    struct Frame {
+        uint8_t mac[ESP_NOW_ETH_ALEN];
+        uint8_t length;
+        uint8_t data[TRANSPORT_FRAME_MAX_BYTES];
+    };
+    
+    static void onReceive(const uint8_t* mac, const uint8_t* data, int length);
+    static bool ensurePeer(const uint8_t* mac);
+    static QueueHandle_t rxQueue;
+    
+    uint8_t channel;
+    uint32_t ackTimeoutMs;
+    uint8_t maxAttempts;
+    uint8_t peerAddress[ESP_NOW_ETH_ALEN];
+};
+
+#endif // ESPNOW_TRANSPORT_H
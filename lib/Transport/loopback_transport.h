@@ -0,0 +1,100 @@
+#ifndef LOOPBACK_TRANSPORT_H
+#define LOOPBACK_TRANSPORT_H
+
+#include <string.h>
+#include "transport.h"
+
+// ==========================================
+// BACKEND LOOPBACK (tests sur PC, sans radio)
+// ==========================================
+// Esclave et maître partagent le même objet : deliver() met le lot en file,
+// acquire() vide la file dans l'ordre d'arrivée et mémorise l'acquittement de
+// chaque carte, que l'esclave simulé récupère avec takeAck(). Aucune
+// dépendance Arduino.
+class LoopbackTransport : public SlaveTransport {
+public:
+    static const int CAPACITY = 8;
+    static const int MAX_BOARDS = 32;
+    
+    const char* name() const override { return "loopback"; }
+    
+    bool begin() override {
+        head = 0;
+        queued = 0;
+        dropNext = 0;
+        memset(ackReady, 0, sizeof(ackReady));
+        return true;
+    }
+    
+    int acquire(uint32_t deadlineMs, int expected, BatchHandler handler, void* context) override {
+        (void)deadlineMs;
+        uint32_t boards = 0;
+        
+        while (queued > 0 && countBoards(boards) < expected) {
+            Frame& frame = frames[head];
+            head = (head + 1) % CAPACITY;
+            queued--;
+            
+            SlaveBatchHeader header;
+            const SlaveRecord* records;
+            if (!dispatchUpload(frame.data, frame.length, handler, context, &header, &records, &boards) ||
+                header.boardId >= MAX_BOARDS) {
+                continue;
+            }
+            
+            acks[header.boardId] = makeAck(header, records, schedule);
+            ackReady[header.boardId] = true;
+        }
+        return countBoards(boards);
+    }
+    
+    bool deliver(const uint8_t* batch, size_t length, TransportAck* ack) override {
+        if (dropNext > 0) {
+            dropNext--;
+            return false;
+        }
+        if (queued >= CAPACITY || length > RECORD_BATCH_MAX_BYTES) {
+            return false;
+        }
+        
+        Frame& frame = frames[(head + queued) % CAPACITY];
+        memcpy(frame.data, batch, length);
+        frame.length = length;
+        queued++;
+        
+        if (ack != nullptr && length >= sizeof(SlaveBatchHeader)) {
+            takeAck(((const SlaveBatchHeader*)batch)->boardId, ack);
+        }
+        return true;
+    }
+    
+    // Acquittement en attente pour une carte (consommé à la lecture)
+    bool takeAck(uint8_t boardId, TransportAck* ack) {
+        if (boardId >= MAX_BOARDS || !ackReady[boardId]) {
+            return false;
+        }
+        *ack = acks[boardId];
+        ackReady[boardId] = false;
+        return true;
+    }
+    
+    // Perte simulée : les n prochains envois échouent
+    void dropNextDeliveries(int n) { dropNext = n; }
+    
+    int pending() const { return queued; }
+    
+private:
+    struct Frame {
+        uint8_t data[RECORD_BATCH_MAX_BYTES];
+        size_t length;
+    };
+    
+    Frame frames[CAPACITY];
+    int head = 0;
+    int queued = 0;
+    int dropNext = 0;
+    TransportAck acks[MAX_BOARDS];
+    bool ackReady[MAX_BOARDS] = {};
+};
+
+#endif // LOOPBACK_TRANSPORT_H
@@ -0,0 +1,145 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "records.h"
+#include "config.h"
+
+// ==========================================
+// TRANSPORT ESCLAVES -> MAÎTRE
+// ==========================================
+// L'étape d'acquisition du maître ne connaît que cette interface. Chaque
+// backend livre les lots reçus (SlaveBatchHeader + SlaveRecord[]) au
+// BatchHandler, qui les enregistre ; le backend acquitte les lots acceptés.
+// Backends : BLE GATT (src/main.cpp), ESP-NOW (espnow_transport.h) et
+// loopback en mémoire pour les tests sur PC (loopback_transport.h).
+
+#define TRANSPORT_FRAME_BATCH 0x01      // Esclave -> maître : [type][lot]
+#define TRANSPORT_FRAME_ACK   0x02      // Maître -> esclave : TransportAck
+
+// Taille max d'une trame (charge utile ESP-NOW)
+#define TRANSPORT_FRAME_MAX_BYTES 250
+#define TRANSPORT_FRAME_MAX_RECORDS \
+    ((TRANSPORT_FRAME_MAX_BYTES - 1 - sizeof(SlaveBatchHeader)) / sizeof(SlaveRecord))
+
+// Acquittement d'un lot, avec les consignes du maître pour le prochain cycle
+struct __attribute__((packed)) TransportAck {
+    uint8_t type;               // TRANSPORT_FRAME_ACK
+    uint8_t boardId;
+    uint16_t lastSeq;           // Dernière séquence enregistrée (ReadingBuffer::acknowledge)
+    uint16_t sleepMinutes;      // Consigne brute (sleep_min), ajustée par le slave à sa batterie
+    uint16_t advertiseSeconds;
+};
+
+// Consignes recopiées dans chaque acquittement
+struct SlaveSchedule {
+    uint16_t sleepMinutes;
+    uint16_t advertiseSeconds;
+};
+
+// Retourne true si le lot est pris en charge : enregistré, ou ignoré
+// volontairement (boucle de relais...). false : rien ne doit être acquitté,
+// l'émetteur renverra le lot (tampon plein...).
+typedef bool (*BatchHandler)(const SlaveBatchHeader& header, const SlaveRecord* records, void* context);
+
+class SlaveTransport {
+public:
+    virtual ~SlaveTransport() {}
+    
+    virtual const char* name() const = 0;
+    virtual bool begin() = 0;
+    virtual void end() {}
+    
+    // Vrai si le maître doit scanner avant d'acquérir (BLE)
+    virtual bool needsDiscovery() const { return false; }
+    
+    // Maître : reçoit les lots jusqu'à deadlineMs (horloge millis()) ou
+    // jusqu'à `expected` cartes distinctes. Retourne le nombre de cartes reçues.
+    virtual int acquire(uint32_t deadlineMs, int expected, BatchHandler handler, void* context) = 0;
+    
+    // Esclave : envoie un lot sérialisé par ReadingBuffer::serialize().
+    // Retourne true une fois le lot pris en charge ; ack est rempli si le
+    // maître a déjà répondu (ESP-NOW : toujours, après les retries).
+    virtual bool deliver(const uint8_t* batch, size_t length, TransportAck* ack) {
+        (void)batch; (void)length; (void)ack;
+        return false;
+    }
+    
+    void setSchedule(const SlaveSchedule& value) { schedule = value; }
+    
+protected:
+    SlaveSchedule schedule = {SLEEP_TIME_MINUTES, BLE_ADVERTISE_TIME};     // Sans setSchedule() (relais)
+};
+
+// Validation d'un lot brut, commune à tous les backends
+inline bool parseBatch(const uint8_t* data, size_t length,
+                       SlaveBatchHeader* header, const SlaveRecord** records) {
+    if (length < sizeof(SlaveBatchHeader)) {
+        return false;
+    }
+    
+    const SlaveBatchHeader* raw = (const SlaveBatchHeader*)data;
+    size_t available = (length - sizeof(SlaveBatchHeader)) / sizeof(SlaveRecord);
+    if (raw->version != RECORD_FORMAT_VERSION || raw->count > available ||
+        raw->count > RECORD_BATCH_MAX_COUNT) {
+        return false;
+    }
+    
+    *header = *raw;
+    *records = (const SlaveRecord*)(data + sizeof(SlaveBatchHeader));
+    return true;
+}
+
+// Un envoi = lot de l'émetteur suivi éventuellement des lots relayés.
+// Chaque lot valide est passé au handler ; les cartes acceptées sont ajoutées
+// au masque `boards` (bit = boardId). Retourne true si le lot de l'émetteur
+// et tous les lots relayés sont acceptés : seul le lot de l'émetteur est
+// acquitté (sender / senderRecords), mais le relais libère alors aussi les
+// lots relayés.
+inline bool dispatchUpload(const uint8_t* data, size_t length, BatchHandler handler, void* context,
+                           SlaveBatchHeader* sender, const SlaveRecord** senderRecords,
+                           uint32_t* boards) {
+    if (!parseBatch(data, length, sender, senderRecords) || sender->hops != 0) {
+        return false;
+    }
+    if (!handler(*sender, *senderRecords, context)) {
+        return false;
+    }
+    if (sender->boardId < 32) *boards |= 1UL << sender->boardId;
+    
+    bool complete = true;
+    size_t offset = sizeof(SlaveBatchHeader) + sender->count * sizeof(SlaveRecord);
+    SlaveBatchHeader header;
+    const SlaveRecord* records;
+    while (parseBatch(data + offset, length - offset, &header, &records) && header.hops > 0) {
+        if (!handler(header, records, context)) {
+            complete = false;
+        } else if (header.boardId < 32) {
+            *boards |= 1UL << header.boardId;
+        }
+        offset += sizeof(SlaveBatchHeader) + header.count * sizeof(SlaveRecord);
+    }
+    return complete;
+}
+
+// Nombre de cartes dans un masque de dispatchUpload()
+inline int countBoards(uint32_t boards) {
+    int n = 0;
+    for (; boards; boards &= boards - 1) n++;
+    return n;
+}
+
+// Acquittement d'un lot accepté (dernier enregistrement = plus récent)
+inline TransportAck makeAck(const SlaveBatchHeader& header, const SlaveRecord* records,
+                            const SlaveSchedule& schedule) {
+    TransportAck ack;
+    ack.type = TRANSPORT_FRAME_ACK;
+    ack.boardId = header.boardId;
+    ack.lastSeq = header.count > 0 ? records[header.count - 1].seq : 0;
+    ack.sleepMinutes = schedule.sleepMinutes;
+    ack.advertiseSeconds = schedule.advertiseSeconds;
+    return ack;
+}
+
+#endif // TRANSPORT_H
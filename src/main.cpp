@@ -4,15 +4,43 @@
 // ==========================================
 #include <Arduino.h>
 #include <esp_sleep.h>
+#include <esp_pm.h>
+#include <esp_bt.h>
+#include <esp_task_wdt.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
 #include <BLEDevice.h>
 #include <BLEUtils.h>
-#include <BLEScan.h>
-#include <BLEAdvertisedDevice.h>
+#include <esp_gap_ble_api.h>
 #include <BLEServer.h>
 #include <BLE2902.h>
 #include <SD.h>
 #include <SPI.h>
+#include <Preferences.h>
 #include <config.h>
+#include <records.h>
+#include <format.h>
+#include <schedule.h>
+#include <power.h>
+#include <gorilla.h>
+#include <compaction.h>
+#include <retention.h>
+#include <rollup.h>
+#include <sd_storage.h>
+#include <export_frame.h>
+#include <export_session.h>
+#include <block_reader.h>
+#include <screening.h>
+#include <schema.h>
+#include <forecast.h>
+#include <transport.h>
+#include <metrics.h>
+#if SLAVE_TRANSPORT == TRANSPORT_ESPNOW
+#include <espnow_transport.h>
+#endif
 
 // TYPE DEFINITIONS ---------------------
 typedef enum {
@@ -29,40 +57,227 @@ typedef enum {
 #define MAX_TIMEOUT_COUNT 3
 #define MAX_SLAVES 3
 #define DATE_FILENAME "/datetime.txt"
+#define CPU_MAX_FREQ_MHZ 160          // Fréquence max (DFS) pendant les échanges radio
+#define CPU_MIN_FREQ_MHZ 80           // Fréquence min en attente (80 MHz minimum avec BLE actif)
 
-// Fichiers CSV pour chaque capteur
+#define DISCOVERY_SCAN_EVERY 48       // Scan ouvert (sans liste d'acceptation) tous les N cycles
+#define ACQUISITION_TASK_STACK 6144   // Pile d'une tâche d'acquisition
+// Budget, tentatives et timeouts de connexion : voir lib/Schedule/schedule.h
+#define RSSI_HISTORY 4                // Mesures de RSSI conservées par slave
+
+// Diagnostic mémoire
+#define MEM_HISTORY 16                // Cycles conservés en RTC (commande MEM)
+#define MEM_TASK_COUNT 6              // Tâches suivies (voir MEM_TASKS)
+#define METRICS_CHUNK 200             // Taille max d'une notification METRICS
+
+// Bilan énergétique (estimation, courants moyens mesurés au banc)
+#define SLEEP_CURRENT_MA 0.15f        // Deep sleep, carte SD comprise
+
+// Compaction des mesures anciennes en blocs compressés (âges : lib/Gorilla/compaction.h)
+#define COMPACT_BUDGET_MS 1500        // Temps max par cycle, en fin de PROCESS_DATA
+
+// Export tramé vers Android (commande EXPORT, voir lib/Export)
+#define EXPORT_LOCAL_MTU 247          // MTU proposé : une trame de 244 octets par paquet radio (DLE)
+#define EXPORT_BURST 8                // Trames par passage dans WAIT_ANDROID
+#define EXPORT_FRAME_GAP_MS 15        // Pause entre deux notifications
+#define COMMAND_QUEUE_LEN 4           // Commandes Android en attente de traitement
+
+// Prévision dans la réponse de scan (données constructeur, voir sendForecastAdvert)
+#define FORECAST_COMPANY_ID 0xFFFF    // Identifiant réservé aux tests / usage interne
+#define FORECAST_ADV_VERSION 1
+#define FORECAST_HOURS_NONE 0xFFFF    // Pas de passage sous le seuil prévu
+#define FORECAST_HOURS_UNKNOWN 0xFFFE // Pas encore assez de mesures, ou pas de seuil
+
+// Budget de temps par cycle (pire cas pour le dimensionnement de la batterie)
+#define TIME_BUDGET_MS 3000
+#define SCAN_BUDGET_MS ((effectiveScanSeconds() + 2) * 1000UL)
+#define PROCESS_BUDGET_MS 5000
+// Un export remet les timeouts à zéro : la fenêtre s'allonge de la durée des
+// transferts. Au-delà, l'état est interrompu et l'export reprend (EXPORT resume)
+// à la fenêtre suivante.
+#define ANDROID_TRANSFER_FRAMES 20000UL  // Trames par réveil, une par EXPORT_FRAME_GAP_MS (~4,6 Mo)
+#define ANDROID_TRANSFER_BUDGET_MS (ANDROID_TRANSFER_FRAMES * EXPORT_FRAME_GAP_MS)
+#define ANDROID_BUDGET_MS (runtimeConfig.maxTimeouts * runtimeConfig.androidWaitSeconds * 1000UL + \
+                           ANDROID_TRANSFER_BUDGET_MS)
+#define SLEEP_BUDGET_MS 2000
+#define CYCLE_BUDGET_MS (TIME_BUDGET_MS + SCAN_BUDGET_MS + ACQUISITION_BUDGET_MS + \
+                         PROCESS_BUDGET_MS + ANDROID_BUDGET_MS + SLEEP_BUDGET_MS)
+#define WATCHDOG_MARGIN_S 15          // Le watchdog redémarre la carte si le budget est dépassé de cette marge
+#define BUDGET_MAGIC 0xB0D6E7C2
+#define CONFIG_MAGIC 0xC0F16001
+#define PENDING_MAGIC 0xBA7C0A1D
+#define CONFIG_NAMESPACE "compost"    // Espace NVS de la configuration
+#define COMMAND_MAX_LEN 64
+
+// Nombre max de connexions du contrôleur BLE
+#ifdef CONFIG_BTDM_CTRL_BLE_MAX_CONN
+  #define BLE_MAX_CONNECTIONS CONFIG_BTDM_CTRL_BLE_MAX_CONN
+#else
+  #define BLE_MAX_CONNECTIONS 3
+#endif
+
+// Bits d'événements BLE (callbacks -> loop)
+#define EVT_SCAN_DONE    (1 << 0)     // Fin du scan (durée écoulée ou tous les slaves trouvés)
+#define EVT_ANDROID_CMD  (1 << 1)     // Commande Android reçue sur RX
+
+// Fichiers CSV (ceux des esclaves sont dans BOARD_SPECS, lib/Schema)
 const char* MASTER_FILE = "/master.csv";
-const char* APPORT_FILE = "/apport.csv";
-const char* MATURATION_FILE = "/maturation.csv";
-const char* EXTERIEUR_FILE = "/exterieur.csv";
+const char* DIAG_FILE = "/diag.csv";
+const char* POWER_FILE = "/power.csv";      // Tension batterie par carte et par cycle
+const char* ENERGY_FILE = "/energy.csv";    // Bilan énergétique par jour
+const char* EXPORT_FILE = "/export.bin";    // Flux du transfert EXPORT en cours
+
+// Courant moyen de chaque état du cycle (mA), dans l'ordre de MasterState
+const float STATE_CURRENT_MA[BROKEN_LINK + 1] = {45.0f, 100.0f, 110.0f, 70.0f, 60.0f, 45.0f, 45.0f};
+
+// Contrôle des mesures par carte et par champ (T, H, O2), en centièmes :
+// min, max, variation maximale par heure, valeurs identiques tolérées
+const ScreenLimits SCREEN_LIMITS[MAX_SLAVES][FIELD_COUNT] = {
+    {{-1000, 8500, 500, 12}, {0, 10000, 3000, 48}, {0, 2500, 1000, 24}},    // Apport
+    {{-1000, 8500, 500, 12}, {0, 10000, 3000, 48}, {0, 0, 0, 0}},           // Maturation
+    {{-3000, 5000, 1000, 12}, {0, 10000, 4000, 48}, {0, 0, 0, 0}}           // Extérieur
+};
+
+// Tâches dont la marge de pile est suivie ("acquire" : tâches d'acquisition BLE)
+const char* MEM_TASKS[MEM_TASK_COUNT] = {"loopTask", "acquire", "BTC_TASK", "BTU_TASK", "btController", "esp_timer"};
 
 // ==========================================
 // STRUCTURES DE DONNÉES
 // ==========================================
 struct SlaveData {
     uint8_t boardId;
-    float temperature;
-    float pressure;
-    float humidity;
-    float oxygen;
+    float values[FIELD_COUNT];  // indexé par SensorField, NAN si absent
+    uint16_t batteryMv;  // 0 = non mesurée
     bool received;
     char isoTime[20];  // Format: "YYYY-MM-DDTHH:MM:SS"
 };
 
-struct DateTime {
-    int year;
-    int month;
-    int day;
-    int hour;
-    int minute;
-    int second;
+// Slave repéré pendant le scan
+struct FoundSlave {
+    esp_bd_addr_t address;
+    esp_ble_addr_type_t addressType;
+    uint8_t boardId;
+    int8_t rssi;
+};
+
+// Slave déjà connecté lors d'un cycle précédent (liste d'acceptation du scanner)
+struct KnownSlave {
+    esp_bd_addr_t address;
+    esp_ble_addr_type_t addressType;
+    bool known;
+};
+
+// Qualité de lien par slave (persistant entre les cycles)
+struct SlaveLink {
+    int8_t rssiHistory[RSSI_HISTORY];
+    uint8_t rssiCount;
+    uint8_t rssiNext;
+    uint16_t connectMs;       // Latence moyenne de connexion (moyenne glissante)
+    uint8_t failureRate;      // Taux d'échec en % (moyenne glissante)
+    uint16_t attempts;
+    uint16_t failures;
+};
+
+// Lots reçus pendant le cycle. Ils sont acquittés dès leur réception : gardés
+// en RTC (non initialisée) jusqu'à leur écriture, ils survivent à un reset.
+struct PendingBatches {
+    uint32_t magic;
+    DateTime reference;             // Date du cycle de réception (datation des lots)
+    SlaveRecord records[MAX_SLAVES][RECORD_BATCH_MAX_COUNT];   // Aligné : values lu en int16_t
+    uint8_t count[MAX_SLAVES];
+};
+
+// Mesures dont l'écriture SD a été reportée au cycle suivant (budget dépassé,
+// écriture en échec ou cycle interrompu par un reset)
+struct DeferredFlush {
+    SlaveData data;                 // data.received = écriture en attente
+    DateTime reference;             // Date du cycle d'origine (datation du lot)
+    SlaveRecord batch[RECORD_BATCH_MAX_COUNT];  // Aligné : values lu en int16_t
+    uint8_t batchCount;
+};
+
+// Destination du flux d'export : notifications (READ) ou fichier (EXPORT)
+struct ExportSink {
+    File* spool = nullptr;
+    uint32_t bytes = 0;
+    uint8_t payload[EXPORT_FRAME_MAX];  // Notification en cours (lignes entières)
+    uint16_t length = 0;
+    uint16_t capacity = EXPORT_FRAME_MAX;
+    BlockReader* reader = nullptr;      // Fichier lu : bloc suivant chargé pendant les pauses
+};
+
+// Compteurs de dépassement (survivent aussi aux redémarrages du watchdog)
+struct BudgetCounters {
+    uint32_t magic;
+    uint32_t stateOverruns[BROKEN_LINK + 1];
+    uint32_t cycleOverruns;
+    uint32_t watchdogResets;
+    uint32_t deferredFlushes;
+    uint32_t skippedSleepSeconds;   // Sommeils après un reset du watchdog, pas encore datés
+};
+
+// Paramètres réglables sans reflasher (NVS), copiés en RTC au démarrage à froid
+struct RuntimeConfig {
+    uint32_t magic;
+    uint16_t sleepMinutes;          // SLEEP_TIME_MINUTES
+    uint16_t scanSeconds;           // BLE_SCAN_TIME
+    uint16_t advertiseSeconds;      // BLE_ADVERTISE_TIME (transmis aux esclaves)
+    uint16_t scanIntervalMs;        // BLE_SCAN_INTERVAL_MS
+    uint16_t scanWindowMs;          // BLE_SCAN_WINDOW_MS
+    uint16_t maxTimeouts;           // MAX_TIMEOUT_COUNT
+    uint16_t androidWaitSeconds;    // ANDROID_WAIT_TIMEOUT_S
+    uint16_t syncPeriodMinutes;     // ANDROID_SYNC_PERIOD_MINUTES
+    uint16_t keepRaw1;              // RETENTION_RAW_DAYS, carte 1
+    uint16_t keepRaw2;
+    uint16_t keepRaw3;
+    uint16_t keepHourly1;           // RETENTION_HOURLY_DAYS
+    uint16_t keepHourly2;
+    uint16_t keepHourly3;
+    uint16_t keepDaily1;            // RETENTION_DAILY_DAYS (0 = indéfiniment)
+    uint16_t keepDaily2;
+    uint16_t keepDaily3;
+    uint16_t turnTemp1;             // FORECAST_TURN_TEMP_C, carte 1 (0 = pas de prévision)
+    uint16_t turnTemp2;
+    uint16_t turnTemp3;
+};
+
+// Description d'un paramètre pour SET/GET (clé NVS <= 15 caractères)
+struct ConfigField {
+    const char* key;
+    uint16_t RuntimeConfig::* field;
+    uint16_t minValue;
+    uint16_t maxValue;
+    uint16_t defaultValue;
+};
+
+// Statistiques du dernier scan
+struct ScanStats {
+    uint32_t adverts;       // Rapports d'advertising reçus
+    uint32_t matched;       // Rapports correspondant à un slave
+    uint32_t unnamed;       // Slaves inconnus sans nom dans l'advert (scan passif)
+};
+
+// Mémoire en fin de cycle (le tas repart de zéro à chaque réveil de deep sleep)
+struct MemSample {
+    uint32_t cycle;
+    uint32_t minFreeHeap;       // Plus bas niveau de tas libre du cycle
+    uint32_t largestFreeBlock;  // Plus grand bloc libre (fragmentation)
+    uint32_t freeHeap;
+    uint32_t allocatedBlocks;   // Allocations vivantes
+    uint16_t stackFree[MEM_TASK_COUNT];  // Marge de pile minimale (octets, 0 = tâche absente)
+};
+
+struct MemHistory {
+    uint32_t cycles;
+    uint8_t next;
+    uint8_t count;
+    MemSample samples[MEM_HISTORY];
 };
 
 // ==========================================
 // VARIABLES GLOBALES
 // ==========================================
 SlaveData slavesData[MAX_SLAVES];  // Données des 3 esclaves
-BLEScan* pBLEScan = nullptr;
 BLEServer* pServer = nullptr;
 BLECharacteristic* pCharTX = nullptr;
 BLECharacteristic* pCharRX = nullptr;
@@ -70,38 +285,210 @@ BLECharacteristic* pCharRX = nullptr;
 bool androidConnected = false;
 bool dataRequested = false;
 bool clearRequested = false;
+QueueHandle_t commandQueue = nullptr;  // Commandes texte (SET/GET/ACK...) traitées dans WAIT_ANDROID
 bool allSlavesScanned = false;
-BLEAddress foundSlaves[MAX_SLAVES];  // Adresses des slaves trouvés
-String slaveNames[MAX_SLAVES];        // Noms des slaves trouvés
-int foundSlaveCount = 0;
-bool scanInProgress = false;
+FoundSlave foundSlaves[MAX_SLAVES];   // Slaves trouvés pendant le scan
+volatile int foundSlaveCount = 0;
+volatile bool scanInProgress = false;
+ScanStats scanStats;
+uint8_t sensorServiceUUID[ESP_UUID_LEN_128];  // SENSOR_SERVICE_UUID au format radio (little-endian)
+bool syncWindowOpen = false;          // Fenêtre Android en cours (advertising actif)
+EventGroupHandle_t bleEvents = nullptr;  // Réveil de loop() par les callbacks BLE
+SemaphoreHandle_t connectMutex = nullptr;     // Cycle de vie des BLEClient (un à la fois)
+SemaphoreHandle_t connectionSlots = nullptr;  // Connexions simultanées disponibles
+SemaphoreHandle_t acquisitionDone = nullptr;  // Donné par chaque tâche d'acquisition terminée
+SlaveTransport* slaveTransport = nullptr;     // Lien esclaves -> maître (SLAVE_TRANSPORT)
+SemaphoreHandle_t acquisitionMutex = nullptr; // Résultats des tâches d'acquisition (lots, slavesData, knownSlaves, linkTable)
+volatile bool acquisitionOpen = true;         // Écrit sous acquisitionMutex ; false : résultats tardifs ignorés
+BatchHandler batchSink = nullptr;             // Destination des lots lus par le backend BLE
+void* batchSinkContext = nullptr;
 
 DateTime currentDateTime;
 
+// Lots de mesures mémorisées par les slaves (store-and-forward)
+RTC_NOINIT_ATTR PendingBatches pendingBatches;
+uint16_t newestAge[MAX_SLAVES];       // Âge de la mesure affichée dans le résumé
+
 // PERSISTENT STATE ---------------------
 RTC_DATA_ATTR int TIMEOUT_COUNTER = 0;
 RTC_DATA_ATTR int64_t SLEEP_DURATION = SLEEP_TIME_US;
+RTC_DATA_ATTR RuntimeConfig runtimeConfig;
+RTC_DATA_ATTR SeqWindow seqWindows[MAX_SLAVES];  // Séquences déjà reçues par carte d'origine
+RTC_DATA_ATTR ScreenState screenStates[MAX_SLAVES][FIELD_COUNT];      // Dernière valeur retenue par champ
+RTC_DATA_ATTR HoltState forecasts[MAX_SLAVES];  // Tendance de la température par carte
+RTC_DATA_ATTR KnownSlave knownSlaves[MAX_SLAVES];
+RTC_DATA_ATTR uint32_t scanCycle = 0;
+RTC_DATA_ATTR SlaveLink linkTable[MAX_SLAVES];
+uint32_t acquisitionDeadline = 0;     // millis() limite pour les tentatives du cycle
+RTC_NOINIT_ATTR DeferredFlush deferredFlush[MAX_SLAVES];   // Validé par pendingBatches.magic
+RTC_NOINIT_ATTR BudgetCounters budgetCounters;
+RTC_DATA_ATTR MemHistory memHistory;
+RTC_DATA_ATTR MetricsStorage metricsStorage;   // Cumul des métriques sur tous les cycles
+RTC_DATA_ATTR BatteryState batteryState;
+RTC_DATA_ATTR EnergyLedger energyLedger;       // Journée en cours
+RTC_DATA_ATTR CompactionJob compaction;        // Compaction en cours (reprise au cycle suivant)
+RTC_DATA_ATTR uint8_t compactionNextBoard = 1;  // Tourniquet des cartes à compacter
+SdStorage sdStorage;                            // Fichiers des travaux de fond (lib/Storage)
+ArchiveScratch archiveScratch;      // Bloc et lecteur des archives (compaction, rétention, export)
+BlockReader exportReader;           // CSV ou fichier d'export envoyé (hors de la pile de loopTask)
+RTC_DATA_ATTR RetentionJob retention;
+RTC_DATA_ATTR ExportTransfer exportTransfer;
+ExportSession exportSession(exportTransfer, sdStorage, EXPORT_FILE);
+RTC_DATA_ATTR uint32_t retentionCheckedDay = 0; // AAAAMMJJ du dernier examen sans travail
+uint16_t batterySampleMv = 0;                  // Mesure du réveil courant (avant la radio)
+volatile uint16_t acquireStackFree = UINT16_MAX;  // Plus petite marge des tâches d'acquisition
+
+// MÉTRIQUES ----------------------------
+const float CONNECT_BUCKETS_MS[] = {100, 250, 500, 1000, 2000, 5000};
+const float CYCLE_BUCKETS_MS[] = {5000, 10000, 20000, 30000, 60000, 120000, 300000};
+
+Counter cyclesTotal("compost_cycles_total", "Cycles de réveil terminés");
+Counter cycleOverrunsTotal("compost_cycle_overruns_total", "Cycles écourtés par le budget de temps");
+Histogram cycleDuration("compost_cycle_duration_ms", "Temps éveillé par cycle", CYCLE_BUCKETS_MS, 7);
+Counter scansTotal("compost_scans_total", "Scans BLE lancés");
+Counter scanAdvertsTotal("compost_scan_adverts_total", "Annonces BLE reçues");
+Counter scanMatchedTotal("compost_scan_matched_total", "Annonces BLE venant des slaves");
+Counter connectionsTotal("compost_connections_total", "Tentatives de connexion aux slaves");
+Counter connectionFailuresTotal("compost_connection_failures_total", "Connexions aux slaves échouées");
+Histogram connectLatency("compost_connect_latency_ms", "Durée d'établissement d'une connexion slave", CONNECT_BUCKETS_MS, 6);
+Counter retriesTotal("compost_retries_total", "Nouvelles tentatives d'acquisition d'un slave");
+Counter recordsTotal("compost_records_total", "Mesures de slaves enregistrées");
+Counter duplicatesTotal("compost_duplicates_total", "Mesures de slaves en double ignorées");
+Counter tooOldTotal("compost_records_too_old_total", "Mesures de slaves antérieures à la fenêtre de dédoublonnage, ignorées");
+Counter screenRejectedTotal("compost_screen_rejected_total", "Valeurs hors plage ou absentes, écrites nan");
+Counter screenSuspectTotal("compost_screen_suspect_total", "Valeurs signalées (pointe ou capteur bloqué)");
+Gauge slavesReceived("compost_slaves_received", "Slaves entendus au dernier cycle");
+Counter sdBytesTotal("compost_sd_bytes_written_total", "Octets ajoutés sur la carte SD");
+Counter sdWriteErrorsTotal("compost_sd_write_errors_total", "Écritures SD échouées");
+Counter notificationsTotal("compost_notifications_total", "Notifications BLE envoyées à Android");
+Counter exportFramesTotal("compost_export_frames_total", "Trames d'export notifiées à Android");
+Counter exportRetransmitsTotal("compost_export_retransmits_total", "Trames d'export renvoyées après un NACK");
+Counter androidCommandsTotal("compost_android_commands_total", "Commandes reçues d'Android");
+Counter archivedRecordsTotal("compost_archived_records_total", "Mesures compactées dans les blocs d'archive");
+Counter retentionRollupsTotal("compost_retention_rollups_total", "Fichiers agrégés vers un niveau de rétention plus grossier");
+Counter archiveBytesTotal("compost_archive_bytes_total", "Octets compressés écrits dans les blocs d'archive");
+Gauge batteryMillivolts("compost_battery_millivolts", "Tension batterie filtrée du maître");
+Gauge powerModeGauge("compost_power_mode", "Mode de fonctionnement (0 normal, 1 eco, 2 critical, 3 survival)");
+
+// Schéma des paramètres réglables depuis Android
+const ConfigField CONFIG_SCHEMA[] = {
+    {"sleep_min",   &RuntimeConfig::sleepMinutes,       1,   720,   SLEEP_TIME_MINUTES},
+    {"scan_s",      &RuntimeConfig::scanSeconds,        1,   60,    BLE_SCAN_TIME},
+    {"adv_s",       &RuntimeConfig::advertiseSeconds,   1,   120,   BLE_ADVERTISE_TIME},
+    {"scan_int_ms", &RuntimeConfig::scanIntervalMs,     3,   10240, BLE_SCAN_INTERVAL_MS},
+    {"scan_win_ms", &RuntimeConfig::scanWindowMs,       3,   10240, BLE_SCAN_WINDOW_MS},
+    {"max_timeouts",&RuntimeConfig::maxTimeouts,        1,   20,    MAX_TIMEOUT_COUNT},
+    {"wait_s",      &RuntimeConfig::androidWaitSeconds, 5,   600,   ANDROID_WAIT_TIMEOUT_S},
+    {"sync_min",    &RuntimeConfig::syncPeriodMinutes,  0,   1440,  ANDROID_SYNC_PERIOD_MINUTES},
+    {"keep_raw_1",  &RuntimeConfig::keepRaw1,           7,   3650,  RETENTION_RAW_DAYS},
+    {"keep_raw_2",  &RuntimeConfig::keepRaw2,           7,   3650,  RETENTION_RAW_DAYS},
+    {"keep_raw_3",  &RuntimeConfig::keepRaw3,           7,   3650,  RETENTION_RAW_DAYS},
+    {"keep_hour_1", &RuntimeConfig::keepHourly1,        7,   3650,  RETENTION_HOURLY_DAYS},
+    {"keep_hour_2", &RuntimeConfig::keepHourly2,        7,   3650,  RETENTION_HOURLY_DAYS},
+    {"keep_hour_3", &RuntimeConfig::keepHourly3,        7,   3650,  RETENTION_HOURLY_DAYS},
+    {"keep_day_1",  &RuntimeConfig::keepDaily1,         0,   36500, RETENTION_DAILY_DAYS},
+    {"keep_day_2",  &RuntimeConfig::keepDaily2,         0,   36500, RETENTION_DAILY_DAYS},
+    {"keep_day_3",  &RuntimeConfig::keepDaily3,         0,   36500, RETENTION_DAILY_DAYS},
+    {"turn_temp_1", &RuntimeConfig::turnTemp1,          0,   90,    FORECAST_TURN_TEMP_C},
+    {"turn_temp_2", &RuntimeConfig::turnTemp2,          0,   90,    FORECAST_TURN_TEMP_C},
+    {"turn_temp_3", &RuntimeConfig::turnTemp3,          0,   90,    0},
+};
+
+// Horizon de chaque niveau de rétention, par carte (voir lib/Retention)
+uint16_t RuntimeConfig::* const RETENTION_FIELDS[MAX_SLAVES][TIER_COUNT] = {
+    {&RuntimeConfig::keepRaw1, &RuntimeConfig::keepHourly1, &RuntimeConfig::keepDaily1},
+    {&RuntimeConfig::keepRaw2, &RuntimeConfig::keepHourly2, &RuntimeConfig::keepDaily2},
+    {&RuntimeConfig::keepRaw3, &RuntimeConfig::keepHourly3, &RuntimeConfig::keepDaily3},
+};
+// Seuil de retournement de chaque carte (°C)
+uint16_t RuntimeConfig::* const TURN_TEMP_FIELDS[MAX_SLAVES] = {
+    &RuntimeConfig::turnTemp1, &RuntimeConfig::turnTemp2, &RuntimeConfig::turnTemp3,
+};
+const int CONFIG_FIELD_COUNT = sizeof(CONFIG_SCHEMA) / sizeof(CONFIG_SCHEMA[0]);
 
 // ==========================================
 // DÉCLARATIONS DE FONCTIONS
 // ==========================================
 void init_BLE();
+void updateTransportSchedule();
+void init_power();
 void startScan();
+void scanGapHandler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param);
+void printScanStats();
+void onScanResult(const esp_ble_gap_cb_param_t::ble_scan_result_evt_param& result);
 bool processSlave();
-void connectAndReadSlave(BLEAddress address, std::string deviceName);
+void acquireSlavesConcurrently();
+void acquisitionTask(void* param);
+void closeClient(BLEClient* pClient, bool connected);
+bool connectAndReadSlave(const FoundSlave& slave, uint32_t timeoutMs);
+bool acquireSlave(const FoundSlave& slave);
+void recordRssi(uint8_t boardId, int8_t rssi);
+int averageRssi(uint8_t boardId);
+void orderSlavesByLinkQuality();
+uint32_t connectTimeoutFor(uint8_t boardId);
+void recordConnectResult(uint8_t boardId, bool success, uint32_t latencyMs);
+bool lockAcquisition();
+void unlockAcquisition();
+void readSlaveValues(BLERemoteService* pRemoteService, uint8_t boardId, float* values);
+bool readSlaveBatch(BLERemoteService* pRemoteService, uint8_t boardId);
+bool storeSlaveBatch(const SlaveBatchHeader& header, const SlaveRecord* records, void* context);
 bool initSD();
-void saveDataToSD();
+void saveDataToSD(uint32_t deadline);
+String buildSlaveRows(const SlaveData& data, const SlaveRecord* batch, uint8_t batchCount, const DateTime& reference);
+void deferSlaveData(int index);
+void recoverPendingBatches();
+void init_budget();
+uint32_t stateBudgetMs(MasterState state);
+void loadRuntimeConfig();
+void applyRuntimeConfig();
+void handleAndroidCommand(const char* command);
+void handleSetCommand(const char* assignment);
+void handleGetCommand(const char* key);
+void sendToAndroid(const char* message);
+void printBudgetCounters();
+MemSample takeMemorySample();
+void recordMemorySample(bool writeLog);
+void sendMemoryStats();
+void notifyAndroid();
+void sendMetrics();
+void printMetrics();
 void sendDataToAndroid();
 void clearSDData();
 bool loadDateTime();
 void saveDateTime();
 void incrementDateTime(int seconds);
-void formatISO8601(char* buffer, DateTime dt);
+const char* slaveFile(uint8_t boardId);
+bool isAndroidSyncWindow(const DateTime& dt);
+uint16_t readBatteryMv();
+uint16_t effectiveSleepMinutes();
+uint16_t effectiveScanSeconds();
+void updatePowerMode();
+void accountEnergy(MasterState state, uint32_t ms);
+void writePowerLog();
+void writeEnergyDay(const EnergyLedger& day);
+void sendPowerStats();
+void compactOldRecords(uint32_t deadline);
+void rollupExpiredFiles(uint32_t deadline);
+const char* boardColumns(uint8_t boardId);
+uint32_t exportArchive(uint8_t boardId, ExportSink& sink);
+void sendExportLine(ExportSink& sink, const char* line, size_t length);
+void sendExportPiece(ExportSink& sink, const BlockReader& reader, const char* line, size_t length);
+uint16_t notifyPayloadSize();
+void writeExport(ExportSink& sink);
+void startExport();
+void pumpExport();
+void handleExportAck(const char* argument);
+void handleExportNack(const char* argument);
+void handleExportResume(const char* argument);
+void startAndroidAdvertising();
+void stopAndroidAdvertising();
+void sendForecast();
+void setForecastAdvert();
 
 // Fonctions utilitaires SD
 void listDir(fs::FS &fs, const char * dirname, uint8_t levels);
 void readFile(fs::FS &fs, const char * path);
-void writeFile(fs::FS &fs, const char * path, const char * message);
+bool writeFile(fs::FS &fs, const char * path, const char * message);
 void deleteRecursive(fs::FS &fs, const char * path);
 void resetCarteSD(fs::FS &fs);
 void initCSVFiles();
@@ -117,8 +504,12 @@ class AndroidServerCallbacks: public BLEServerCallbacks {
 
     void onDisconnect(BLEServer* pServer) {
         androidConnected = false;
+        exportSession.pause();      // Le transfert reste repris par RESUME
         DEBUG_PRINTLN("[BLE] Android disconnected!");
-        BLEDevice::startAdvertising();
+        // Ne réannoncer que si la fenêtre de synchronisation est encore ouverte
+        if (syncWindowOpen) {
+            BLEDevice::startAdvertising();
+        }
     }
 };
 
@@ -135,7 +526,17 @@ class AndroidCharacteristicCallbacks: public BLECharacteristicCallbacks {
                 dataRequested = true;
             } else if (value == "CLEAR") {
                 clearRequested = true;
+            } else if (value.length() < COMMAND_MAX_LEN) {
+                // Commandes texte (SET/GET/ACK...) traitées dans WAIT_ANDROID
+                char command[COMMAND_MAX_LEN];
+                strcpy(command, value.c_str());
+                if (xQueueSend(commandQueue, command, 0) != pdTRUE) {
+                    DEBUG_PRINTLN("[BLE] Command queue full, command dropped");
+                }
             }
+            
+            // Réveiller WAIT_ANDROID
+            xEventGroupSetBits(bleEvents, EVT_ANDROID_CMD);
         }
     }
 };
@@ -143,118 +544,334 @@ class AndroidCharacteristicCallbacks: public BLECharacteristicCallbacks {
 // ==========================================
 // SCAN BLE POUR TROUVER LES ESCLAVES
 // ==========================================
-class AdvertisedDeviceCallbacks: public BLEAdvertisedDeviceCallbacks {
-    void onResult(BLEAdvertisedDevice advertisedDevice) {
-        DEBUG_PRINT("[BLE] Device detected: ");
-        DEBUG_PRINTLN(advertisedDevice.getName().c_str());
-        DEBUG_PRINT("[BLE]    Address: ");
-        DEBUG_PRINTLN(advertisedDevice.getAddress().toString().c_str());
-        DEBUG_PRINT("[BLE]    Has Service UUID: ");
-        DEBUG_PRINTLN(advertisedDevice.haveServiceUUID() ? "YES" : "NO");
-        
-        // Filtrer par le service UUID
-        if (advertisedDevice.haveServiceUUID() && 
-            advertisedDevice.isAdvertisingService(BLEUUID(SENSOR_SERVICE_UUID))) {
+// Appelé par la pile BLE pour chaque événement GAP. Le scan est piloté
+// directement par l'API GAP (sans BLEScan) pour éviter l'allocation d'un
+// BLEAdvertisedDevice et les conversions de chaînes à chaque advert.
+void scanGapHandler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param) {
+    switch (event) {
+        case ESP_GAP_BLE_SCAN_PARAM_SET_COMPLETE_EVT:
+            if (scanInProgress) {
+                esp_ble_gap_start_scanning(effectiveScanSeconds());
+            }
+            break;
             
-            DEBUG_PRINTLN("[BLE]    *** MATCH! Storing slave address ***");
+        case ESP_GAP_BLE_SCAN_RESULT_EVT:
+            if (param->scan_rst.search_evt == ESP_GAP_SEARCH_INQ_RES_EVT) {
+                onScanResult(param->scan_rst);
+            } else if (param->scan_rst.search_evt == ESP_GAP_SEARCH_INQ_CMPL_EVT) {
+                // Durée de scan écoulée
+                scanInProgress = false;
+                xEventGroupSetBits(bleEvents, EVT_SCAN_DONE);
+            }
+            break;
             
-            // Stocker l'adresse et le nom pour connexion ultérieure
-            if (foundSlaveCount < MAX_SLAVES) {
-                foundSlaves[foundSlaveCount] = advertisedDevice.getAddress();
-                slaveNames[foundSlaveCount] = advertisedDevice.getName().c_str();
-                foundSlaveCount++;
+        default:
+            break;
+    }
+}
+
+// Filtrage rapide d'un rapport d'advertising (contexte de la tâche BLE, sans allocation)
+void onScanResult(const esp_ble_gap_cb_param_t::ble_scan_result_evt_param& result) {
+    scanStats.adverts++;
+    if (!scanInProgress || foundSlaveCount >= MAX_SLAVES) return;
+    
+    uint8_t* adv = (uint8_t*)result.ble_adv;
+    uint8_t boardId = 0;
+    
+    // 1) Adresse déjà connue : l'ID de carte est dans la table, le nom est inutile
+    for (int i = 0; i < MAX_SLAVES; i++) {
+        if (knownSlaves[i].known &&
+            memcmp(knownSlaves[i].address, result.bda, ESP_BD_ADDR_LEN) == 0) {
+            boardId = i + 1;
+            break;
+        }
+    }
+    
+    // 2) Sinon : service UUID puis ID depuis le nom (format "EnvSensor_X")
+    if (boardId == 0) {
+        uint8_t len = 0;
+        uint8_t* uuid = esp_ble_resolve_adv_data(adv, ESP_BLE_AD_TYPE_128SRV_CMPL, &len);
+        if (uuid == nullptr) {
+            uuid = esp_ble_resolve_adv_data(adv, ESP_BLE_AD_TYPE_128SRV_PART, &len);
+        }
+        if (uuid == nullptr || len < ESP_UUID_LEN_128 ||
+            memcmp(uuid, sensorServiceUUID, ESP_UUID_LEN_128) != 0) {
+            return;
+        }
+        
+        uint8_t* name = esp_ble_resolve_adv_data(adv, ESP_BLE_AD_TYPE_NAME_CMPL, &len);
+        if (name == nullptr) {
+            name = esp_ble_resolve_adv_data(adv, ESP_BLE_AD_TYPE_NAME_SHORT, &len);
+        }
+        if (name == nullptr || len == 0) {
+            // Le nom est dans la réponse de scan : nécessite un scan actif
+            scanStats.unnamed++;
+            return;
+        }
+        
+        char lastChar = name[len - 1];
+        if (lastChar < '1' || lastChar > '0' + MAX_SLAVES) {
+            return;
+        }
+        boardId = lastChar - '0';
+    }
+    
+    // Ignorer les doublons (carte déjà repérée pendant ce scan)
+    for (int i = 0; i < foundSlaveCount; i++) {
+        if (foundSlaves[i].boardId == boardId) return;
+    }
+    
+    scanStats.matched++;
+    FoundSlave& slave = foundSlaves[foundSlaveCount];
+    memcpy(slave.address, result.bda, ESP_BD_ADDR_LEN);
+    slave.addressType = result.ble_addr_type;
+    slave.boardId = boardId;
+    slave.rssi = result.rssi;
+    foundSlaveCount++;
+    
+    // Tous les slaves trouvés : inutile d'attendre la fin du scan
+    if (foundSlaveCount >= MAX_SLAVES) {
+        esp_ble_gap_stop_scanning();
+        scanInProgress = false;
+        xEventGroupSetBits(bleEvents, EVT_SCAN_DONE);
+    }
+}
+
+// ==========================================
+// LECTURE DE LA MESURE COURANTE (une caractéristique par grandeur)
+// ==========================================
+// La valeur lue n'est pas forcément alignée : copie octet par octet
+float decodeFloat(const std::string& value) {
+    float result;
+    memcpy(&result, value.data(), sizeof(result));
+    return result;
+}
+
+// Lit dans values (NAN si non lue), publiées ensuite sous acquisitionMutex
+void readSlaveValues(BLERemoteService* pRemoteService, uint8_t boardId, float* values) {
+    for (uint8_t f = 0; f < FIELD_COUNT; f++) {
+        values[f] = NAN;
+    }
+    
+    // Seules les grandeurs du schéma de la carte sont lues
+    for (uint8_t n = 0; n < boardFieldCount(boardId); n++) {
+        uint8_t f = boardField(boardId, n);
+        BLERemoteCharacteristic* pChar = pRemoteService->getCharacteristic(FIELD_SPECS[f].uuid);
+        if (pChar && pChar->canRead()) {
+            std::string value = pChar->readValue();
+            if (value.length() >= sizeof(float)) {
+                values[f] = decodeFloat(value);
+                DEBUG_PRINT("[BLE]    ");
+                DEBUG_PRINT(FIELD_SPECS[f].column);
+                DEBUG_PRINT(": ");
+                DEBUG_PRINTLN(values[f]);
             }
-        } else {
-            DEBUG_PRINTLN("[BLE]    Service UUID does not match");
         }
     }
-};
+}
+
+// ==========================================
+// ENREGISTREMENT D'UN LOT (commun à tous les transports)
+// ==========================================
+// Les lots d'une même carte peuvent arriver plusieurs fois dans le cycle (en
+// direct et par un relais) : seules les séquences jamais reçues sont ajoutées.
+// Un lot entièrement en double est tout de même accepté, pour être acquitté.
+// Une séquence n'est marquée reçue qu'une fois la mesure enregistrée : si le
+// lot du cycle est plein, le reste est refusé (pas d'acquittement) et sera
+// accepté lorsque l'esclave le renverra. Il en va de même d'un lot lu par une
+// tâche d'acquisition après la fin du budget.
+bool storeSlaveBatch(const SlaveBatchHeader& header, const SlaveRecord* records, void* context) {
+    uint8_t boardId = header.boardId;
+    if (boardId < 1 || boardId > MAX_SLAVES) {
+        // Lot relayé d'une carte inconnue : ignoré, sans bloquer l'acquittement du relais
+        return header.hops > 0;
+    }
+    
+    uint8_t idx = boardId - 1;
+    
+    if (!lockAcquisition()) {
+        DEBUG_PRINT("[BLE] Acquisition closed, batch of board ");
+        DEBUG_PRINT(boardId);
+        DEBUG_PRINTLN(" left to the sender");
+        return false;
+    }
+    uint8_t first = pendingBatches.count[idx];
+    StoreResult result = storeNewRecords(seqWindows[idx], records, header.count,
+                                         pendingBatches.records[idx], &pendingBatches.count[idx],
+                                         RECORD_BATCH_MAX_COUNT);
+    
+    // La mesure la plus récente sert de valeur courante pour le résumé
+    for (uint8_t i = first; i < pendingBatches.count[idx]; i++) {
+        const SlaveRecord& record = pendingBatches.records[idx][i];
+        if (!slavesData[idx].received || record.ageMinutes <= newestAge[idx]) {
+            newestAge[idx] = record.ageMinutes;
+            for (uint8_t f = 0; f < FIELD_COUNT; f++) {
+                slavesData[idx].values[f] = decodeCenti(record.values[f]);
+            }
+            slavesData[idx].batteryMv = record.battery;
+            slavesData[idx].boardId = boardId;
+            formatISO8601(slavesData[idx].isoTime, currentDateTime);
+            slavesData[idx].received = true;
+        }
+    }
+    recordsTotal.inc(result.stored);
+    duplicatesTotal.inc(result.duplicates);
+    tooOldTotal.inc(result.tooOld);
+    unlockAcquisition();
+    
+    if (header.hops > 0) {
+        DEBUG_PRINT("[RELAY] Board ");
+        DEBUG_PRINT(boardId);
+        DEBUG_PRINT(" relayed over ");
+        DEBUG_PRINT(header.hops);
+        DEBUG_PRINT(" hop(s), records: ");
+        DEBUG_PRINTLN(header.count);
+    }
+    if (result.duplicates > 0) {
+        DEBUG_PRINT("[RELAY] Duplicates dropped for board ");
+        DEBUG_PRINT(boardId);
+        DEBUG_PRINT(": ");
+        DEBUG_PRINTLN(result.duplicates);
+    }
+    if (result.tooOld > 0) {
+        DEBUG_PRINT("[RELAY] Records older than the sequence window dropped for board ");
+        DEBUG_PRINT(boardId);
+        DEBUG_PRINT(": ");
+        DEBUG_PRINTLN(result.tooOld);
+    }
+    if (!result.complete) {
+        DEBUG_PRINT("[RELAY] Batch full for board ");
+        DEBUG_PRINT(boardId);
+        DEBUG_PRINTLN(", remaining records left to the sender");
+    }
+    
+    return result.complete;
+}
+
+// ==========================================
+// LECTURE D'UN LOT DE MESURES MÉMORISÉES
+// ==========================================
+// Retourne false si le slave n'expose pas de lot (ancien firmware).
+bool readSlaveBatch(BLERemoteService* pRemoteService, uint8_t boardId) {
+    BLERemoteCharacteristic* pCharBatch = pRemoteService->getCharacteristic(BATCH_CHARACTERISTIC_UUID);
+    if (pCharBatch == nullptr || !pCharBatch->canRead()) {
+        return false;
+    }
+    
+    // Lot du slave, suivi des lots qu'il relaie pour des cartes éloignées
+    std::string value = pCharBatch->readValue();
+    SlaveBatchHeader header;
+    const SlaveRecord* records;
+    uint32_t boards = 0;
+    const uint8_t* data = (const uint8_t*)value.data();
+    if (value.length() < sizeof(SlaveBatchHeader) ||
+        ((const SlaveBatchHeader*)data)->boardId != boardId ||
+        !parseBatch(data, value.length(), &header, &records) || header.hops != 0) {
+        DEBUG_PRINTLN("[BLE]    Invalid batch header");
+        return false;
+    }
+    
+    // Lot incomplet (tampon du cycle plein) : pas d'acquittement, le slave le renverra
+    if (!dispatchUpload(data, value.length(), batchSink, batchSinkContext, &header, &records, &boards)) {
+        DEBUG_PRINTLN("[BLE]    Batch not fully stored, not acknowledged");
+        return true;
+    }
+    
+    DEBUG_PRINT("[BLE]    Batch records: ");
+    DEBUG_PRINTLN(header.count);
+    
+    // Pas de mesure en attente ni relayée : lire la mesure courante
+    if (header.count == 0 && boards == (1UL << boardId)) {
+        return false;
+    }
+    
+    // Acquitter l'envoi pour que le slave libère son tampon (et ses lots relayés)
+    BLERemoteCharacteristic* pCharAck = pRemoteService->getCharacteristic(BATCH_ACK_CHARACTERISTIC_UUID);
+    if (pCharAck && pCharAck->canWrite()) {
+        uint16_t lastSeq = makeAck(header, records, SlaveSchedule{0, 0}).lastSeq;
+        pCharAck->writeValue((uint8_t*)&lastSeq, sizeof(lastSeq), true);
+        DEBUG_PRINT("[BLE]    Batch acknowledged up to seq ");
+        DEBUG_PRINTLN(lastSeq);
+    }
+    
+    return true;
+}
 
 // ==========================================
 // CONNEXION À UN ESCLAVE ET LECTURE DES DONNÉES
 // ==========================================
-void connectAndReadSlave(BLEAddress address, std::string deviceName) {
-    BLEClient* pClient = BLEDevice::createClient();
+// Création, connexion, déconnexion et destruction des clients sont
+// sérialisées : BLEDevice partage la table des pairs entre tous les clients,
+// et le contrôleur ne traite qu'une demande de connexion (HCI LE Create
+// Connection) à la fois. L'établissement des liens reste donc séquentiel ;
+// seules la découverte de service, les lectures et les acquittements des
+// liens ouverts se recouvrent.
+void closeClient(BLEClient* pClient, bool connected) {
+    xSemaphoreTake(connectMutex, portMAX_DELAY);
+    if (connected) {
+        pClient->disconnect();
+    }
+    delete pClient;
+    xSemaphoreGive(connectMutex);
+}
+
+bool connectAndReadSlave(const FoundSlave& slave, uint32_t timeoutMs) {
+    BLEAddress address((uint8_t*)slave.address);
+    uint8_t boardId = slave.boardId;
     
     DEBUG_PRINT("[BLE] Connecting to slave: ");
-    DEBUG_PRINTLN(deviceName.c_str());
+    DEBUG_PRINTLN(boardId);
     DEBUG_PRINT("[BLE]    Address: ");
     DEBUG_PRINTLN(address.toString().c_str());
     
-    if (pClient->connect(address)) {
+    xSemaphoreTake(connectMutex, portMAX_DELAY);
+    BLEClient* pClient = BLEDevice::createClient();
+    uint32_t connectStart = millis();
+    bool connected = pClient->connect(address, slave.addressType, timeoutMs);
+    uint32_t connectMs = millis() - connectStart;
+    xSemaphoreGive(connectMutex);
+    recordConnectResult(boardId, connected, connectMs);
+    
+    if (connected) {
         DEBUG_PRINTLN("[BLE] Connected");
         
         // Récupérer le service
         BLERemoteService* pRemoteService = pClient->getService(SENSOR_SERVICE_UUID);
         if (pRemoteService == nullptr) {
             DEBUG_PRINTLN("[BLE] Service not found");
-            pClient->disconnect();
-            delete pClient;
-            return;
-        }
-        
-        // Extraire l'ID depuis le nom du dispositif (format: "EnvSensor_X")
-        uint8_t boardId = 0;
-        
-        // Chercher le dernier caractère qui devrait être l'ID
-        if (deviceName.length() > 0) {
-            char lastChar = deviceName[deviceName.length() - 1];
-            if (lastChar >= '1' && lastChar <= '3') {
-                boardId = lastChar - '0';
-            }
+            closeClient(pClient, true);
+            return false;
         }
         
+        // L'ID de carte vient du nom ou de la table des slaves connus (scan)
         if (boardId < 1 || boardId > MAX_SLAVES) {
             DEBUG_PRINTLN("[BLE] Invalid board ID");
-            pClient->disconnect();
-            delete pClient;
-            return;
+            closeClient(pClient, true);
+            return false;
         }
         
         DEBUG_PRINT("[BLE]    Board ID: ");
         DEBUG_PRINTLN(boardId);
         
-        // Lire la température
-        BLERemoteCharacteristic* pCharTemp = pRemoteService->getCharacteristic(TEMP_CHARACTERISTIC_UUID);
-        if (pCharTemp && pCharTemp->canRead()) {
-            std::string value = pCharTemp->readValue();
-            if (value.length() >= sizeof(float)) {
-                slavesData[boardId-1].temperature = *((float*)value.data());
-                DEBUG_PRINT("[BLE]    Temperature: ");
-                DEBUG_PRINTLN(slavesData[boardId-1].temperature);
-            }
-        }
-        
-        // Lire l'humidité
-        BLERemoteCharacteristic* pCharHum = pRemoteService->getCharacteristic(HUMID_CHARACTERISTIC_UUID);
-        if (pCharHum && pCharHum->canRead()) {
-            std::string value = pCharHum->readValue();
-            if (value.length() >= sizeof(float)) {
-                slavesData[boardId-1].humidity = *((float*)value.data());
-                DEBUG_PRINT("[BLE]    Humidity: ");
-                DEBUG_PRINTLN(slavesData[boardId-1].humidity);
-            }
+        // Slave avec tampon : un seul échange pour toutes les mesures en attente
+        // sinon lecture des caractéristiques individuelles (mesure courante)
+        float values[FIELD_COUNT];
+        bool current = !readSlaveBatch(pRemoteService, boardId);
+        if (current) {
+            readSlaveValues(pRemoteService, boardId, values);
         }
         
-        // Lire la pression
-        BLERemoteCharacteristic* pCharPress = pRemoteService->getCharacteristic(PRES_CHARACTERISTIC_UUID);
-        if (pCharPress && pCharPress->canRead()) {
-            std::string value = pCharPress->readValue();
-            if (value.length() >= sizeof(float)) {
-                slavesData[boardId-1].pressure = *((float*)value.data());
-                DEBUG_PRINT("[BLE]    Pressure: ");
-                DEBUG_PRINTLN(slavesData[boardId-1].pressure);
-            }
+        // Publier les résultats, sauf si l'acquisition est déjà close
+        if (!lockAcquisition()) {
+            DEBUG_PRINT("[BLE] Acquisition closed, results of board ");
+            DEBUG_PRINT(boardId);
+            DEBUG_PRINTLN(" dropped");
+            closeClient(pClient, true);
+            return false;
         }
-        
-        // Lire l'oxygène
-        BLERemoteCharacteristic* pCharOxy = pRemoteService->getCharacteristic(OXY_CHARACTERISTIC_UUID);
-        if (pCharOxy && pCharOxy->canRead()) {
-            std::string value = pCharOxy->readValue();
-            if (value.length() >= sizeof(float)) {
-                slavesData[boardId-1].oxygen = *((float*)value.data());
-                DEBUG_PRINT("[BLE]    Oxygen: ");
-                DEBUG_PRINTLN(slavesData[boardId-1].oxygen);
+        if (current) {
+            for (uint8_t f = 0; f < FIELD_COUNT; f++) {
+                if (!isnan(values[f])) slavesData[boardId-1].values[f] = values[f];
             }
         }
         
@@ -263,29 +880,149 @@ void connectAndReadSlave(BLEAddress address, std::string deviceName) {
         formatISO8601(slavesData[boardId-1].isoTime, currentDateTime);
         slavesData[boardId-1].received = true;
         
+        // Mémoriser l'adresse pour la liste d'acceptation des prochains scans
+        memcpy(knownSlaves[boardId-1].address, slave.address, ESP_BD_ADDR_LEN);
+        knownSlaves[boardId-1].addressType = slave.addressType;
+        knownSlaves[boardId-1].known = true;
+        unlockAcquisition();
+        
         DEBUG_PRINTLN("[BLE] Data retrieved");
         
-        // Envoyer le sleep time au slave
-        BLERemoteService* pSleepTimeService = pClient->getService("9D818D7B-A445-46F5-8A3F-B9F86EA5DE2F");
+        // Envoyer la configuration au slave (sleep time, durée d'advertising)
+        BLERemoteService* pSleepTimeService = pClient->getService(SLAVE_CONFIG_SERVICE_UUID);
         if (pSleepTimeService != nullptr) {
-            BLERemoteCharacteristic* pSleepTimeChar = pSleepTimeService->getCharacteristic("CEF11275-083B-4027-AD0E-0DDB904278A5");
+            BLERemoteCharacteristic* pSleepTimeChar = pSleepTimeService->getCharacteristic(SLEEP_TIME_CHARACTERISTIC_UUID);
             if (pSleepTimeChar && pSleepTimeChar->canWrite()) {
-                // Convertir la durée en hexadécimal (le slave lit en base 16)
+                // Consigne non ajustée à la batterie du maître : le slave applique
+                // son propre mode. Convertie en hexadécimal (le slave lit en base 16)
                 char sleepTimeHex[20];
-                sprintf(sleepTimeHex, "%llx", (unsigned long long)SLEEP_DURATION);
+                sprintf(sleepTimeHex, "%llx", (unsigned long long)runtimeConfig.sleepMinutes * 60 * 1000000ULL);
                 pSleepTimeChar->writeValue(sleepTimeHex);
                 DEBUG_PRINT("[BLE]    Sleep time sent: ");
                 DEBUG_PRINTLN(sleepTimeHex);
             }
+            
+            BLERemoteCharacteristic* pAdvTimeChar = pSleepTimeService->getCharacteristic(ADVERTISE_TIME_CHARACTERISTIC_UUID);
+            if (pAdvTimeChar && pAdvTimeChar->canWrite()) {
+                char advTimeHex[8];
+                sprintf(advTimeHex, "%x", runtimeConfig.advertiseSeconds);
+                pAdvTimeChar->writeValue(advTimeHex);
+                DEBUG_PRINT("[BLE]    Advertise time sent: ");
+                DEBUG_PRINTLN(advTimeHex);
+            }
         }
         
-        // Déconnexion
-        pClient->disconnect();
     } else {
         DEBUG_PRINTLN("[BLE] Connection failed");
     }
     
-    delete pClient;
+    // Déconnexion
+    closeClient(pClient, connected);
+    return connected;
+}
+
+// ==========================================
+// TENTATIVES AVEC BACKOFF EXPONENTIEL
+// ==========================================
+// Réessaie un slave injoignable tant que le budget du cycle le permet.
+bool acquireSlave(const FoundSlave& slave) {
+    for (int attempt = 1; attempt <= SLAVE_MAX_ATTEMPTS; attempt++) {
+        uint32_t timeoutMs = connectTimeoutFor(slave.boardId);
+        
+        // Acquisition close ou pas assez de temps pour une tentative complète
+        if (!acquisitionOpen || (int32_t)(acquisitionDeadline - millis()) < (int32_t)timeoutMs) {
+            DEBUG_PRINT("[BLE] Cycle budget exhausted, skipping board ");
+            DEBUG_PRINTLN(slave.boardId);
+            return false;
+        }
+        
+        if (connectAndReadSlave(slave, timeoutMs)) {
+            return true;
+        }
+        
+        if (attempt < SLAVE_MAX_ATTEMPTS) {
+            if (lockAcquisition()) {
+                retriesTotal.inc();
+                unlockAcquisition();
+            }
+            DEBUG_PRINT("[BLE] Retrying board ");
+            DEBUG_PRINT(slave.boardId);
+            DEBUG_PRINT(" in ");
+            DEBUG_PRINT(retryBackoffMs(attempt));
+            DEBUG_PRINTLN(" ms");
+            vTaskDelay(pdMS_TO_TICKS(retryBackoffMs(attempt)));
+        }
+    }
+    
+    return false;
+}
+
+// ==========================================
+// TABLE DE QUALITÉ DE LIEN
+// ==========================================
+void recordRssi(uint8_t boardId, int8_t rssi) {
+    SlaveLink& link = linkTable[boardId - 1];
+    link.rssiHistory[link.rssiNext] = rssi;
+    link.rssiNext = (link.rssiNext + 1) % RSSI_HISTORY;
+    if (link.rssiCount < RSSI_HISTORY) link.rssiCount++;
+}
+
+int averageRssi(uint8_t boardId) {
+    const SlaveLink& link = linkTable[boardId - 1];
+    if (link.rssiCount == 0) return -127;
+    int sum = 0;
+    for (int i = 0; i < link.rssiCount; i++) {
+        sum += link.rssiHistory[i];
+    }
+    return sum / link.rssiCount;
+}
+
+// Ordre de connexion : meilleur RSSI moyen d'abord, pénalisé par le taux d'échec
+void orderSlavesByLinkQuality() {
+    for (int i = 0; i < foundSlaveCount; i++) {
+        recordRssi(foundSlaves[i].boardId, foundSlaves[i].rssi);
+    }
+    
+    for (int i = 1; i < foundSlaveCount; i++) {
+        FoundSlave current = foundSlaves[i];
+        int score = averageRssi(current.boardId) - linkTable[current.boardId - 1].failureRate / 5;
+        int j = i - 1;
+        while (j >= 0 &&
+               averageRssi(foundSlaves[j].boardId) - linkTable[foundSlaves[j].boardId - 1].failureRate / 5 < score) {
+            foundSlaves[j + 1] = foundSlaves[j];
+            j--;
+        }
+        foundSlaves[j + 1] = current;
+    }
+}
+
+// Timeout de connexion : 3x la latence habituelle du slave, borné
+uint32_t connectTimeoutFor(uint8_t boardId) {
+    const SlaveLink& link = linkTable[boardId - 1];
+    return connectTimeoutMs(link.attempts != link.failures, link.connectMs);
+}
+
+// Appelé par les tâches d'acquisition : ignoré une fois l'acquisition close
+void recordConnectResult(uint8_t boardId, bool success, uint32_t latencyMs) {
+    if (boardId < 1 || boardId > MAX_SLAVES) return;
+    if (!lockAcquisition()) return;
+    SlaveLink& link = linkTable[boardId - 1];
+    
+    link.attempts++;
+    connectionsTotal.inc();
+    if (success) {
+        connectLatency.observe(latencyMs);
+        // Première connexion réussie : initialiser la moyenne
+        link.connectMs = (link.attempts - link.failures == 1)
+            ? latencyMs
+            : (link.connectMs * 3 + latencyMs) / 4;
+        link.failureRate = (link.failureRate * 7) / 8;
+    } else {
+        connectionFailuresTotal.inc();
+        link.failures++;
+        link.failureRate = (link.failureRate * 7 + 100) / 8;
+    }
+    unlockAcquisition();
 }
 
 // ==========================================
@@ -322,7 +1059,74 @@ bool initSD() {
 // ==========================================
 // INITIALISER LES FICHIERS CSV
 // ==========================================
+// CSV d'une carte créé avant la colonne qualité : recopié une seule fois
+// dans /<carte>.tmp, avec l'en-tête courant et une colonne qualité vide
+// (code inconnu) sur chaque ligne, puis renommé. Une coupure pendant la
+// copie la fait recommencer au démarrage suivant ; entre la suppression et
+// le renommage, la copie est récupérée comme celle d'une compaction.
+bool migrateQualityColumn(uint8_t boardId) {
+    const char* csvPath = slaveFile(boardId);
+    File src = SD.open(csvPath, FILE_READ);
+    if (!src) return false;
+    String header = src.readStringUntil('\n');
+    if (header.indexOf("qualite;") >= 0) {
+        src.close();
+        return true;
+    }
+    
+    char tmpPath[24];
+    boardArchivePath(tmpPath, sizeof(tmpPath), boardId, ".tmp");
+    File tmp = SD.open(tmpPath, FILE_WRITE);
+    if (!tmp) {
+        src.close();
+        return false;
+    }
+    tmp.print(boardColumns(boardId));
+    tmp.println("qualite;");
+    
+    char line[CSV_ROW_MAX + 16];
+    bool ok = true;
+    while (ok && src.available()) {
+        size_t n = src.readBytesUntil('\n', line, sizeof(line) - 2);
+        if (n > 0 && line[n - 1] == '\r') n--;
+        if (n == 0) continue;
+        line[n++] = ';';
+        line[n++] = '\n';
+        ok = tmp.write((const uint8_t*)line, n) == n;
+        // Copie unique, éventuellement longue : hors budget du cycle
+        esp_task_wdt_reset();
+    }
+    src.close();
+    tmp.close();
+    
+    if (!ok) {
+        SD.remove(tmpPath);
+        sdWriteErrorsTotal.inc();
+        DEBUG_PRINT("[SD] Failed to add quality column to ");
+        DEBUG_PRINTLN(csvPath);
+        return false;
+    }
+    SD.remove(csvPath);
+    SD.rename(tmpPath, csvPath);
+    DEBUG_PRINT("[SD] Quality column added to ");
+    DEBUG_PRINTLN(csvPath);
+    return true;
+}
+
 void initCSVFiles() {
+    // Compaction (ou ajout de la colonne qualité) interrompue entre la
+    // suppression du CSV et le renommage de sa copie : la copie contient déjà
+    // toutes les mesures non archivées
+    for (uint8_t boardId = 1; boardId <= MAX_SLAVES; boardId++) {
+        char tmpPath[24];
+        boardArchivePath(tmpPath, sizeof(tmpPath), boardId, ".tmp");
+        if (!SD.exists(slaveFile(boardId)) && SD.exists(tmpPath)) {
+            SD.rename(tmpPath, slaveFile(boardId));
+            DEBUG_PRINT("[COMPACT] Recovered ");
+            DEBUG_PRINTLN(slaveFile(boardId));
+        }
+    }
+    
     // Fichier Master (température uniquement)
     if (!SD.exists(MASTER_FILE)) {
         File file = SD.open(MASTER_FILE, FILE_WRITE);
@@ -333,168 +1137,820 @@ void initCSVFiles() {
         }
     }
     
-    // Fichier Apport (T, H, O2)
-    if (!SD.exists(APPORT_FILE)) {
-        File file = SD.open(APPORT_FILE, FILE_WRITE);
+    // Un fichier par carte esclave, colonnes d'après son schéma
+    for (uint8_t boardId = 1; boardId <= MAX_SLAVES; boardId++) {
+        const BoardSpec& board = BOARD_SPECS[boardId - 1];
+        if (SD.exists(board.file)) {
+            migrateQualityColumn(boardId);
+            continue;
+        }
+        File file = SD.open(board.file, FILE_WRITE);
+        if (file) {
+            file.print(boardColumns(boardId));
+            file.println("qualite;");
+            file.close();
+            DEBUG_PRINT("[SD] CSV created: ");
+            DEBUG_PRINTLN(board.file);
+        }
+    }
+    
+    // Journal de diagnostic mémoire (un cycle par ligne)
+    if (!SD.exists(DIAG_FILE)) {
+        File file = SD.open(DIAG_FILE, FILE_WRITE);
         if (file) {
-            file.println("date;temperature;humidity;oxygene;");
+            file.print("date;cycle;min_free_heap;largest_block;free_heap;allocated_blocks;");
+            for (int i = 0; i < MEM_TASK_COUNT; i++) {
+                file.print("stack_");
+                file.print(MEM_TASKS[i]);
+                file.print(";");
+            }
+            file.println();
             file.close();
-            DEBUG_PRINTLN("[SD] Apport CSV created");
+            DEBUG_PRINTLN("[SD] Diagnostics CSV created");
         }
     }
     
-    // Fichier Maturation (T, H)
-    if (!SD.exists(MATURATION_FILE)) {
-        File file = SD.open(MATURATION_FILE, FILE_WRITE);
+    // Tension batterie par carte (mode : carte maître uniquement)
+    if (!SD.exists(POWER_FILE)) {
+        File file = SD.open(POWER_FILE, FILE_WRITE);
         if (file) {
-            file.println("date;temperature;humidity;");
+            file.println("date;board;battery_mv;mode;");
             file.close();
-            DEBUG_PRINTLN("[SD] Maturation CSV created");
+            DEBUG_PRINTLN("[SD] Power CSV created");
         }
     }
     
-    // Fichier Extérieur (T, H)
-    if (!SD.exists(EXTERIEUR_FILE)) {
-        File file = SD.open(EXTERIEUR_FILE, FILE_WRITE);
+    // Bilan énergétique journalier du maître (secondes par état, mAh estimés)
+    if (!SD.exists(ENERGY_FILE)) {
+        File file = SD.open(ENERGY_FILE, FILE_WRITE);
         if (file) {
-            file.println("date;temperature;humidity;");
+            file.println("date;wakeups;battery_mv;mode;time_s;scan_s;acquire_s;process_s;"
+                         "android_s;sleep_prep_s;broken_link_s;deep_sleep_s;mah;");
             file.close();
-            DEBUG_PRINTLN("[SD] Exterieur CSV created");
+            DEBUG_PRINTLN("[SD] Energy CSV created");
         }
     }
 }
 
 // ==========================================
-// SAUVEGARDE DES DONNÉES SUR SD
+// FORMAT DES LIGNES CSV PAR CARTE
 // ==========================================
-void saveDataToSD() {
-    DEBUG_PRINTLN("[SD] Saving to SD card...");
+// Le schéma (lib/Schema) doit tenir dans les tampons de contrôle, d'archive et d'agrégat
+static_assert(MAX_SLAVES == SCHEMA_BOARDS, "une entrée de BOARD_SPECS par esclave");
+static_assert(SCHEMA_MAX_FIELDS <= SCREEN_MAX_CHANNELS, "colonne qualité trop étroite pour le schéma");
+static_assert(SCHEMA_MAX_FIELDS + 1 <= GORILLA_MAX_CHANNELS, "blocs archivés trop étroits pour le schéma");
+static_assert(SCHEMA_MAX_FIELDS <= TIER_MAX_CHANNELS, "agrégats trop étroits pour le schéma");
+
+const char* slaveFile(uint8_t boardId) {
+    return schemaValidBoard(boardId) ? BOARD_SPECS[boardId - 1].file : nullptr;
+}
+
+// En-tête des CSV d'une carte (agrégats ; les mesures brutes y ajoutent "qualite;")
+const char* boardColumns(uint8_t boardId) {
+    static char headers[SCHEMA_BOARDS][CSV_ROW_MAX];
+    if (!schemaValidBoard(boardId)) return "date;";
+    char* header = headers[boardId - 1];
+    if (header[0] == '\0') formatCsvHeader(header, CSV_ROW_MAX, boardId);
+    return header;
+}
+
+// ==========================================
+// CONTRÔLE DES MESURES
+// ==========================================
+// Chaque mesure est contrôlée (lib/Screening) au moment où sa ligne est
+// formée, dans l'ordre chronologique : les écritures reportées passent avant
+// celles du cycle, et la dernière valeur retenue par champ reste en RTC.
+const char* const QUALITY_NAMES[QUALITY_CODE_COUNT] = {"ok", "missing", "out of range", "spike", "stuck"};
+
+// Ligne CSV d'une mesure contrôlée : valeurs rejetées écrites "nan", colonne qualité
+void screenedRow(char* row, size_t maxLen, uint8_t boardId, const DateTime& when, const int16_t* centi) {
+    uint8_t channels = boardFieldCount(boardId);
+    uint32_t time = (uint32_t)dateTimeToEpoch(when);
+    float values[SCHEMA_MAX_FIELDS];
+    uint16_t quality = 0;
     
-    // Sauvegarder les données de chaque esclave dans son fichier respectif
-    for (int i = 0; i < MAX_SLAVES; i++) {
-        if (slavesData[i].received) {
-            const char* filename;
-            String data;
-            
-            // Déterminer le fichier et le format selon le boardId
-            switch (slavesData[i].boardId) {
-                case 1: // Apport (T, H, O2)
-                    filename = APPORT_FILE;
-                    data = String(slavesData[i].isoTime) + ";" + 
-                           String(slavesData[i].temperature, 2) + ";" +
-                           String(slavesData[i].humidity, 2) + ";" +
-                           String(slavesData[i].oxygen, 2) + ";\n";
-                    break;
-                    
-                case 2: // Maturation (T, H)
-                    filename = MATURATION_FILE;
-                    data = String(slavesData[i].isoTime) + ";" + 
-                           String(slavesData[i].temperature, 2) + ";" +
-                           String(slavesData[i].humidity, 2) + ";\n";
-                    break;
-                    
-                case 3: // Extérieur (T, H)
-                    filename = EXTERIEUR_FILE;
-                    data = String(slavesData[i].isoTime) + ";" + 
-                           String(slavesData[i].temperature, 2) + ";" +
-                           String(slavesData[i].humidity, 2) + ";\n";
-                    break;
-                    
-                default:
-                    DEBUG_PRINT("[SD] Unknown board ID: ");
-                    DEBUG_PRINTLN(slavesData[i].boardId);
-                    continue;
-            }
-            
-            // Écrire dans le fichier
-            writeFile(SD, filename, data.c_str());
-            
-            DEBUG_PRINT("[SD]    Board ");
-            DEBUG_PRINT(slavesData[i].boardId);
-            DEBUG_PRINTLN(" saved");
+    // Colonne c = c-ième champ du schéma de la carte ; limites et état par champ
+    for (uint8_t c = 0; c < channels; c++) {
+        uint8_t f = boardField(boardId, c);
+        QualityCode code = screenValue(SCREEN_LIMITS[boardId - 1][f], screenStates[boardId - 1][f], centi[f], time);
+        quality = withQuality(quality, c, code);
+        values[c] = NAN;
+        if (code != QUALITY_MISSING && code != QUALITY_RANGE) {
+            values[c] = decodeCenti(centi[f]);
+        }
+        if (code == QUALITY_OK) {
+            // Seules les températures retenues alimentent la prévision
+            if (f == FIELD_TEMPERATURE) holtUpdate(forecasts[boardId - 1], values[c], time, FORECAST_ALPHA, FORECAST_BETA);
+            continue;
+        }
+        
+        if (code == QUALITY_RATE || code == QUALITY_STUCK) {
+            screenSuspectTotal.inc();
+        } else {
+            screenRejectedTotal.inc();
+        }
+        if (code != QUALITY_MISSING) {
+            DEBUG_PRINT("[SCREEN] Board ");
+            DEBUG_PRINT(boardId);
+            DEBUG_PRINT(" ");
+            DEBUG_PRINT(FIELD_SPECS[f].column);
+            DEBUG_PRINT(" ");
+            DEBUG_PRINT(centi[f] / 100.0f);
+            DEBUG_PRINT(": ");
+            DEBUG_PRINTLN(QUALITY_NAMES[code]);
         }
     }
     
-    DEBUG_PRINTLN("[SD] Save complete");
+    char isoTime[ISO8601_LENGTH + 1];
+    formatISO8601(isoTime, when);
+    size_t length = formatCsvRow(row, maxLen, boardId, isoTime, values);
+    appendQualityColumn(row, length, maxLen, quality, channels);
 }
 
 // ==========================================
-// ENVOI DES DONNÉES À ANDROID
+// SAUVEGARDE DES DONNÉES SUR SD
 // ==========================================
-void sendDataToAndroid() {
-    DEBUG_PRINTLN("[BLE] Sending data to Android...");
-    
-    if (!pCharTX) {
-        DEBUG_PRINTLN("[BLE] TX characteristic not available");
-        return;
+// Lignes CSV d'un slave : lot mémorisé (daté d'après l'âge de chaque mesure
+// par rapport à reference) ou mesure courante.
+String buildSlaveRows(const SlaveData& data, const SlaveRecord* batch, uint8_t batchCount, const DateTime& reference) {
+    char row[CSV_ROW_MAX];
+    if (batchCount == 0) {
+        DateTime when = reference;
+        parseISO8601(data.isoTime, &when);
+        int16_t centi[FIELD_COUNT];
+        for (uint8_t f = 0; f < FIELD_COUNT; f++) {
+            centi[f] = encodeCenti(data.values[f]);
+        }
+        screenedRow(row, sizeof(row), data.boardId, when, centi);
+        return String(row);
     }
     
-    // Liste des fichiers à envoyer
-    const char* files[] = {MASTER_FILE, APPORT_FILE, MATURATION_FILE, EXTERIEUR_FILE};
-    const char* fileNames[] = {"master", "apport", "maturation", "exterieur"};
-    
-    for (int i = 0; i < 4; i++) {
-        if (!SD.exists(files[i])) continue;
-        
-        File file = SD.open(files[i], FILE_READ);
-        if (!file) {
-            DEBUG_PRINT("[BLE] Failed to open file: ");
-            DEBUG_PRINTLN(files[i]);
+    String rows;
+    rows.reserve(batchCount * CSV_ROW_MAX);
+    for (int r = 0; r < batchCount; r++) {
+        DateTime when = offsetDateTime(reference, -(long)batch[r].ageMinutes * 60);
+        screenedRow(row, sizeof(row), data.boardId, when, batch[r].values);
+        rows += row;
+    }
+    return rows;
+}
+
+// Reporter l'écriture d'un slave au prochain cycle (copie en mémoire RTC)
+void deferSlaveData(int index) {
+    DeferredFlush& slot = deferredFlush[index];
+    if (slot.data.received) {
+        DEBUG_PRINT("[SD] Deferred data overwritten for board ");
+        DEBUG_PRINTLN(index + 1);
+    }
+    slot.data = slavesData[index];
+    slot.reference = pendingBatches.reference;
+    slot.batchCount = pendingBatches.count[index];
+    memcpy(slot.batch, pendingBatches.records[index], slot.batchCount * sizeof(SlaveRecord));
+    pendingBatches.count[index] = 0;
+    budgetCounters.deferredFlushes++;
+}
+
+// Au démarrage : RTC non initialisée après une mise sous tension. Après un
+// reset en cours de cycle, les lots acquittés mais pas encore écrits sont
+// reportés au prochain cycle (avant toute nouvelle acquisition).
+void recoverPendingBatches() {
+    if (pendingBatches.magic != PENDING_MAGIC) {
+        memset(&pendingBatches, 0, sizeof(pendingBatches));
+        memset(deferredFlush, 0, sizeof(deferredFlush));
+        pendingBatches.magic = PENDING_MAGIC;
+        return;
+    }
+    
+    for (int i = 0; i < MAX_SLAVES; i++) {
+        if (pendingBatches.count[i] == 0) continue;
+        
+        DEBUG_PRINT("[SD] Recovering unsaved batch for board ");
+        DEBUG_PRINT(i + 1);
+        DEBUG_PRINT(", records: ");
+        DEBUG_PRINTLN(pendingBatches.count[i]);
+        slavesData[i].boardId = i + 1;
+        slavesData[i].received = true;
+        deferSlaveData(i);
+        slavesData[i].received = false;
+    }
+}
+
+void saveDataToSD(uint32_t deadline) {
+    DEBUG_PRINTLN("[SD] Saving to SD card...");
+    
+    // Écritures reportées des cycles précédents d'abord (ordre chronologique)
+    for (int i = 0; i < MAX_SLAVES; i++) {
+        DeferredFlush& slot = deferredFlush[i];
+        if (!slot.data.received || (int32_t)(deadline - millis()) <= 0) continue;
+        
+        // En cas d'échec, le report est retenté au cycle suivant
+        const char* filename = slaveFile(slot.data.boardId);
+        if (filename != nullptr) {
+            String data = buildSlaveRows(slot.data, slot.batch, slot.batchCount, slot.reference);
+            if (!writeFile(SD, filename, data.c_str())) continue;
+            DEBUG_PRINT("[SD]    Deferred board ");
+            DEBUG_PRINT(slot.data.boardId);
+            DEBUG_PRINTLN(" saved");
+        }
+        slot.data.received = false;
+    }
+    
+    // Sauvegarder les données de chaque esclave dans son fichier respectif
+    for (int i = 0; i < MAX_SLAVES; i++) {
+        if (slavesData[i].received) {
+            // Carte SD trop lente : garder la mesure en RTC pour le prochain cycle
+            if ((int32_t)(deadline - millis()) <= 0) {
+                DEBUG_PRINT("[SD]    Budget exceeded, deferring board ");
+                DEBUG_PRINTLN(slavesData[i].boardId);
+                deferSlaveData(i);
+                continue;
+            }
+            
+            // Déterminer le fichier selon le boardId
+            const char* filename = slaveFile(slavesData[i].boardId);
+            if (filename == nullptr) {
+                DEBUG_PRINT("[SD] Unknown board ID: ");
+                DEBUG_PRINTLN(slavesData[i].boardId);
+                pendingBatches.count[i] = 0;
+                continue;
+            }
+            
+            String data = buildSlaveRows(slavesData[i], pendingBatches.records[i], pendingBatches.count[i], currentDateTime);
+            
+            // Écrire dans le fichier ; en cas d'échec, les lots déjà acquittés
+            // restent en RTC pour le prochain cycle
+            if (!writeFile(SD, filename, data.c_str())) {
+                DEBUG_PRINT("[SD]    Write failed, deferring board ");
+                DEBUG_PRINTLN(slavesData[i].boardId);
+                deferSlaveData(i);
+                continue;
+            }
+            pendingBatches.count[i] = 0;
+            
+            DEBUG_PRINT("[SD]    Board ");
+            DEBUG_PRINT(slavesData[i].boardId);
+            DEBUG_PRINTLN(" saved");
+        }
+    }
+    
+    DEBUG_PRINTLN("[SD] Save complete");
+}
+
+// ==========================================
+// ENVOI DES DONNÉES À ANDROID
+// ==========================================
+// Le flux d'export (marqueurs JSON de fichier, lignes CSV, marqueur de fin)
+// part soit directement en notifications (READ), soit dans le fichier
+// d'export envoyé ensuite en trames numérotées (EXPORT).
+
+// Lecture d'un bloc de fichier SD pour BlockReader (context : File*)
+size_t readSdBlock(void* context, uint32_t offset, uint8_t* buffer, size_t length) {
+    File* file = (File*)context;
+    if (file->position() != offset && !file->seek(offset)) return 0;
+    return file->read(buffer, length);
+}
+
+// Pause entre deux notifications, mise à profit pour charger le bloc suivant
+void notifyGap(BlockReader* reader) {
+    uint32_t start = millis();
+    if (reader) reader->prefetch();
+    uint32_t spent = millis() - start;
+    if (spent < EXPORT_FRAME_GAP_MS) delay(EXPORT_FRAME_GAP_MS - spent);
+}
+
+void flushExportPayload(ExportSink& sink) {
+    if (sink.length == 0) return;
+    pCharTX->setValue(sink.payload, sink.length);
+    notifyAndroid();
+    sink.length = 0;
+    notifyGap(sink.reader);
+}
+
+// Ajoute des octets à la notification en cours. Elle part pleine de lignes
+// entières ; seule une ligne plus longue qu'une notification est coupée.
+void sendExportBytes(ExportSink& sink, const char* data, size_t length) {
+    if (sink.spool) {
+        sink.bytes += sink.spool->write((const uint8_t*)data, length);
+        return;
+    }
+    
+    if (sink.length + length > sink.capacity) flushExportPayload(sink);
+    while (length > sink.capacity) {
+        memcpy(sink.payload, data, sink.capacity);
+        sink.length = sink.capacity;
+        flushExportPayload(sink);
+        data += sink.capacity;
+        length -= sink.capacity;
+    }
+    memcpy(sink.payload + sink.length, data, length);
+    sink.length += length;
+}
+
+// Ligne lue dans un fichier (sans '\n')
+void sendExportLine(ExportSink& sink, const char* line, size_t length) {
+    if (sink.spool) {
+        sink.bytes += sink.spool->write((const uint8_t*)line, length);
+        sink.bytes += sink.spool->write('\n');
+        return;
+    }
+    
+    // La fin de ligne reste avec sa ligne
+    if (sink.length + length + 1 > sink.capacity) flushExportPayload(sink);
+    sendExportBytes(sink, line, length);
+    sendExportBytes(sink, "\n", 1);
+}
+
+// Morceau rendu par BlockReader::nextLine : la fin de ligne ne suit que le dernier
+void sendExportPiece(ExportSink& sink, const BlockReader& reader, const char* line, size_t length) {
+    if (reader.lineContinues()) sendExportBytes(sink, line, length);
+    else sendExportLine(sink, line, length);
+}
+
+// Envoie la notification en cours puis un marqueur JSON seul
+void sendExportMarker(ExportSink& sink, const String& marker) {
+    if (sink.spool) {
+        sink.bytes += sink.spool->print(marker);
+        return;
+    }
+    
+    flushExportPayload(sink);
+    pCharTX->setValue(marker.c_str());
+    notifyAndroid();
+    notifyGap(sink.reader);
+}
+
+// Date d'une ligne lue par BlockReader (non terminée par '\0')
+bool lineTime(const char* line, size_t length, uint32_t* time) {
+    DateTime dt;
+    if (length < ISO8601_LENGTH || !parseISO8601(line, &dt)) return false;
+    *time = (uint32_t)dateTimeToEpoch(dt);
+    return true;
+}
+
+void writeExport(ExportSink& sink) {
+    // Fichiers à envoyer : le maître, puis chaque carte du schéma
+    for (int i = 0; i <= MAX_SLAVES; i++) {
+        const char* path = i == 0 ? MASTER_FILE : BOARD_SPECS[i - 1].file;
+        const char* name = i == 0 ? "master" : BOARD_SPECS[i - 1].name;
+        if (!SD.exists(path)) continue;
+        
+        File file = SD.open(path, FILE_READ);
+        if (!file) {
+            DEBUG_PRINT("[BLE] Failed to open file: ");
+            DEBUG_PRINTLN(path);
             continue;
         }
         
         // Envoyer le nom du fichier
-        String header = String("{\"file\":\"") + fileNames[i] + "\"}\n";
-        pCharTX->setValue(header.c_str());
-        pCharTX->notify();
-        delay(100);
+        sendExportMarker(sink, String("{\"file\":\"") + name + "\"}\n");
         
-        // Lire et envoyer le fichier par chunks
-        String chunk = "";
-        int lineCount = 0;
+        // Lire et envoyer le fichier par blocs : l'en-tête, puis les mesures
+        // compactées (décodées en lignes CSV), puis le reste du CSV
+        const char* line;
+        size_t length;
+        exportReader.begin(readSdBlock, &file, 0, file.size());
+        bool more = exportReader.nextLine(&line, &length);
+        if (!more) sendExportLine(sink, "", 0);       // Fichier vide : en-tête vide
+        while (more) {
+            sendExportPiece(sink, exportReader, line, length);
+            more = exportReader.lineContinues() && exportReader.nextLine(&line, &length);
+        }
+        uint32_t archivedUntil = i > 0 ? exportArchive(i, sink) : 0;
         
-        while (file.available()) {
-            String line = file.readStringUntil('\n');
-            chunk += line + "\n";
-            lineCount++;
+        sink.reader = &exportReader;
+        bool skipArchived = archivedUntil > 0;
+        bool midLine = false;           // Suite d'une ligne trop longue
+        bool dropLine = false;
+        while (exportReader.nextLine(&line, &length)) {
+            bool firstPiece = !midLine;
+            midLine = exportReader.lineContinues();
             
-            // Envoyer par paquets de 10 lignes
-            if (lineCount % 10 == 0) {
-                pCharTX->setValue(chunk.c_str());
-                pCharTX->notify();
-                chunk = "";
-                delay(100);
+            // Lignes en tête du CSV déjà présentes dans un bloc (compaction
+            // interrompue avant la recopie), jusqu'à la dernière mesure archivée
+            uint32_t time;
+            if (firstPiece) {
+                dropLine = false;
+                if (skipArchived && lineTime(line, length, &time)) {
+                    dropLine = time <= archivedUntil;
+                    if (time >= archivedUntil) skipArchived = false;
+                }
             }
+            
+            if (!dropLine) sendExportPiece(sink, exportReader, line, length);
         }
-        
-        // Envoyer le reste
-        if (chunk.length() > 0) {
-            pCharTX->setValue(chunk.c_str());
-            pCharTX->notify();
-            delay(100);
-        }
+        sink.reader = nullptr;
         
         file.close();
     }
     
-    // Signal de fin
-    pCharTX->setValue("{\"end\":true}");
-    pCharTX->notify();
+    // Signal de fin (le reste du dernier fichier part avec lui)
+    sendExportMarker(sink, "{\"end\":true}");
+}
+
+void sendDataToAndroid() {
+    DEBUG_PRINTLN("[BLE] Sending data to Android...");
+    
+    if (!pCharTX) {
+        DEBUG_PRINTLN("[BLE] TX characteristic not available");
+        return;
+    }
+    
+    ExportSink sink;
+    sink.capacity = notifyPayloadSize();
+    writeExport(sink);
     
     DEBUG_PRINTLN("[BLE] Data sent");
 }
 
+// ==========================================
+// EXPORT TRAMÉ (EXPORT, ACK, NACK, RESUME)
+// ==========================================
+// Fenêtre, retransmissions et reprise : lib/Export/export_session.h. L'état
+// du transfert est en RTC ; le fichier d'export reste sur la carte SD.
+
+// Octets d'une notification pour le MTU négocié
+uint16_t notifyPayloadSize() {
+    uint16_t mtu = pServer ? pServer->getPeerMTU(pServer->getConnId()) : 23;
+    uint16_t frame = mtu > 3 ? mtu - 3 : 20;
+    return frame > EXPORT_FRAME_MAX ? EXPORT_FRAME_MAX : frame;
+}
+
+// Octets de données par trame
+uint16_t exportPayloadSize() {
+    return notifyPayloadSize() - sizeof(ExportFrameHeader);
+}
+
+void sendExportStatus(const char* key, uint16_t value) {
+    char message[128];
+    snprintf(message, sizeof(message),
+             "{\"transfer\":%u,\"frames\":%u,\"bytes\":%lu,\"payload\":%u,\"%s\":%u}",
+             exportTransfer.lastId, exportTransfer.frames, (unsigned long)exportTransfer.bytes,
+             exportTransfer.payload, key, value);
+    sendToAndroid(message);
+}
+
+// EXPORT : écrit le fichier d'export et démarre un nouveau transfert
+void startExport() {
+    DEBUG_PRINTLN("[EXPORT] Writing export file...");
+    uint32_t start = millis();
+    
+    File spool = SD.open(EXPORT_FILE, FILE_WRITE);
+    if (!spool) {
+        sendToAndroid("{\"error\":\"export file\"}");
+        return;
+    }
+    ExportSink sink;
+    sink.spool = &spool;
+    writeExport(sink);
+    spool.close();
+    
+    if (!exportSession.start(sink.bytes, exportPayloadSize())) {
+        sendToAndroid("{\"error\":\"export too large for MTU\"}");
+        return;
+    }
+    
+    DEBUG_PRINT("[EXPORT] Transfer ");
+    DEBUG_PRINT(exportTransfer.transferId);
+    DEBUG_PRINT(": ");
+    DEBUG_PRINT(sink.bytes);
+    DEBUG_PRINT(" bytes, ");
+    DEBUG_PRINT(exportTransfer.frames);
+    DEBUG_PRINT(" frames, written in ");
+    DEBUG_PRINT(millis() - start);
+    DEBUG_PRINTLN(" ms");
+    sendExportStatus("start", 0);
+}
+
+// ACK n : toutes les trames jusqu'à n sont reçues
+void handleExportAck(const char* argument) {
+    ExportReply reply = exportSession.ack(argument);
+    if (reply == EXPORT_REPLY_INVALID) {
+        sendToAndroid("{\"error\":\"bad ack\"}");
+    } else if (reply == EXPORT_REPLY_COMPLETE) {
+        DEBUG_PRINT("[EXPORT] Transfer ");
+        DEBUG_PRINT(exportTransfer.lastId);
+        DEBUG_PRINTLN(" complete");
+        sendExportStatus("complete", exportTransfer.frames);
+    }
+}
+
+// NACK a-b,c : trames à renvoyer
+void handleExportNack(const char* argument) {
+    if (exportSession.nack(argument) != EXPORT_REPLY_OK) {
+        sendToAndroid("{\"error\":\"bad nack\"}");
+    }
+}
+
+// RESUME id seq : reprise d'un transfert à partir de la trame seq
+void handleExportResume(const char* argument) {
+    switch (exportSession.resume(argument, exportPayloadSize())) {
+        case EXPORT_REPLY_OK:
+            sendExportStatus("resume", exportTransfer.nextSeq);
+            break;
+        case EXPORT_REPLY_MTU:
+            sendToAndroid("{\"error\":\"mtu too small\"}");
+            break;
+        default:
+            sendToAndroid("{\"error\":\"unknown transfer\"}");
+            break;
+    }
+}
+
+// Notification d'une trame ; le bloc suivant du fichier est chargé pendant la pause
+void notifyExportFrame(void* context, const uint8_t* frame, size_t length, bool retransmit,
+                       BlockReader& reader) {
+    pCharTX->setValue((uint8_t*)frame, length);
+    notifyAndroid();
+    exportFramesTotal.inc();
+    if (retransmit) exportRetransmitsTotal.inc();
+    notifyGap(&reader);
+}
+
+// Appelé dans WAIT_ANDROID : quelques trames (retransmissions d'abord)
+void pumpExport() {
+    if (!androidConnected) return;
+    exportSession.pump(exportReader, EXPORT_BURST, notifyExportFrame, nullptr);
+}
+
+// ==========================================
+// PRÉVISION DE RETOURNEMENT
+// ==========================================
+// Chaque température retenue par le contrôle des mesures met à jour la
+// tendance de sa carte (lib/Forecast, état en RTC). La prévision donne le
+// nombre d'heures, depuis la dernière mesure, avant de passer sous le seuil
+// turn_temp_N : elle est lue par FORECAST ou directement dans la réponse de
+// scan, sans connexion ni synchronisation des données.
+
+// Heures avant le seuil : HOLT_NOT_FALLING (-1) si la tendance ne descend
+// pas, -2 si inconnue
+float forecastHours(uint8_t boardId) {
+    uint16_t threshold = runtimeConfig.*(TURN_TEMP_FIELDS[boardId - 1]);
+    const HoltState& state = forecasts[boardId - 1];
+    if (threshold == 0 || state.count < FORECAST_MIN_READINGS) return -2.0f;
+    return holtHoursUntilBelow(state, threshold);
+}
+
+// Une réponse par carte (chacune tient dans une notification)
+void sendForecast() {
+    for (uint8_t boardId = 1; boardId <= MAX_SLAVES; boardId++) {
+        const HoltState& state = forecasts[boardId - 1];
+        uint16_t threshold = runtimeConfig.*(TURN_TEMP_FIELDS[boardId - 1]);
+        float hours = forecastHours(boardId);
+        char message[160];
+        
+        if (state.count < FORECAST_MIN_READINGS) {
+            snprintf(message, sizeof(message), "{\"forecast\":%u,\"readings\":%u,\"threshold\":%u}",
+                     boardId, state.count, threshold);
+        } else {
+            int length = snprintf(message, sizeof(message),
+                                  "{\"forecast\":%u,\"temp\":%.2f,\"trend_h\":%.3f,\"threshold\":%u",
+                                  boardId, state.level, state.trend, threshold);
+            if (hours >= 0.0f) {
+                // Date prévue du passage sous le seuil
+                char eta[ISO8601_LENGTH + 1];
+                formatISO8601(eta, epochToDateTime(state.lastTime + (uint32_t)(hours * 3600.0f)));
+                snprintf(message + length, sizeof(message) - length, ",\"hours\":%.1f,\"eta\":\"%s\"}",
+                         hours, eta);
+            } else {
+                snprintf(message + length, sizeof(message) - length, ",\"hours\":null}");
+            }
+        }
+        sendToAndroid(message);
+    }
+}
+
+// Données constructeur de la réponse de scan, avec le nom :
+//   id (0xFFFF) | version | par carte : température (°C, int8) + heures (uint16)
+// Température INT8_MIN et heures FORECAST_HOURS_UNKNOWN : pas de prévision.
+void setForecastAdvert() {
+    uint8_t payload[3 + 3 * MAX_SLAVES];
+    payload[0] = FORECAST_COMPANY_ID & 0xFF;
+    payload[1] = FORECAST_COMPANY_ID >> 8;
+    payload[2] = FORECAST_ADV_VERSION;
+    
+    for (uint8_t boardId = 1; boardId <= MAX_SLAVES; boardId++) {
+        const HoltState& state = forecasts[boardId - 1];
+        float hours = forecastHours(boardId);
+        int8_t temperature = INT8_MIN;
+        uint16_t value = FORECAST_HOURS_UNKNOWN;
+        if (hours > -2.0f) {
+            temperature = (int8_t)constrain(lroundf(state.level), -127, 127);
+            value = hours < 0.0f ? FORECAST_HOURS_NONE
+                                 : (uint16_t)min(lroundf(hours), (long)FORECAST_HOURS_UNKNOWN - 1);
+        }
+        uint8_t* entry = payload + 3 + 3 * (boardId - 1);
+        entry[0] = (uint8_t)temperature;
+        entry[1] = value & 0xFF;
+        entry[2] = value >> 8;
+    }
+    
+    BLEAdvertisementData scanResponse;
+    scanResponse.setName("Compost_Master");
+    scanResponse.setManufacturerData(std::string((const char*)payload, sizeof(payload)));
+    BLEDevice::getAdvertising()->setScanResponseData(scanResponse);
+}
+
 // ==========================================
 // EFFACER LES DONNÉES SD
 // ==========================================
 void clearSDData() {
     DEBUG_PRINTLN("[SD] Clearing data...");
     resetCarteSD(SD);
+    memset(&compaction, 0, sizeof(compaction));
+    memset(&retention, 0, sizeof(retention));
+    retentionCheckedDay = 0;
+    exportSession.cancel();
     DEBUG_PRINTLN("[SD] Data cleared");
     
     if (pCharTX) {
         pCharTX->setValue("{\"status\":\"cleared\"}");
-        pCharTX->notify();
+        notifyAndroid();
+    }
+}
+
+// ==========================================
+// COMPACTION DES MESURES ANCIENNES
+// ==========================================
+// Lignes anciennes des CSV de carte -> blocs mensuels (lib/Gorilla/compaction.h).
+// L'état du travail est en RTC ; une copie .tmp interrompue est renommée au démarrage.
+uint32_t clockMs() {
+    return millis();
+}
+
+// Avance la compaction jusqu'à deadline (une carte au plus par cycle)
+void compactOldRecords(uint32_t deadline) {
+    if (SD.cardType() == CARD_NONE) return;
+    
+    CompactionReport report;
+    uint32_t now = (uint32_t)dateTimeToEpoch(currentDateTime);
+    runCompaction(sdStorage, compaction, &compactionNextBoard, now, deadline, clockMs,
+                  archiveScratch, &report);
+    
+    archivedRecordsTotal.inc(report.records);
+    archiveBytesTotal.inc(report.blockBytes);
+    sdBytesTotal.inc(report.blockBytes + report.indexBytes);
+    if (report.writeFailed) sdWriteErrorsTotal.inc();
+    
+    if (report.blocks > 0) {
+        DEBUG_PRINT("[COMPACT] Board ");
+        DEBUG_PRINT(compaction.boardId);
+        DEBUG_PRINT(": ");
+        DEBUG_PRINT(report.records);
+        DEBUG_PRINT(" rows -> ");
+        DEBUG_PRINT(report.blockBytes);
+        DEBUG_PRINT(" bytes in ");
+        DEBUG_PRINT(report.blocks);
+        DEBUG_PRINTLN(" blocks");
+    }
+    if (report.skippedLines > 0) {
+        DEBUG_PRINT("[COMPACT] Skipped unreadable lines: ");
+        DEBUG_PRINTLN(report.skippedLines);
+    }
+    if (report.writeFailed) {
+        DEBUG_PRINT("[COMPACT] Write failed for board ");
+        DEBUG_PRINTLN(compaction.boardId);
+    }
+    if (report.compacted) {
+        DEBUG_PRINT("[COMPACT] Board ");
+        DEBUG_PRINT(compaction.boardId);
+        DEBUG_PRINTLN(" compacted");
+    }
+}
+
+// Décode les blocs d'un mois (index + données), true si les fichiers existent
+bool exportRawPeriod(uint8_t boardId, uint32_t period, ExportSink& sink, uint32_t* lastTime) {
+    ArchivePeriod archive;
+    if (!archive.open(sdStorage, boardId, period, archiveScratch.block)) return false;
+    
+    uint8_t channels = boardFieldCount(boardId);
+    ArchiveIndexEntry entry;
+    GorillaDecoder decoder;
+    ArchiveBlockStatus status;
+    for (uint32_t index = 0; (status = archive.read(index, &entry, &decoder)) != ARCHIVE_BLOCK_END; index++) {
+        if (status == ARCHIVE_BLOCK_CORRUPT) {
+            DEBUG_PRINT("[COMPACT] Skipping corrupt block at ");
+            DEBUG_PRINTLN(entry.offset);
+            continue;
+        }
+        
+        bool hasQuality = entry.header.channels > channels;
+        uint32_t time;
+        int32_t values[GORILLA_MAX_CHANNELS];
+        while (decoder.next(&time, values)) {
+            if (rolledUp(retention, boardId, TIER_RAW, period, time)) continue;
+            char row[CSV_ROW_MAX];
+            size_t length = formatArchiveRow(row, sizeof(row), boardId, time, values,
+                                             hasQuality ? values[channels] : -1);
+            if (length > 0) sendExportLine(sink, row, length - 1);
+        }
+        *lastTime = entry.header.lastTime;
+    }
+    
+    archive.close();
+    return true;
+}
+
+// Recopie les lignes d'un fichier agrégé (sans son en-tête)
+void exportTierFile(uint8_t boardId, RetentionTier tier, uint32_t period, ExportSink& sink) {
+    char path[32];
+    tierPath(path, sizeof(path), boardId, tier, period, ".csv");
+    File file = SD.open(path, FILE_READ);
+    if (!file) return;
+    
+    const char* line;
+    size_t length;
+    archiveScratch.reader.begin(readSdBlock, &file, 0, file.size());
+    while (archiveScratch.reader.nextLine(&line, &length) && archiveScratch.reader.lineContinues()) {}  // En-tête
+    sink.reader = &archiveScratch.reader;
+    bool midLine = false;               // Suite d'une ligne trop longue
+    bool dropLine = false;
+    while (archiveScratch.reader.nextLine(&line, &length)) {
+        bool firstPiece = !midLine;
+        midLine = archiveScratch.reader.lineContinues();
+        
+        uint32_t time;
+        if (firstPiece) {
+            dropLine = length == 0 ||
+                       (tier == TIER_HOURLY && lineTime(line, length, &time) && rolledUp(retention, boardId, tier, period, time));
+        }
+        if (!dropLine) sendExportPiece(sink, archiveScratch.reader, line, length);
+    }
+    sink.reader = nullptr;
+    file.close();
+}
+
+// Mesures d'une carte hors du CSV, de la plus ancienne à la plus récente :
+// moyennes journalières, moyennes horaires puis blocs compactés décodés.
+// Retourne l'horodatage de la dernière mesure compactée (0 si aucune).
+uint32_t exportArchive(uint8_t boardId, ExportSink& sink) {
+    uint32_t periods[RETENTION_MAX_PERIODS];
+    
+    for (int tier = TIER_DAILY; tier >= TIER_HOURLY; tier--) {
+        int count = listTierPeriods(sdStorage, boardId, (RetentionTier)tier, ".csv", periods, RETENTION_MAX_PERIODS);
+        for (int p = 0; p < count; p++) {
+            exportTierFile(boardId, (RetentionTier)tier, periods[p], sink);
+        }
+    }
+    
+    uint32_t lastTime = 0;
+    int count = listTierPeriods(sdStorage, boardId, TIER_RAW, ".idx", periods, RETENTION_MAX_PERIODS);
+    for (int p = 0; p < count; p++) {
+        exportRawPeriod(boardId, periods[p], sink, &lastTime);
+    }
+    return lastTime;
+}
+
+// ==========================================
+// RÉTENTION PAR NIVEAUX
+// ==========================================
+// Fichiers expirés agrégés vers le niveau suivant (lib/Retention/rollup.h).
+// L'agrégation en cours est en RTC ; l'examen des fichiers a lieu une fois par jour.
+// Avance la rétention jusqu'à deadline. Sans travail en cours, les fichiers
+// ne sont examinés qu'une fois par jour.
+void rollupExpiredFiles(uint32_t deadline) {
+    if (SD.cardType() == CARD_NONE) return;
+    
+    RetentionHorizons keepDays;
+    for (int b = 0; b < MAX_SLAVES; b++) {
+        for (int t = 0; t < TIER_COUNT; t++) {
+            keepDays[b][t] = runtimeConfig.*(RETENTION_FIELDS[b][t]);
+        }
+    }
+    
+    RetentionReport report;
+    uint32_t now = (uint32_t)dateTimeToEpoch(currentDateTime);
+    runRetention(sdStorage, retention, &retentionCheckedDay, energyDayKey(currentDateTime), keepDays,
+                 now, deadline, clockMs, archiveScratch, &report);
+    
+    retentionRollupsTotal.inc(report.rollups);
+    sdBytesTotal.inc(report.bytes);
+    if (report.writeFailed) sdWriteErrorsTotal.inc();
+    
+    if (report.dropped > 0) {
+        DEBUG_PRINT("[RETENTION] Dropped expired daily files: ");
+        DEBUG_PRINTLN(report.dropped);
+    }
+    if (report.rows > 0 || report.rollups > 0) {
+        DEBUG_PRINT("[RETENTION] ");
+        DEBUG_PRINT(report.rows);
+        DEBUG_PRINT(" rows written, ");
+        DEBUG_PRINT(report.rollups);
+        DEBUG_PRINTLN(" files rolled up");
+    }
+    if (report.corruptBlocks > 0) {
+        DEBUG_PRINT("[RETENTION] Skipped corrupt blocks: ");
+        DEBUG_PRINTLN(report.corruptBlocks);
+    }
+    if (report.writeFailed) {
+        DEBUG_PRINTLN("[RETENTION] Write failed, rollup abandoned");
+    }
+    if (retention.boardId != 0) {
+        DEBUG_PRINT("[RETENTION] Board ");
+        DEBUG_PRINT(retention.boardId);
+        DEBUG_PRINT(": rolling ");
+        DEBUG_PRINT(TIER_PREFIX[retention.source]);
+        DEBUG_PRINT(retention.period);
+        DEBUG_PRINTLN(" (continues next cycle)");
     }
 }
 
@@ -551,21 +2007,30 @@ void readFile(fs::FS &fs, const char * path) {
     DEBUG_PRINTLN("[SD] [ End reading ]");
 }
 
-void writeFile(fs::FS &fs, const char * path, const char * message) {
+bool writeFile(fs::FS &fs, const char * path, const char * message) {
     DEBUG_PRINT("[SD] Appending to file: ");
     DEBUG_PRINTLN(path);
 
     File file = fs.open(path, FILE_APPEND);
     if(!file) {
+        sdWriteErrorsTotal.inc();
         DEBUG_PRINTLN("[SD] Failed to open file for appending");
-        return;
+        return false;
+    }
+    size_t length = strlen(message);
+    size_t written = file.print(message);
+    if(written) {
+        sdBytesTotal.inc(written);
     }
-    if(file.print(message)) {
+    bool ok = written == length;
+    if(ok) {
         DEBUG_PRINTLN("[SD] Message appended");
     } else {
+        sdWriteErrorsTotal.inc();
         DEBUG_PRINTLN("[SD] Append failed");
     }
     file.close();
+    return ok;
 }
 
 void deleteRecursive(fs::FS &fs, const char * path) {
@@ -616,55 +2081,11 @@ void resetCarteSD(fs::FS &fs) {
     initCSVFiles();
 }
 
-// ==========================================
-// FORMATER DATE EN ISO 8601
-// ==========================================
-void formatISO8601(char* buffer, DateTime dt) {
-    sprintf(buffer, "%04d-%02d-%02dT%02d:%02d:%02d",
-        dt.year, dt.month, dt.day,
-        dt.hour, dt.minute, dt.second);
-}
-
 // ==========================================
 // INCRÉMENTER LA DATE
 // ==========================================
 void incrementDateTime(int seconds) {
-    currentDateTime.second += seconds;
-    
-    // Gestion des dépassements
-    while (currentDateTime.second >= 60) {
-        currentDateTime.second -= 60;
-        currentDateTime.minute++;
-    }
-    
-    while (currentDateTime.minute >= 60) {
-        currentDateTime.minute -= 60;
-        currentDateTime.hour++;
-    }
-    
-    while (currentDateTime.hour >= 24) {
-        currentDateTime.hour -= 24;
-        currentDateTime.day++;
-    }
-    
-    // Gestion simplifiée des jours par mois (peut être amélioré)
-    int daysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
-    
-    // Année bissextile
-    if ((currentDateTime.year % 4 == 0 && currentDateTime.year % 100 != 0) || 
-        (currentDateTime.year % 400 == 0)) {
-        daysInMonth[1] = 29;
-    }
-    
-    while (currentDateTime.day > daysInMonth[currentDateTime.month - 1]) {
-        currentDateTime.day -= daysInMonth[currentDateTime.month - 1];
-        currentDateTime.month++;
-        
-        if (currentDateTime.month > 12) {
-            currentDateTime.month = 1;
-            currentDateTime.year++;
-        }
-    }
+    advanceDateTime(currentDateTime, seconds);
 }
 
 // ==========================================
@@ -696,19 +2117,12 @@ bool loadDateTime() {
     String dateStr = file.readStringUntil('\n');
     file.close();
     
-    if (dateStr.length() < 19) {
+    // Parser la date
+    if (dateStr.length() < ISO8601_LENGTH || !parseISO8601(dateStr.c_str(), &currentDateTime)) {
         DEBUG_PRINTLN("[SD] Invalid datetime format");
         return false;
     }
     
-    // Parser la date
-    currentDateTime.year = dateStr.substring(0, 4).toInt();
-    currentDateTime.month = dateStr.substring(5, 7).toInt();
-    currentDateTime.day = dateStr.substring(8, 10).toInt();
-    currentDateTime.hour = dateStr.substring(11, 13).toInt();
-    currentDateTime.minute = dateStr.substring(14, 16).toInt();
-    currentDateTime.second = dateStr.substring(17, 19).toInt();
-    
     DEBUG_PRINT("[SD] Loaded datetime: ");
     DEBUG_PRINTLN(dateStr);
     
@@ -736,25 +2150,111 @@ void saveDateTime() {
     DEBUG_PRINTLN(buffer);
 }
 
+// ==========================================
+// FENÊTRE DE SYNCHRONISATION ANDROID
+// ==========================================
+// Vrai si le réveil courant doit ouvrir une fenêtre pour le téléphone :
+// premier réveil de chaque période ANDROID_SYNC_PERIOD_MINUTES, ou premier
+// réveil d'une heure présente dans ANDROID_SYNC_HOURS_MASK. Suspendu quand la
+// batterie est en mode critical ou survival.
+bool isAndroidSyncWindow(const DateTime& dt) {
+    if (!POWER_PROFILES[batteryState.mode].androidWindows) return false;
+    return syncWindowDue(dt, runtimeConfig.syncPeriodMinutes,
+                         effectiveSleepMinutes(), ANDROID_SYNC_HOURS_MASK);
+}
+
+void startAndroidAdvertising() {
+    DEBUG_PRINTLN("[BLE] Starting fast advertising for Android...");
+    BLEAdvertising *pAdvertising = BLEDevice::getAdvertising();
+    pAdvertising->setMinInterval(ANDROID_ADV_FAST_MIN_INTERVAL);
+    pAdvertising->setMaxInterval(ANDROID_ADV_FAST_MAX_INTERVAL);
+    setForecastAdvert();
+    syncWindowOpen = true;
+    BLEDevice::startAdvertising();
+}
+
+void stopAndroidAdvertising() {
+    syncWindowOpen = false;
+    BLEDevice::stopAdvertising();
+    DEBUG_PRINTLN("[BLE] Android advertising stopped");
+}
+
 // ==========================================
 // DÉMARRER LE SCAN BLE
 // ==========================================
 void startScan() {
     DEBUG_PRINTLN("[BLE] Starting BLE scan...");
+    scansTotal.inc();
     DEBUG_PRINT("[BLE] Scan duration: ");
-    DEBUG_PRINT(BLE_SCAN_TIME);
+    DEBUG_PRINT(effectiveScanSeconds());
     DEBUG_PRINTLN(" seconds");
     
     // Réinitialiser
     for (int i = 0; i < MAX_SLAVES; i++) {
         slavesData[i].received = false;
+        pendingBatches.count[i] = 0;
     }
     foundSlaveCount = 0;
-    scanInProgress = true;
+    memset(&scanStats, 0, sizeof(scanStats));
     allSlavesScanned = false;
+    xEventGroupClearBits(bleEvents, EVT_SCAN_DONE);
     
-    // Lancer le scan en mode non-bloquant
-    pBLEScan->start(BLE_SCAN_TIME, false);
+    // Tous les slaves connus : liste d'acceptation dans le contrôleur, sauf
+    // lors du scan ouvert périodique (remplacement d'une carte)
+    int knownCount = 0;
+    for (int i = 0; i < MAX_SLAVES; i++) {
+        if (knownSlaves[i].known) knownCount++;
+    }
+    bool useAcceptList = (knownCount == MAX_SLAVES) && (scanCycle % DISCOVERY_SCAN_EVERY != 0);
+    scanCycle++;
+    
+    esp_ble_gap_clear_whitelist();
+    if (useAcceptList) {
+        for (int i = 0; i < MAX_SLAVES; i++) {
+            esp_ble_gap_update_whitelist(true, knownSlaves[i].address,
+                                         (esp_ble_wl_addr_type_t)knownSlaves[i].addressType);
+        }
+    }
+    
+    // Scan passif si l'advert suffit (adresses connues), actif sinon pour obtenir le nom
+    bool active = (BLE_SCAN_MODE == 1) || (BLE_SCAN_MODE == 2 && knownCount < MAX_SLAVES);
+    
+    esp_ble_scan_params_t scanParams = {};
+    scanParams.scan_type = active ? BLE_SCAN_TYPE_ACTIVE : BLE_SCAN_TYPE_PASSIVE;
+    scanParams.own_addr_type = BLE_ADDR_TYPE_PUBLIC;
+    scanParams.scan_filter_policy = useAcceptList ? BLE_SCAN_FILTER_ALLOW_ONLY_WLST : BLE_SCAN_FILTER_ALLOW_ALL;
+    scanParams.scan_interval = runtimeConfig.scanIntervalMs * 1000UL / 625;   // Unités de 0.625 ms
+    scanParams.scan_window = runtimeConfig.scanWindowMs * 1000UL / 625;
+    scanParams.scan_duplicate = BLE_SCAN_DUPLICATE_ENABLE;
+    
+    DEBUG_PRINT("[BLE] Scan mode: ");
+    DEBUG_PRINT(active ? "active" : "passive");
+    DEBUG_PRINTLN(useAcceptList ? ", accept list" : ", open");
+    
+    // Lancement non bloquant : scanGapHandler() démarre le scan une fois
+    // les paramètres appliqués, puis signale la fin via EVT_SCAN_DONE
+    scanInProgress = true;
+    if (esp_ble_gap_set_scan_params(&scanParams) != ESP_OK) {
+        DEBUG_PRINTLN("[BLE] Failed to set scan parameters");
+        scanInProgress = false;
+        xEventGroupSetBits(bleEvents, EVT_SCAN_DONE);
+    }
+}
+
+// Taux de succès du scan (rapports utiles / rapports reçus)
+void printScanStats() {
+    scanAdvertsTotal.inc(scanStats.adverts);
+    scanMatchedTotal.inc(scanStats.matched);
+    
+    DEBUG_PRINT("[BLE] Scan stats: adverts=");
+    DEBUG_PRINT(scanStats.adverts);
+    DEBUG_PRINT(" matched=");
+    DEBUG_PRINT(scanStats.matched);
+    DEBUG_PRINT(" unnamed=");
+    DEBUG_PRINT(scanStats.unnamed);
+    DEBUG_PRINT(" hit-rate=");
+    DEBUG_PRINT(scanStats.adverts ? (100.0 * scanStats.matched / scanStats.adverts) : 0.0);
+    DEBUG_PRINTLN("%");
 }
 
 // ==========================================
@@ -762,6 +2262,13 @@ void startScan() {
 // ==========================================
 bool processSlave() {
     static int FIFO_Lecture = 0;
+    
+    // Aucun slave trouvé pendant le scan
+    if (foundSlaveCount == 0) {
+        allSlavesScanned = true;
+        return true;
+    }
+    
     // Traiter le prochain slave
     if (FIFO_Lecture < foundSlaveCount) {
         DEBUG_PRINT("[BLE] Processing slave ");
@@ -769,18 +2276,14 @@ bool processSlave() {
         DEBUG_PRINT("/");
         DEBUG_PRINTLN(foundSlaveCount);
         
-        BLEAddress adresse = foundSlaves[FIFO_Lecture];
-        String nom = slaveNames[FIFO_Lecture];
-        
         // Se connecter et lire les données
-        connectAndReadSlave(adresse, nom.c_str());
+        acquireSlave(foundSlaves[FIFO_Lecture]);
         
         FIFO_Lecture++;
         
         // Tous les slaves traités?
         if (FIFO_Lecture >= foundSlaveCount) {
             FIFO_Lecture = 0;
-            pBLEScan->clearResults();
             allSlavesScanned = true;
             return true;
         }
@@ -789,6 +2292,131 @@ bool processSlave() {
     return false;
 }
 
+// ==========================================
+// ACQUISITION CONCURRENTE DES ESCLAVES
+// ==========================================
+// Une tâche par slave, au plus ACQUISITION_CONCURRENCY connexions ouvertes.
+// Les tâches publient leurs résultats sous acquisitionMutex. À la fin du
+// budget, l'acquisition est close : une tâche encore en cours (tentative
+// bloquée dans la pile BLE) abandonne et ses résultats tardifs sont ignorés,
+// PROCESS_DATA lit des tableaux qui ne changent plus.
+bool lockAcquisition() {
+    xSemaphoreTake(acquisitionMutex, portMAX_DELAY);
+    if (acquisitionOpen) return true;
+    xSemaphoreGive(acquisitionMutex);
+    return false;
+}
+
+void unlockAcquisition() {
+    xSemaphoreGive(acquisitionMutex);
+}
+
+void acquisitionTask(void* param) {
+    const FoundSlave* slave = (const FoundSlave*)param;
+    acquireSlave(*slave);
+    
+    UBaseType_t stackFree = uxTaskGetStackHighWaterMark(NULL);
+    if (stackFree < acquireStackFree) acquireStackFree = stackFree;
+    
+    xSemaphoreGive(connectionSlots);
+    xSemaphoreGive(acquisitionDone);
+    vTaskDelete(NULL);
+}
+
+void acquireSlavesConcurrently() {
+    int started = 0;
+    bool overrun = false;
+    
+    xSemaphoreTake(acquisitionMutex, portMAX_DELAY);
+    acquisitionOpen = true;
+    xSemaphoreGive(acquisitionMutex);
+    
+    for (int i = 0; i < foundSlaveCount; i++) {
+        // Attendre une connexion libre, au plus jusqu'à la fin du budget
+        int32_t wait = (int32_t)(acquisitionDeadline - millis());
+        if (wait < 0 || xSemaphoreTake(connectionSlots, pdMS_TO_TICKS(wait)) != pdTRUE) {
+            DEBUG_PRINTLN("[BLE] Acquisition budget exhausted, remaining slaves not started");
+            overrun = true;
+            break;
+        }
+        
+        DEBUG_PRINT("[BLE] Starting acquisition of slave ");
+        DEBUG_PRINT(i + 1);
+        DEBUG_PRINT("/");
+        DEBUG_PRINTLN(foundSlaveCount);
+        
+        if (xTaskCreate(acquisitionTask, "acquire", ACQUISITION_TASK_STACK,
+                        (void*)&foundSlaves[i], 1, NULL) == pdPASS) {
+            started++;
+        } else {
+            // Pas assez de mémoire pour une tâche : lecture dans la tâche courante
+            xSemaphoreGive(connectionSlots);
+            acquireSlave(foundSlaves[i]);
+        }
+    }
+    
+    // Attendre la fin de toutes les tâches lancées, au plus jusqu'à la fin du
+    // budget d'acquisition (une tentative en cours ne dépasse pas son timeout)
+    for (int i = 0; i < started; i++) {
+        int32_t remaining = (int32_t)(acquisitionDeadline - millis()) + CONNECT_TIMEOUT_MAX_MS;
+        if (remaining <= 0 ||
+            xSemaphoreTake(acquisitionDone, pdMS_TO_TICKS(remaining)) != pdTRUE) {
+            DEBUG_PRINTLN("[BLE] Acquisition budget exceeded, remaining slaves skipped");
+            overrun = true;
+            break;
+        }
+    }
+    
+    // Plus aucune écriture des tâches restantes dans les résultats du cycle
+    xSemaphoreTake(acquisitionMutex, portMAX_DELAY);
+    acquisitionOpen = false;
+    xSemaphoreGive(acquisitionMutex);
+    
+    if (overrun) budgetCounters.stateOverruns[SCAN_SLAVES]++;
+    allSlavesScanned = true;
+}
+
+// ==========================================
+// BACKEND BLE DU TRANSPORT ESCLAVES
+// ==========================================
+// Chemin historique : le scan (SCAN_START) remplit foundSlaves, puis une
+// connexion GATT par slave lit le lot et l'acquitte.
+class BleSlaveTransport : public SlaveTransport {
+public:
+    const char* name() const override { return "BLE"; }
+    bool begin() override { return true; }  // Pile initialisée par init_BLE()
+    bool needsDiscovery() const override { return true; }
+    
+    int acquire(uint32_t deadlineMs, int expected, BatchHandler handler, void* context) override {
+        batchSink = handler;
+        batchSinkContext = context;
+        acquisitionDeadline = deadlineMs;
+        
+        if (ACQUISITION_CONCURRENCY > 1) {
+            // Connexions simultanées, résultats fusionnés dans slavesData
+            acquireSlavesConcurrently();
+        } else {
+            // Un slave à la fois
+            while (!processSlave()) {
+            }
+        }
+        
+        int received = 0;
+        for (int i = 0; i < MAX_SLAVES; i++) {
+            if (slavesData[i].received) received++;
+        }
+        return received;
+    }
+};
+
+// Consignes transmises aux slaves dans les acquittements. Le sommeil est la
+// consigne brute : chaque slave l'ajuste à sa propre batterie (une seule fois).
+void updateTransportSchedule() {
+    if (slaveTransport == nullptr) return;
+    SlaveSchedule schedule = {runtimeConfig.sleepMinutes, runtimeConfig.advertiseSeconds};
+    slaveTransport->setSchedule(schedule);
+}
+
 // ==========================================
 // INITIALISATION BLE (MAÎTRE)
 // ==========================================
@@ -796,14 +2424,13 @@ void init_BLE() {
     DEBUG_PRINTLN("[BLE] Initializing BLE Master...");
     
     BLEDevice::init("Compost_Master");
+    BLEDevice::setMTU(EXPORT_LOCAL_MTU);
     
-    // Créer le scanner pour trouver les esclaves
-    DEBUG_PRINTLN("[BLE] Creating scanner...");
-    pBLEScan = BLEDevice::getScan();
-    pBLEScan->setAdvertisedDeviceCallbacks(new AdvertisedDeviceCallbacks());
-    pBLEScan->setActiveScan(true);
-    pBLEScan->setInterval(100);
-    pBLEScan->setWindow(99);
+    // Scanner GAP pour trouver les esclaves
+    DEBUG_PRINTLN("[BLE] Registering scanner...");
+    BLEUUID serviceUUID = BLEUUID(SENSOR_SERVICE_UUID).to128();
+    memcpy(sensorServiceUUID, serviceUUID.getNative()->uuid.uuid128, ESP_UUID_LEN_128);
+    BLEDevice::setCustomGapHandler(scanGapHandler);
     
     // Créer le serveur pour Android
     DEBUG_PRINTLN("[BLE] Creating server for Android...");
@@ -830,16 +2457,516 @@ void init_BLE() {
     
     pService->start();
     
-    // Démarrer l'advertising pour Android
-    DEBUG_PRINTLN("[BLE] Starting advertising...");
+    // Préparer l'advertising pour Android (démarré seulement pendant la fenêtre de synchronisation)
+    DEBUG_PRINTLN("[BLE] Configuring advertising...");
     BLEAdvertising *pAdvertising = BLEDevice::getAdvertising();
     pAdvertising->addServiceUUID(ANDROID_SERVICE_UUID);
     pAdvertising->setScanResponse(true);
-    BLEDevice::startAdvertising();
+    
+    // Modem-sleep du contrôleur entre les événements radio
+#if CONFIG_BTDM_CTRL_MODEM_SLEEP
+    if (esp_bt_sleep_enable() != ESP_OK) {
+        DEBUG_PRINTLN("[BLE] Modem sleep not available");
+    }
+#endif
     
     DEBUG_PRINTLN("[BLE] BLE Master ready");
 }
 
+// ==========================================
+// GESTION D'ÉNERGIE (DFS + LIGHT SLEEP AUTOMATIQUE)
+// ==========================================
+// Les états d'attente bloquent sur bleEvents : la tâche idle peut alors
+// baisser la fréquence CPU et, si le sdkconfig le permet, passer en light sleep.
+void init_power() {
+#if CONFIG_PM_ENABLE
+    esp_pm_config_esp32_t pmConfig = {};
+    pmConfig.max_freq_mhz = CPU_MAX_FREQ_MHZ;
+    pmConfig.min_freq_mhz = CPU_MIN_FREQ_MHZ;
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    pmConfig.light_sleep_enable = true;
+#endif
+    esp_err_t err = esp_pm_configure(&pmConfig);
+    if (err != ESP_OK) {
+        DEBUG_PRINT("[POWER] esp_pm_configure failed: ");
+        DEBUG_PRINTLN(esp_err_to_name(err));
+        setCpuFrequencyMhz(CPU_MIN_FREQ_MHZ);
+    } else {
+        DEBUG_PRINTLN("[POWER] Dynamic frequency scaling enabled");
+    }
+#else
+    // Pas de gestionnaire d'énergie : fréquence fixe réduite
+    setCpuFrequencyMhz(CPU_MIN_FREQ_MHZ);
+    DEBUG_PRINTLN("[POWER] PM disabled, CPU fixed at min frequency");
+#endif
+}
+
+// ==========================================
+// CONFIGURATION D'EXÉCUTION (NVS)
+// ==========================================
+// La NVS n'est lue qu'au démarrage à froid ; les réveils de deep sleep
+// réutilisent la copie en mémoire RTC.
+void loadRuntimeConfig() {
+    if (runtimeConfig.magic == CONFIG_MAGIC) {
+        return;
+    }
+    
+    DEBUG_PRINTLN("[CONFIG] Loading configuration from NVS...");
+    Preferences prefs;
+    prefs.begin(CONFIG_NAMESPACE, true);
+    for (int i = 0; i < CONFIG_FIELD_COUNT; i++) {
+        const ConfigField& f = CONFIG_SCHEMA[i];
+        uint16_t value = prefs.getUShort(f.key, f.defaultValue);
+        if (value < f.minValue || value > f.maxValue) value = f.defaultValue;
+        runtimeConfig.*(f.field) = value;
+    }
+    prefs.end();
+    
+    // Fenêtre de scan plus grande que l'intervalle : valeurs par défaut
+    if (runtimeConfig.scanWindowMs > runtimeConfig.scanIntervalMs) {
+        runtimeConfig.scanIntervalMs = BLE_SCAN_INTERVAL_MS;
+        runtimeConfig.scanWindowMs = BLE_SCAN_WINDOW_MS;
+    }
+    
+    runtimeConfig.magic = CONFIG_MAGIC;
+    applyRuntimeConfig();
+}
+
+// Grandeurs dérivées de la configuration (et du mode d'énergie)
+void applyRuntimeConfig() {
+    SLEEP_DURATION = effectiveSleepMinutes() * 60 * 1000000ULL;
+    updateTransportSchedule();
+}
+
+void sendToAndroid(const char* message) {
+    if (pCharTX == nullptr) return;
+    pCharTX->setValue(message);
+    notifyAndroid();
+}
+
+void notifyAndroid() {
+    pCharTX->notify();
+    notificationsTotal.inc();
+}
+
+// Commandes texte reçues sur la caractéristique RX
+void handleAndroidCommand(const char* command) {
+    androidCommandsTotal.inc();
+    DEBUG_PRINT("[WAIT_ANDROID] Command: ");
+    DEBUG_PRINTLN(command);
+    
+    if (strncmp(command, "SET ", 4) == 0) {
+        handleSetCommand(command + 4);
+    } else if (strcmp(command, "GET") == 0) {
+        handleGetCommand(nullptr);
+    } else if (strncmp(command, "GET ", 4) == 0) {
+        handleGetCommand(command + 4);
+    } else if (strcmp(command, "MEM") == 0) {
+        sendMemoryStats();
+    } else if (strcmp(command, "METRICS") == 0) {
+        sendMetrics();
+    } else if (strcmp(command, "POWER") == 0) {
+        sendPowerStats();
+    } else if (strcmp(command, "FORECAST") == 0) {
+        sendForecast();
+    } else if (strcmp(command, "EXPORT") == 0) {
+        startExport();
+    } else if (strncmp(command, "ACK ", 4) == 0) {
+        handleExportAck(command + 4);
+    } else if (strncmp(command, "NACK ", 5) == 0) {
+        handleExportNack(command + 5);
+    } else if (strncmp(command, "RESUME ", 7) == 0) {
+        handleExportResume(command + 7);
+    } else {
+        sendToAndroid("{\"error\":\"unknown command\"}");
+    }
+}
+
+// SET key=value : validé par le schéma puis écrit en RTC et en NVS
+void handleSetCommand(const char* assignment) {
+    char message[96];
+    const char* equal = strchr(assignment, '=');
+    if (equal == nullptr) {
+        sendToAndroid("{\"error\":\"expected key=value\"}");
+        return;
+    }
+    
+    size_t keyLength = equal - assignment;
+    const ConfigField* f = nullptr;
+    for (int i = 0; i < CONFIG_FIELD_COUNT; i++) {
+        if (strlen(CONFIG_SCHEMA[i].key) == keyLength &&
+            strncmp(CONFIG_SCHEMA[i].key, assignment, keyLength) == 0) {
+            f = &CONFIG_SCHEMA[i];
+            break;
+        }
+    }
+    if (f == nullptr) {
+        sendToAndroid("{\"error\":\"unknown key\"}");
+        return;
+    }
+    
+    char* end;
+    long value = strtol(equal + 1, &end, 10);
+    if (end == equal + 1 || *end != '\0' || value < f->minValue || value > f->maxValue) {
+        snprintf(message, sizeof(message), "{\"error\":\"%s out of range\",\"min\":%u,\"max\":%u}",
+                 f->key, f->minValue, f->maxValue);
+        sendToAndroid(message);
+        return;
+    }
+    
+    // Contraintes entre paramètres
+    RuntimeConfig candidate = runtimeConfig;
+    candidate.*(f->field) = (uint16_t)value;
+    if (candidate.scanWindowMs > candidate.scanIntervalMs) {
+        sendToAndroid("{\"error\":\"scan_win_ms must be <= scan_int_ms\"}");
+        return;
+    }
+    
+    runtimeConfig = candidate;
+    applyRuntimeConfig();
+    
+    Preferences prefs;
+    prefs.begin(CONFIG_NAMESPACE, false);
+    prefs.putUShort(f->key, (uint16_t)value);
+    prefs.end();
+    
+    snprintf(message, sizeof(message), "{\"set\":\"%s\",\"value\":%ld}", f->key, value);
+    sendToAndroid(message);
+}
+
+// GET key : un objet JSON. GET : toutes les clés, réparties dans des objets
+// d'au plus METRICS_CHUNK octets (une notification est limitée à MTU - 3),
+// puis {"end":true}
+void handleGetCommand(const char* key) {
+    char message[METRICS_CHUNK];
+    size_t length = 0;
+    
+    for (int i = 0; i < CONFIG_FIELD_COUNT; i++) {
+        const ConfigField& f = CONFIG_SCHEMA[i];
+        if (key != nullptr && strcmp(key, f.key) != 0) continue;
+        
+        char entry[40];
+        int n = snprintf(entry, sizeof(entry), "\"%s\":%u", f.key, runtimeConfig.*(f.field));
+        if (n < 0 || (size_t)n >= sizeof(entry)) continue;
+        
+        // Séparateur, entrée et "}" final doivent tenir : sinon l'objet courant part
+        if (length > 0 && length + 1 + n + 1 >= sizeof(message)) {
+            snprintf(message + length, sizeof(message) - length, "}");
+            sendToAndroid(message);
+            delay(100);
+            length = 0;
+        }
+        length += snprintf(message + length, sizeof(message) - length, "%s%s",
+                           length == 0 ? "{" : ",", entry);
+    }
+    
+    if (key != nullptr && length == 0) {
+        sendToAndroid("{\"error\":\"unknown key\"}");
+        return;
+    }
+    
+    snprintf(message + length, sizeof(message) - length, "}");
+    sendToAndroid(message);
+    if (key == nullptr) {
+        delay(100);
+        sendToAndroid("{\"end\":true}");
+    }
+}
+
+// ==========================================
+// BATTERIE ET MODES D'ÉNERGIE
+// ==========================================
+// Mesure faite dans setup(), avant l'initialisation de la carte SD et du BLE
+// (la tension chute sous charge)
+uint16_t readBatteryMv() {
+    return batteryReadMv(analogReadMilliVolts);
+}
+
+// Sommeil et scan effectifs : configuration ajustée par le mode courant
+uint16_t effectiveSleepMinutes() {
+    return powerSleepMinutes(runtimeConfig.sleepMinutes, (PowerMode)batteryState.mode);
+}
+
+uint16_t effectiveScanSeconds() {
+    uint16_t seconds = runtimeConfig.scanSeconds * POWER_PROFILES[batteryState.mode].scanPercent / 100;
+    return seconds < 1 ? 1 : seconds;
+}
+
+// État TIME : bilan de la journée écoulée puis mode du cycle
+void updatePowerMode() {
+    EnergyLedger finished;
+    if (energyRollover(energyLedger, currentDateTime, &finished)) {
+        writeEnergyDay(finished);
+    }
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER) {
+        energyLedger.sleepMs += SLEEP_DURATION / 1000;
+    }
+    energyLedger.wakeups++;
+    
+    if (powerUpdate(batteryState, batterySampleMv)) {
+        DEBUG_PRINT("[POWER] Mode changed to ");
+        DEBUG_PRINT(POWER_PROFILES[batteryState.mode].name);
+        DEBUG_PRINT(" at ");
+        DEBUG_PRINT(batteryState.filteredMv);
+        DEBUG_PRINTLN(" mV");
+        // Sommeil du maître et consigne transmise aux esclaves
+        applyRuntimeConfig();
+    }
+    // Valeurs de clôture reportées dans le bilan de la journée
+    energyLedger.batteryMv = batteryState.filteredMv;
+    energyLedger.mode = batteryState.mode;
+    batteryMillivolts.set(batteryState.filteredMv);
+    powerModeGauge.set(batteryState.mode);
+}
+
+void accountEnergy(MasterState state, uint32_t ms) {
+    energyAdd(energyLedger, state, ms);
+}
+
+// Une ligne par carte entendue : maître (carte 0) puis esclaves du cycle
+void writePowerLog() {
+    char isoTime[ISO8601_LENGTH + 1];
+    formatISO8601(isoTime, currentDateTime);
+    char line[64];
+    
+    snprintf(line, sizeof(line), "%s;0;%u;%s;\n", isoTime, batteryState.filteredMv,
+             POWER_PROFILES[batteryState.mode].name);
+    writeFile(SD, POWER_FILE, line);
+    
+    for (int i = 0; i < MAX_SLAVES; i++) {
+        if (!slavesData[i].received || slavesData[i].batteryMv == 0) continue;
+        snprintf(line, sizeof(line), "%s;%u;%u;;\n", isoTime, slavesData[i].boardId,
+                 slavesData[i].batteryMv);
+        writeFile(SD, POWER_FILE, line);
+    }
+}
+
+void writeEnergyDay(const EnergyLedger& day) {
+    char line[160];
+    int length = snprintf(line, sizeof(line), "%04lu-%02lu-%02lu;%u;%u;%s",
+                          (unsigned long)(day.dayKey / 10000), (unsigned long)(day.dayKey / 100 % 100),
+                          (unsigned long)(day.dayKey % 100), day.wakeups, day.batteryMv,
+                          POWER_PROFILES[day.mode < POWER_MODE_COUNT ? day.mode : (uint8_t)POWER_NORMAL].name);
+    for (int i = 0; i <= BROKEN_LINK; i++) {
+        length += snprintf(line + length, sizeof(line) - length, ";%lu",
+                           (unsigned long)(day.activeMs[i] / 1000));
+    }
+    snprintf(line + length, sizeof(line) - length, ";%lu;%.1f;\n", (unsigned long)(day.sleepMs / 1000),
+             energyTotalMah(day, STATE_CURRENT_MA, BROKEN_LINK + 1, SLEEP_CURRENT_MA));
+    writeFile(SD, ENERGY_FILE, line);
+    
+    DEBUG_PRINT("[POWER] Energy for the day: ");
+    DEBUG_PRINTLN(line);
+}
+
+// Commande POWER : batterie, mode et bilan de la journée en cours
+void sendPowerStats() {
+    uint32_t awakeMs = 0;
+    for (int i = 0; i <= BROKEN_LINK; i++) {
+        awakeMs += energyLedger.activeMs[i];
+    }
+    
+    char message[200];
+    snprintf(message, sizeof(message),
+             "{\"battery\":%u,\"mode\":\"%s\",\"sleep_min\":%u,\"scan_s\":%u,"
+             "\"today\":{\"wakeups\":%u,\"awake_s\":%lu,\"sleep_s\":%lu,\"mah\":%.1f}}",
+             batteryState.filteredMv, POWER_PROFILES[batteryState.mode].name,
+             effectiveSleepMinutes(), effectiveScanSeconds(), energyLedger.wakeups,
+             (unsigned long)(awakeMs / 1000), (unsigned long)(energyLedger.sleepMs / 1000),
+             energyTotalMah(energyLedger, STATE_CURRENT_MA, BROKEN_LINK + 1, SLEEP_CURRENT_MA));
+    sendToAndroid(message);
+}
+
+// ==========================================
+// DIAGNOSTIC MÉMOIRE
+// ==========================================
+MemSample takeMemorySample() {
+    MemSample sample = {};
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, MALLOC_CAP_8BIT);
+    
+    sample.cycle = memHistory.cycles;
+    sample.minFreeHeap = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    sample.largestFreeBlock = info.largest_free_block;
+    sample.freeHeap = info.total_free_bytes;
+    sample.allocatedBlocks = info.allocated_blocks;
+    
+    for (int i = 0; i < MEM_TASK_COUNT; i++) {
+        if (strcmp(MEM_TASKS[i], "acquire") == 0) {
+            sample.stackFree[i] = (acquireStackFree == UINT16_MAX) ? 0 : acquireStackFree;
+            continue;
+        }
+        TaskHandle_t task = xTaskGetHandle(MEM_TASKS[i]);
+        sample.stackFree[i] = task ? uxTaskGetStackHighWaterMark(task) : 0;
+    }
+    return sample;
+}
+
+// Fin de cycle : fenêtre glissante en RTC et journal /diag.csv
+// (pas de journal après un dépassement de budget, la carte SD peut en être la cause)
+void recordMemorySample(bool writeLog) {
+    memHistory.cycles++;
+    MemSample sample = takeMemorySample();
+    memHistory.samples[memHistory.next] = sample;
+    memHistory.next = (memHistory.next + 1) % MEM_HISTORY;
+    if (memHistory.count < MEM_HISTORY) memHistory.count++;
+    
+    char isoTime[20];
+    formatISO8601(isoTime, currentDateTime);
+    char line[160];
+    int length = snprintf(line, sizeof(line), "%s;%lu;%lu;%lu;%lu;%lu", isoTime,
+                          (unsigned long)sample.cycle, (unsigned long)sample.minFreeHeap,
+                          (unsigned long)sample.largestFreeBlock, (unsigned long)sample.freeHeap,
+                          (unsigned long)sample.allocatedBlocks);
+    for (int i = 0; i < MEM_TASK_COUNT; i++) {
+        length += snprintf(line + length, sizeof(line) - length, ";%u", sample.stackFree[i]);
+    }
+    snprintf(line + length, sizeof(line) - length, ";\n");
+    if (writeLog) {
+        writeFile(SD, DIAG_FILE, line);
+    }
+    
+    DEBUG_PRINT("[MEM] Min free heap: ");
+    DEBUG_PRINT(sample.minFreeHeap);
+    DEBUG_PRINT("  largest block: ");
+    DEBUG_PRINT(sample.largestFreeBlock);
+    DEBUG_PRINT("  blocks: ");
+    DEBUG_PRINTLN(sample.allocatedBlocks);
+}
+
+// Commande MEM : état courant puis historique, un objet JSON par cycle
+void sendMemoryStats() {
+    char message[200];
+    
+    for (int n = -1; n < memHistory.count; n++) {
+        MemSample sample = (n < 0) ? takeMemorySample()
+            : memHistory.samples[(memHistory.next + MEM_HISTORY - memHistory.count + n) % MEM_HISTORY];
+        int length = snprintf(message, sizeof(message),
+                              "{\"%s\":%lu,\"minFree\":%lu,\"largest\":%lu,\"free\":%lu,\"blocks\":%lu,\"stacks\":{",
+                              n < 0 ? "now" : "cycle", (unsigned long)sample.cycle,
+                              (unsigned long)sample.minFreeHeap, (unsigned long)sample.largestFreeBlock,
+                              (unsigned long)sample.freeHeap, (unsigned long)sample.allocatedBlocks);
+        for (int i = 0; i < MEM_TASK_COUNT; i++) {
+            length += snprintf(message + length, sizeof(message) - length, "%s\"%s\":%u",
+                               i ? "," : "", MEM_TASKS[i], sample.stackFree[i]);
+        }
+        snprintf(message + length, sizeof(message) - length, "}}");
+        sendToAndroid(message);
+        delay(100);
+    }
+    
+    sendToAndroid("{\"end\":true}");
+}
+
+// ==========================================
+// EXPORT DES MÉTRIQUES
+// ==========================================
+// Les lignes sont regroupées dans des notifications d'au plus METRICS_CHUNK octets
+struct MetricsChunk {
+    char text[METRICS_CHUNK];
+    size_t length;
+};
+
+static void appendMetricsLine(const char* line, void* context) {
+    MetricsChunk* chunk = (MetricsChunk*)context;
+    size_t lineLength = strlen(line);
+    
+    if (chunk->length + lineLength + 1 >= sizeof(chunk->text) && chunk->length > 0) {
+        sendToAndroid(chunk->text);
+        chunk->length = 0;
+        delay(100);
+    }
+    chunk->length += snprintf(chunk->text + chunk->length, sizeof(chunk->text) - chunk->length,
+                              "%s\n", line);
+}
+
+// Commande METRICS
+void sendMetrics() {
+    MetricsChunk chunk;
+    chunk.length = 0;
+    metricsExport(appendMetricsLine, &chunk);
+    if (chunk.length > 0) {
+        sendToAndroid(chunk.text);
+        delay(100);
+    }
+    sendToAndroid("{\"end\":true}");
+}
+
+#if METRICS_SERIAL_EXPORT
+static void printMetricsLine(const char* line, void* context) {
+    Serial.println(line);
+}
+#endif
+
+// Export série en fin de cycle (indépendant de DEBUG)
+void printMetrics() {
+#if METRICS_SERIAL_EXPORT
+    metricsExport(printMetricsLine, nullptr);
+    Serial.flush();
+#endif
+}
+
+// ==========================================
+// BUDGET DE CYCLE ET WATCHDOG
+// ==========================================
+// Le watchdog des tâches borne la durée d'éveil même si un appel bloque
+// (connect(), carte SD, pile BLE) : au-delà du budget + marge, la carte
+// redémarre et le réveil suivant part directement en deep sleep.
+// Armé une seule fois, sur le pire cas des paramètres réglables par SET : la
+// boucle applique déjà CYCLE_BUDGET_MS de la configuration courante.
+uint16_t configMaxValue(uint16_t RuntimeConfig::* field) {
+    for (int i = 0; i < CONFIG_FIELD_COUNT; i++) {
+        if (CONFIG_SCHEMA[i].field == field) return CONFIG_SCHEMA[i].maxValue;
+    }
+    return 0;
+}
+
+uint32_t worstCycleBudgetMs() {
+    uint32_t scanMs = (configMaxValue(&RuntimeConfig::scanSeconds) + 2) * 1000UL;
+    uint32_t androidMs = configMaxValue(&RuntimeConfig::maxTimeouts) *
+                         configMaxValue(&RuntimeConfig::androidWaitSeconds) * 1000UL +
+                         ANDROID_TRANSFER_BUDGET_MS;
+    return TIME_BUDGET_MS + scanMs + ACQUISITION_BUDGET_MS + PROCESS_BUDGET_MS +
+           androidMs + SLEEP_BUDGET_MS;
+}
+
+void init_budget() {
+    if (budgetCounters.magic != BUDGET_MAGIC) {
+        memset(&budgetCounters, 0, sizeof(budgetCounters));
+        budgetCounters.magic = BUDGET_MAGIC;
+    }
+    
+    esp_task_wdt_init(worstCycleBudgetMs() / 1000 + WATCHDOG_MARGIN_S, true);
+    esp_task_wdt_add(NULL);
+}
+
+// Budget de chaque état (ms)
+uint32_t stateBudgetMs(MasterState state) {
+    switch (state) {
+        case TIME:          return TIME_BUDGET_MS;
+        case SCAN_START:    return SCAN_BUDGET_MS;
+        case SCAN_SLAVES:   return ACQUISITION_BUDGET_MS;
+        case PROCESS_DATA:  return PROCESS_BUDGET_MS;
+        case WAIT_ANDROID:  return ANDROID_BUDGET_MS;
+        default:            return SLEEP_BUDGET_MS;
+    }
+}
+
+void printBudgetCounters() {
+    DEBUG_PRINT("[BUDGET] Overruns per state:");
+    for (int i = 0; i <= BROKEN_LINK; i++) {
+        DEBUG_PRINT(" ");
+        DEBUG_PRINT(budgetCounters.stateOverruns[i]);
+    }
+    DEBUG_PRINTLN("");
+    DEBUG_PRINT("[BUDGET] Cycle overruns: ");
+    DEBUG_PRINT(budgetCounters.cycleOverruns);
+    DEBUG_PRINT("  watchdog resets: ");
+    DEBUG_PRINT(budgetCounters.watchdogResets);
+    DEBUG_PRINT("  deferred flushes: ");
+    DEBUG_PRINTLN(budgetCounters.deferredFlushes);
+}
+
 // ==========================================
 // SETUP
 // ==========================================
@@ -848,7 +2975,12 @@ void setup() {
     #ifdef DEBUG
         Serial.begin(SERIAL_BAUD);
         while (!Serial) ;
+    #elif METRICS_SERIAL_EXPORT
+        Serial.begin(SERIAL_BAUD);
     #endif
+    
+    // Métriques cumulées en RTC
+    metricsBegin(&metricsStorage);
 
     DEBUG_PRINTLN("Starting up...");
     DEBUG_PRINTLN("======================================");
@@ -856,22 +2988,72 @@ void setup() {
     DEBUG_PRINTLN("   MODE: MASTER");
     DEBUG_PRINTLN("======================================");
     
+    // Configuration (NVS au démarrage à froid, RTC ensuite)
+    loadRuntimeConfig();
+    
+    // Batterie mesurée avant que la carte SD et la radio ne tirent du courant
+    batterySampleMv = readBatteryMv();
+    
+    // Compteurs de dépassement et watchdog du cycle
+    init_budget();
+    
+    // Lots acquittés d'un cycle interrompu par un reset : reportés en RTC
+    recoverPendingBatches();
+    if (esp_reset_reason() == ESP_RST_TASK_WDT) {
+        budgetCounters.watchdogResets++;
+        budgetCounters.cycleOverruns++;
+        DEBUG_PRINTLN("[BUDGET] Watchdog reset: cycle skipped, going back to sleep");
+        printBudgetCounters();
+        
+        // La date n'est pas avancée ici (pas d'accès à la carte SD) : le
+        // sommeil qui commence sera ajouté par l'état TIME du prochain cycle
+        budgetCounters.skippedSleepSeconds += SLEEP_DURATION / 1000000;
+        esp_sleep_enable_timer_wakeup(SLEEP_DURATION);
+        esp_deep_sleep_start();
+    }
+    
     // Initialisation de la carte SD
     if (!initSD()) {
         DEBUG_PRINTLN("[SD] Warning: SD card not available");
         DEBUG_PRINTLN("[SD] System will continue without saving");
     }
     
+    // Événements BLE et gestion d'énergie
+    bleEvents = xEventGroupCreate();
+    commandQueue = xQueueCreate(COMMAND_QUEUE_LEN, COMMAND_MAX_LEN);
+    connectMutex = xSemaphoreCreateMutex();
+    acquisitionMutex = xSemaphoreCreateMutex();
+    acquisitionDone = xSemaphoreCreateCounting(MAX_SLAVES, 0);
+    connectionSlots = xSemaphoreCreateCounting(
+        min(ACQUISITION_CONCURRENCY, BLE_MAX_CONNECTIONS),
+        min(ACQUISITION_CONCURRENCY, BLE_MAX_CONNECTIONS));
+    init_power();
+    
     // Initialisation BLE
     init_BLE();
     
+    // Transport des mesures esclaves -> maître
+#if SLAVE_TRANSPORT == TRANSPORT_ESPNOW
+    static EspNowTransport espNowTransport(ESPNOW_CHANNEL, ESPNOW_ACK_TIMEOUT_MS, ESPNOW_MAX_ATTEMPTS);
+    slaveTransport = &espNowTransport;
+#else
+    static BleSlaveTransport bleTransport;
+    slaveTransport = &bleTransport;
+#endif
+    updateTransportSchedule();
+    if (!slaveTransport->begin()) {
+        DEBUG_PRINT("[TRANSPORT] Warning: ");
+        DEBUG_PRINT(slaveTransport->name());
+        DEBUG_PRINTLN(" init failed");
+    }
+    
     // Initialiser les structures de données
     for (int i = 0; i < MAX_SLAVES; i++) {
         slavesData[i].boardId = i + 1;
-        slavesData[i].temperature = NAN;
-        slavesData[i].pressure = NAN;
-        slavesData[i].humidity = NAN;
-        slavesData[i].oxygen = NAN;
+        for (uint8_t f = 0; f < FIELD_COUNT; f++) {
+            slavesData[i].values[f] = NAN;
+        }
+        slavesData[i].batteryMv = 0;
         strcpy(slavesData[i].isoTime, "0000-00-00T00:00:00");
         slavesData[i].received = false;
     }
@@ -885,67 +3067,173 @@ void setup() {
 void loop() {
     MasterState currentState = TIME;
     int32_t timer_start_time = millis();
+    uint32_t cycleStart = millis();
+    MasterState budgetState = currentState;
+    MasterState interruptedState = currentState;  // État abandonné pour BROKEN_LINK
+    uint32_t stateStart = cycleStart;
+    
+    // Démarrage (setup) compté avec l'état TIME
+    accountEnergy(TIME, cycleStart);
     
     while (1) {
+        // Budget de l'état courant
+        if (currentState != budgetState) {
+            accountEnergy(budgetState, millis() - stateStart);
+            budgetState = currentState;
+            stateStart = millis();
+        }
+        uint32_t stateDeadline = stateStart + stateBudgetMs(currentState);
+        
+        if (currentState != PREPARE_SLEEP && currentState != BROKEN_LINK) {
+            // Budget global dépassé : dormir immédiatement
+            if (millis() - cycleStart > CYCLE_BUDGET_MS) {
+                DEBUG_PRINTLN("[BUDGET] Cycle budget exceeded");
+                budgetCounters.cycleOverruns++;
+                interruptedState = currentState;
+                currentState = BROKEN_LINK;
+            } else if ((int32_t)(stateDeadline - millis()) < 0) {
+                // Dégradation progressive : sauter les slaves restants, puis dormir
+                DEBUG_PRINT("[BUDGET] State budget exceeded: ");
+                DEBUG_PRINTLN(currentState);
+                budgetCounters.stateOverruns[currentState]++;
+                if (currentState == SCAN_START || currentState == SCAN_SLAVES) {
+                    currentState = PROCESS_DATA;
+                } else {
+                    if (currentState == WAIT_ANDROID) stopAndroidAdvertising();
+                    currentState = PREPARE_SLEEP;
+                }
+                continue;
+            }
+        }
+        
         switch(currentState) {
             case TIME:
-                // Incrémenter la date (ajouter le temps de sleep)
-                incrementDateTime(SLEEP_TIME_MINUTES * 60);
+                // Incrémenter la date (durée du sommeil qui vient de se terminer,
+                // plus ceux des réveils écourtés par le watchdog)
+                incrementDateTime(SLEEP_DURATION / 1000000 + budgetCounters.skippedSleepSeconds);
                 DEBUG_PRINTLN("[TIME] Date/Time incremented");
                 saveDateTime();
+                budgetCounters.skippedSleepSeconds = 0;
+                pendingBatches.reference = currentDateTime;
+                
+                // Batterie : mode d'énergie du cycle, bilan journalier
+                updatePowerMode();
                 currentState = SCAN_START;
                 break;
                 
-            case SCAN_START:
+            case SCAN_START: {
                 DEBUG_PRINTLN("[SCAN_START]");
+                
+                // Transport sans connexion : les slaves émettent, pas de scan
+                if (!slaveTransport->needsDiscovery()) {
+                    acquisitionDeadline = millis() + ESPNOW_LISTEN_MS;
+                    currentState = SCAN_SLAVES;
+                    break;
+                }
+                
                 startScan();
+                
+                // Dormir jusqu'à la fin du scan (le CPU reste au repos entre les événements radio)
+                EventBits_t bits = xEventGroupWaitBits(bleEvents, EVT_SCAN_DONE, pdTRUE, pdFALSE,
+                                                       pdMS_TO_TICKS((effectiveScanSeconds() + 2) * 1000UL));
+                if (!(bits & EVT_SCAN_DONE)) {
+                    DEBUG_PRINTLN("[SCAN_START] Scan completion not signalled, stopping scan");
+                    esp_ble_gap_stop_scanning();
+                }
+                scanInProgress = false;
+                printScanStats();
+                
+                // Meilleurs liens d'abord, budget de tentatives pour le cycle
+                orderSlavesByLinkQuality();
+                acquisitionDeadline = millis() + ACQUISITION_BUDGET_MS;
+                
                 currentState = SCAN_SLAVES;
                 break;
+            }
                 
-            case SCAN_SLAVES:
-                // Traiter un slave à la fois (non-bloquant)
-                if (processSlave()) {
-                    DEBUG_PRINTLN("[SCAN_SLAVES] All slaves processed");
-                    currentState = PROCESS_DATA;
-                }
-                // yield() au lieu de delay pour économiser l'énergie
-                yield();
+            case SCAN_SLAVES: {
+                int received = slaveTransport->acquire(acquisitionDeadline, MAX_SLAVES,
+                                                       storeSlaveBatch, nullptr);
+                DEBUG_PRINT("[SCAN_SLAVES] Slaves received over ");
+                DEBUG_PRINT(slaveTransport->name());
+                DEBUG_PRINT(": ");
+                DEBUG_PRINTLN(received);
+                currentState = PROCESS_DATA;
                 break;
+            }
             
-            case PROCESS_DATA:
+            case PROCESS_DATA: {
                 DEBUG_PRINTLN("[PROCESS_DATA]");
                 
-                // Sauvegarder les données sur SD
-                saveDataToSD();
+                // Sauvegarder les données sur SD (le reste est reporté si la carte est trop lente)
+                saveDataToSD(stateDeadline - 1000);
+                writePowerLog();
+                
+                // Temps restant : compaction et rétention des mesures anciennes (reprise au cycle suivant)
+                {
+                    uint32_t compactDeadline = millis() + COMPACT_BUDGET_MS;
+                    if ((int32_t)(stateDeadline - 500 - compactDeadline) < 0) {
+                        compactDeadline = stateDeadline - 500;
+                    }
+                    compactOldRecords(compactDeadline);
+                    rollupExpiredFiles(compactDeadline);
+                }
                 
                 // Afficher un résumé
                 DEBUG_PRINTLN("[PROCESS_DATA] Summary:");
+                int heard = 0;
                 for (int i = 0; i < MAX_SLAVES; i++) {
                     if (slavesData[i].received) {
+                        heard++;
                         DEBUG_PRINT("[PROCESS_DATA]    Board ");
                         DEBUG_PRINT(slavesData[i].boardId);
-                        DEBUG_PRINT(": T=");
-                        DEBUG_PRINT(slavesData[i].temperature);
-                        DEBUG_PRINT("C  H=");
-                        DEBUG_PRINT(slavesData[i].humidity);
-                        DEBUG_PRINT("%  O2=");
-                        DEBUG_PRINT(slavesData[i].oxygen);
-                        DEBUG_PRINTLN("%");
+                        DEBUG_PRINT(":");
+                        for (uint8_t n = 0; n < boardFieldCount(i + 1); n++) {
+                            uint8_t f = boardField(i + 1, n);
+                            DEBUG_PRINT(" ");
+                            DEBUG_PRINT(FIELD_SPECS[f].label);
+                            DEBUG_PRINT("=");
+                            DEBUG_PRINT(slavesData[i].values[f]);
+                        }
+                        DEBUG_PRINTLN();
                     } else {
                         DEBUG_PRINT("[PROCESS_DATA]    Board ");
                         DEBUG_PRINT(i+1);
                         DEBUG_PRINTLN(": No data received");
                     }
                 }
+                slavesReceived.set(heard);
                 
-                // Aller directement en deep sleep
-                DEBUG_PRINTLN("[PROCESS_DATA] Data saved, going to sleep");
-                currentState = PREPARE_SLEEP;
+                // Ouvrir la fenêtre Android si elle est planifiée, sinon deep sleep
+                if (isAndroidSyncWindow(currentDateTime)) {
+                    DEBUG_PRINTLN("[PROCESS_DATA] Data saved, opening Android sync window");
+                    startAndroidAdvertising();
+                    TIMEOUT_COUNTER = 0;
+                    timer_start_time = millis();
+                    currentState = WAIT_ANDROID;
+                } else {
+                    DEBUG_PRINTLN("[PROCESS_DATA] Data saved, going to sleep");
+                    currentState = PREPARE_SLEEP;
+                }
                 break;
+            }
             
-            case WAIT_ANDROID:
+            case WAIT_ANDROID: {
+                // Bloquer jusqu'à une commande Android ou la fin du timeout courant
+                // (sans bloquer tant qu'un export a des trames à envoyer)
+                uint32_t elapsed = millis() - timer_start_time;
+                uint32_t timeoutMs = runtimeConfig.androidWaitSeconds * 1000UL;
+                if (exportSession.hasFrames() && androidConnected) {
+                    pumpExport();
+                    TIMEOUT_COUNTER = 0;
+                    timer_start_time = millis();
+                } else if (elapsed < timeoutMs) {
+                    xEventGroupWaitBits(bleEvents, EVT_ANDROID_CMD, pdTRUE, pdFALSE,
+                                        pdMS_TO_TICKS(timeoutMs - elapsed));
+                }
+                
                 // Vérifier le timeout
-                if (millis() - timer_start_time > SLEEP_DURATION / 1000) {
+                if (millis() - timer_start_time > timeoutMs) {
                     TIMEOUT_COUNTER++;
                     DEBUG_PRINT("[WAIT_ANDROID] TIMEOUT_COUNTER = ");
                     DEBUG_PRINTLN(TIMEOUT_COUNTER);
@@ -967,20 +3255,35 @@ void loop() {
                     TIMEOUT_COUNTER = 0;
                 }
                 
-                if (TIMEOUT_COUNTER >= MAX_TIMEOUT_COUNT) {
+                char command[COMMAND_MAX_LEN];
+                while (xQueueReceive(commandQueue, command, 0) == pdTRUE) {
+                    handleAndroidCommand(command);
+                    TIMEOUT_COUNTER = 0;
+                }
+                
+                if (TIMEOUT_COUNTER >= runtimeConfig.maxTimeouts) {
                     DEBUG_PRINTLN("[WAIT_ANDROID] Timeout reached, preparing sleep...");
+                    stopAndroidAdvertising();
+                    TIMEOUT_COUNTER = 0;
                     currentState = PREPARE_SLEEP;
                 }
                 break;
+            }
             
             case PREPARE_SLEEP:
                 DEBUG_PRINTLN("[PREPARE_SLEEP] Entering deep sleep...");
+                printBudgetCounters();
+                recordMemorySample(true);
+                cyclesTotal.inc();
+                cycleDuration.observe(millis());
+                printMetrics();
                 DEBUG_PRINT("[PREPARE_SLEEP] Sleep duration: ");
                 DEBUG_PRINT(SLEEP_DURATION / 1000000);
                 DEBUG_PRINTLN(" seconds");
                 
                 // Arrêter les services BLE
                 BLEDevice::deinit();
+                accountEnergy(PREPARE_SLEEP, millis() - stateStart);
                 
                 // Configurer le deep sleep
                 esp_sleep_enable_timer_wakeup(SLEEP_DURATION);
@@ -988,8 +3291,24 @@ void loop() {
                 break;
             
             case BROKEN_LINK:
-                DEBUG_PRINTLN("[BROKEN_LINK] Too many timeouts, shutting down indefinitely...");
+                // Cycle trop long : les slaves non lus sont perdus pour ce cycle,
+                // les mesures reçues mais non écrites sont reportées en RTC
+                DEBUG_PRINTLN("[BROKEN_LINK] Cycle budget exceeded, deferring data and sleeping...");
+                for (int i = 0; i < MAX_SLAVES; i++) {
+                    if (slavesData[i].received && interruptedState < PROCESS_DATA) {
+                        deferSlaveData(i);
+                    }
+                }
+                printBudgetCounters();
+                recordMemorySample(false);
+                cyclesTotal.inc();
+                cycleOverrunsTotal.inc();
+                cycleDuration.observe(millis());
+                printMetrics();
                 TIMEOUT_COUNTER = 0;
+                BLEDevice::deinit();
+                accountEnergy(BROKEN_LINK, millis() - stateStart);
+                esp_sleep_enable_timer_wakeup(SLEEP_DURATION);
                 esp_deep_sleep_start();
                 break;
             
@@ -0,0 +1,53 @@
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+// ==========================================
+// Chronométrage des phases de réveil (µs)
+// ==========================================
+// Les durées sont mémorisées pendant le réveil et affichées d'un bloc juste
+// avant le deep sleep, pour ne pas ralentir le chemin critique par des logs.
+//
+//   BootProfiler profile;
+//   sensors.beginFast();        profile.mark("sensors");
+//   BLEDevice::init(BOARD_NAME); profile.mark("ble_init");
+//   ...
+//   profile.print();
+class BootProfiler {
+public:
+    static const uint8_t MAX_PHASES = 10;
+    
+    BootProfiler() : count(0), last(esp_timer_get_time()) {}
+    
+    // Clôture la phase en cours sous le nom donné
+    void mark(const char* phase) {
+        int64_t now = esp_timer_get_time();
+        if (count < MAX_PHASES) {
+            names[count] = phase;
+            durations[count] = (uint32_t)(now - last);
+            count++;
+        }
+        last = now;
+    }
+    
+    // Temps écoulé depuis le démarrage du CPU (inclut le bootloader)
+    uint32_t sinceBoot() const { return (uint32_t)esp_timer_get_time(); }
+    
+    void print() const {
+        Serial.println("⏱  Profil de réveil (µs) :");
+        for (uint8_t i = 0; i < count; i++) {
+            Serial.printf("   %-12s %8lu\n", names[i], (unsigned long)durations[i]);
+        }
+        Serial.printf("   %-12s %8lu\n", "total", (unsigned long)sinceBoot());
+    }
+
+private:
+    const char* names[MAX_PHASES];
+    uint32_t durations[MAX_PHASES];
+    uint8_t count;
+    int64_t last;
+};
+
+#endif // BOOT_PROFILE_H
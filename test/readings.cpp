@@ -0,0 +1,131 @@
+#include "readings.h"
+#include "schedule.h"
+
+// ==========================================
+// ÉTAT PERSISTANT (conservé pendant le deep sleep)
+// ==========================================
+struct StoredReading {
+    uint16_t seq;
+    uint32_t minute;        // Horloge du tampon à la mesure
+    int16_t values[FIELD_COUNT];    // Centièmes, indexés par SensorField
+    uint16_t battery;
+};
+
+#ifdef HAS_OXYGEN_SENSOR
+static_assert(boardHasField(BOARD_ID, FIELD_OXYGEN), "capteur O2 sur une carte sans oxygène dans son schéma");
+#endif
+
+struct ReadingRing {
+    uint32_t minutes;           // Minutes dormies depuis la mise sous tension
+    uint16_t sleepMinutes;      // Durée du dernier sommeil (sleepFor())
+    uint16_t nextSeq;
+    uint16_t dropped;           // Mesures écrasées avant acquittement
+    uint8_t head;               // Index de la plus ancienne mesure
+    uint8_t count;
+    uint8_t cyclesSinceUpload;
+    StoredReading items[SLAVE_BUFFER_CAPACITY];
+};
+
+RTC_DATA_ATTR static ReadingRing ring = {};
+
+// ==========================================
+// AJOUT D'UNE MESURE
+// ==========================================
+void ReadingBuffer::push(const SensorData& data) {
+    ring.minutes += ring.sleepMinutes;
+    ring.cyclesSinceUpload++;
+    
+    if (!data.valid) return;
+    
+    // Tampon plein : la plus ancienne mesure est perdue
+    if (ring.count == SLAVE_BUFFER_CAPACITY) {
+        ring.head = (ring.head + 1) % SLAVE_BUFFER_CAPACITY;
+        ring.count--;
+        ring.dropped++;
+    }
+    
+    StoredReading& item = ring.items[(ring.head + ring.count) % SLAVE_BUFFER_CAPACITY];
+    item.seq = ring.nextSeq++;
+    item.minute = ring.minutes;
+    
+    // Champs hors du schéma de la carte (lib/Schema) : jamais transmis
+    float values[FIELD_COUNT];
+    values[FIELD_TEMPERATURE] = data.temperature;
+    values[FIELD_HUMIDITY] = data.humidity;
+    values[FIELD_OXYGEN] = (data.oxygen >= 0) ? data.oxygen : NAN;
+    for (uint8_t f = 0; f < FIELD_COUNT; f++) {
+        item.values[f] = boardHasField(BOARD_ID, (SensorField)f) ? encodeCenti(values[f]) : RECORD_NO_VALUE;
+    }
+    item.battery = data.batteryMv;
+    ring.count++;
+}
+
+bool ReadingBuffer::shouldUpload() const {
+    return uploadDue(ring.count, ring.cyclesSinceUpload);
+}
+
+// ==========================================
+// SÉRIALISATION DU LOT
+// ==========================================
+size_t ReadingBuffer::serialize(uint8_t* out, size_t maxLen) const {
+    if (maxLen < sizeof(SlaveBatchHeader)) return 0;
+    
+    size_t room = (maxLen - sizeof(SlaveBatchHeader)) / sizeof(SlaveRecord);
+    uint8_t n = ring.count;
+    if (n > room) n = room;
+    if (n > RECORD_BATCH_MAX_COUNT) n = RECORD_BATCH_MAX_COUNT;
+    
+    SlaveBatchHeader header;
+    header.version = RECORD_FORMAT_VERSION;
+    header.boardId = BOARD_ID;
+    header.count = n;
+    header.hops = 0;
+    memcpy(out, &header, sizeof(header));
+    
+    // Les plus anciennes d'abord : un lot tronqué reste acquittable par séquence
+    uint8_t* p = out + sizeof(header);
+    for (uint8_t i = 0; i < n; i++) {
+        const StoredReading& item = ring.items[(ring.head + i) % SLAVE_BUFFER_CAPACITY];
+        SlaveRecord record;
+        record.seq = item.seq;
+        record.ageMinutes = clampAgeMinutes(ring.minutes - item.minute);
+        memcpy(record.values, item.values, sizeof(record.values));
+        record.battery = item.battery;
+        memcpy(p, &record, sizeof(record));
+        p += sizeof(record);
+    }
+    
+    return p - out;
+}
+
+// ==========================================
+// ACQUITTEMENT
+// ==========================================
+void ReadingBuffer::acknowledge(uint16_t seq) {
+    while (ring.count > 0 && seqAtOrBefore(ring.items[ring.head].seq, seq)) {
+        ring.head = (ring.head + 1) % SLAVE_BUFFER_CAPACITY;
+        ring.count--;
+    }
+    ring.cyclesSinceUpload = 0;
+}
+
+// ==========================================
+// SOMMEIL
+// ==========================================
+// Chaque mesure est datée des minutes réellement dormies depuis : un
+// changement de consigne ou de mode d'énergie ne modifie pas les précédentes
+void ReadingBuffer::sleepFor(uint16_t minutes) {
+    ring.sleepMinutes = minutes;
+}
+
+uint16_t ReadingBuffer::sleptMinutes() const {
+    return ring.sleepMinutes;
+}
+
+uint8_t ReadingBuffer::count() const {
+    return ring.count;
+}
+
+uint16_t ReadingBuffer::dropped() const {
+    return ring.dropped;
+}
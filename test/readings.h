@@ -0,0 +1,43 @@
+#ifndef READINGS_H
+#define READINGS_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "records.h"
+#include "sensors.h"
+
+// ==========================================
+// Tampon circulaire des mesures en mémoire RTC (store-and-forward)
+// ==========================================
+// À chaque réveil l'esclave ajoute sa mesure avec push(). Il n'active le BLE
+// que si shouldUpload() est vrai ; le maître lit alors le lot complet
+// (serialize() sur BATCH_CHARACTERISTIC_UUID) puis écrit le dernier numéro de
+// séquence reçu sur BATCH_ACK_CHARACTERISTIC_UUID (acknowledge()).
+// Les mesures non acquittées sont renvoyées au prochain envoi. Avant le deep
+// sleep, sleepFor() indique la durée du sommeil : l'âge de chaque mesure est
+// transmis en minutes.
+class ReadingBuffer {
+public:
+    // Ajoute la mesure du réveil courant (écrase la plus ancienne si plein)
+    void push(const SensorData& data);
+    
+    // Vrai si ce réveil doit annoncer le service et envoyer le lot
+    bool shouldUpload() const;
+    
+    // Écrit l'en-tête et les enregistrements (du plus ancien au plus récent)
+    // dans out, retourne le nombre d'octets utilisés
+    size_t serialize(uint8_t* out, size_t maxLen) const;
+    
+    // Libère toutes les mesures de séquence <= seq
+    void acknowledge(uint16_t seq);
+    
+    // Durée du deep sleep qui commence (sleepMinutes() des capteurs) et
+    // durée du dernier sommeil, pour RelayBuffer::tick()
+    void sleepFor(uint16_t minutes);
+    uint16_t sleptMinutes() const;
+    
+    uint8_t count() const;
+    uint16_t dropped() const;
+};
+
+#endif // READINGS_H
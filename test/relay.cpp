@@ -0,0 +1,141 @@
+#include "relay.h"
+
+// ==========================================
+// ÉTAT PERSISTANT (conservé pendant le deep sleep)
+// ==========================================
+struct RelayedReading {
+    uint8_t originId;       // Carte qui a pris la mesure
+    uint8_t hops;           // Relais déjà traversés avant celui-ci
+    uint8_t inFlight;       // Écrite dans le dernier envoi, en attente d'acquittement
+    uint32_t minute;        // Horloge du relais à la réception
+    SlaveRecord record;     // Âge relatif à `minute`
+};
+
+struct RelayStore {
+    uint32_t minutes;       // Minutes dormies depuis la mise sous tension
+    uint16_t dropped;       // Mesures écrasées avant acquittement
+    uint8_t count;
+    RelayedReading items[RELAY_BUFFER_CAPACITY];   // Du plus ancien au plus récent
+};
+
+RTC_DATA_ATTR static RelayStore relayStore = {};
+
+// Retire l'entrée index en conservant l'ordre d'arrivée
+static void removeAt(uint8_t index) {
+    memmove(&relayStore.items[index], &relayStore.items[index + 1],
+            (relayStore.count - index - 1) * sizeof(RelayedReading));
+    relayStore.count--;
+}
+
+// ==========================================
+// RÉCEPTION D'UN LOT D'UN ESCLAVE ÉLOIGNÉ
+// ==========================================
+bool RelayBuffer::store(const SlaveBatchHeader& header, const SlaveRecord* records, void* context) {
+    (void)context;
+    
+    // Ni ses propres mesures, ni un lot qui tourne en boucle entre relais :
+    // ignorés, mais acquittés pour que l'émetteur ne les renvoie pas
+    if (header.boardId == BOARD_ID || header.hops >= RELAY_MAX_HOPS) {
+        return true;
+    }
+    
+    for (uint8_t i = 0; i < header.count; i++) {
+        // Déjà conservée (lot renvoyé après un acquittement perdu)
+        bool known = false;
+        for (uint8_t j = 0; j < relayStore.count && !known; j++) {
+            known = relayStore.items[j].originId == header.boardId &&
+                    relayStore.items[j].record.seq == records[i].seq;
+        }
+        if (known) continue;
+        
+        // Tampon plein : la plus ancienne mesure qui n'est pas en vol est perdue.
+        // Tout est en vol : lot refusé (non acquitté), l'émetteur le renverra
+        if (relayStore.count == RELAY_BUFFER_CAPACITY) {
+            uint8_t victim = 0;
+            while (victim < relayStore.count && relayStore.items[victim].inFlight) victim++;
+            if (victim == relayStore.count) return false;
+            removeAt(victim);
+            relayStore.dropped++;
+        }
+        
+        RelayedReading& item = relayStore.items[relayStore.count++];
+        item.originId = header.boardId;
+        item.hops = header.hops;
+        item.inFlight = 0;
+        item.minute = relayStore.minutes;
+        item.record = records[i];
+    }
+    
+    DEBUG_PRINT("[RELAY] Stored batch from board ");
+    DEBUG_PRINT(header.boardId);
+    DEBUG_PRINT(", records: ");
+    DEBUG_PRINTLN(header.count);
+    return true;
+}
+
+void RelayBuffer::tick(uint16_t sleptMinutes) {
+    relayStore.minutes += sleptMinutes;
+}
+
+// ==========================================
+// SÉRIALISATION DES LOTS RELAYÉS
+// ==========================================
+size_t RelayBuffer::serialize(uint8_t* out, size_t maxLen) {
+    uint8_t* p = out;
+    uint8_t* end = out + maxLen;
+    
+    for (uint8_t i = 0; i < relayStore.count; i++) {
+        relayStore.items[i].inFlight = 0;
+    }
+    
+    // Un lot par carte d'origine (première occurrence dans l'ordre d'arrivée)
+    for (uint8_t i = 0; i < relayStore.count; i++) {
+        const RelayedReading& first = relayStore.items[i];
+        if (first.inFlight) continue;
+        if ((size_t)(end - p) < sizeof(SlaveBatchHeader) + sizeof(SlaveRecord)) break;
+        
+        SlaveBatchHeader* header = (SlaveBatchHeader*)p;
+        header->version = RECORD_FORMAT_VERSION;
+        header->boardId = first.originId;
+        header->count = 0;
+        header->hops = first.hops + 1;
+        p += sizeof(SlaveBatchHeader);
+        
+        for (uint8_t j = i; j < relayStore.count; j++) {
+            RelayedReading& item = relayStore.items[j];
+            if (item.originId != first.originId || item.inFlight) continue;
+            if ((size_t)(end - p) < sizeof(SlaveRecord) || header->count == RECORD_BATCH_MAX_COUNT) break;
+            
+            // Âge ramené au réveil courant du relais
+            SlaveRecord record = item.record;
+            record.ageMinutes = clampAgeMinutes(record.ageMinutes + (relayStore.minutes - item.minute));
+            memcpy(p, &record, sizeof(record));
+            p += sizeof(record);
+            header->count++;
+            item.inFlight = 1;
+        }
+    }
+    
+    return p - out;
+}
+
+// ==========================================
+// ACQUITTEMENT
+// ==========================================
+void RelayBuffer::acknowledge() {
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < relayStore.count; i++) {
+        if (!relayStore.items[i].inFlight) {
+            relayStore.items[kept++] = relayStore.items[i];
+        }
+    }
+    relayStore.count = kept;
+}
+
+uint8_t RelayBuffer::count() const {
+    return relayStore.count;
+}
+
+uint16_t RelayBuffer::dropped() const {
+    return relayStore.dropped;
+}
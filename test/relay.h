@@ -0,0 +1,43 @@
+#ifndef RELAY_H
+#define RELAY_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "records.h"
+#include "transport.h"
+
+// ==========================================
+// Mesures relayées pour des esclaves hors de portée du maître (RTC)
+// ==========================================
+// Un esclave compilé avec -DSLAVE_RELAY écoute d'abord les esclaves éloignés
+// (SlaveTransport::acquire() avec RelayBuffer::store comme handler), puis
+// ajoute leurs lots après le sien :
+//
+//   relay.tick(buffer.sleptMinutes());
+//   transport.acquire(millis() + RELAY_LISTEN_MS, MAX_SLAVES, RelayBuffer::store, &relay);
+//   size_t used = buffer.serialize(out, sizeof(out));
+//   used += relay.serialize(out + used, sizeof(out) - used);
+//   if (transport.deliver(out, used, &ack)) { buffer.acknowledge(ack.lastSeq); relay.acknowledge(); }
+//
+// Chaque mesure garde sa carte d'origine et sa séquence : le maître élimine
+// les doublons si elle lui parvient aussi en direct.
+class RelayBuffer {
+public:
+    // Handler de transport : conserve le lot reçu d'un esclave éloigné
+    static bool store(const SlaveBatchHeader& header, const SlaveRecord* records, void* context);
+    
+    // Réveil après un sommeil de sleptMinutes : les mesures retenues vieillissent d'autant
+    void tick(uint16_t sleptMinutes);
+    
+    // Ajoute un lot par carte d'origine, retourne le nombre d'octets utilisés.
+    // Les mesures écrites sont marquées « en vol » jusqu'à acknowledge().
+    size_t serialize(uint8_t* out, size_t maxLen);
+    
+    // Le maître a acquitté l'envoi : libère les mesures en vol
+    void acknowledge();
+    
+    uint8_t count() const;
+    uint16_t dropped() const;
+};
+
+#endif // RELAY_H
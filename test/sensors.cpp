@@ -4,12 +4,24 @@
 // CONSTRUCTEUR
 // ==========================================
 CompostSensors::CompostSensors() 
-    : bmeInitialized(false), oxygenInitialized(false) {
+    : bmeInitialized(false), oxygenInitialized(false), conversionPending(false) {
 #ifdef HAS_OXYGEN_SENSOR
     oxygen = DFRobot_OxygenSensor(OXYGEN_ADDRESS);
 #endif
 }
 
+// ==========================================
+// ÉTAT DES CAPTEURS ENTRE DEUX RÉVEILS
+// ==========================================
+struct SensorBootCache {
+    bool valid;                 // Calibration disponible et BME280 sain au dernier réveil
+    bool oxygenHealthy;
+    bme280_calib_data calib;
+};
+
+RTC_DATA_ATTR static SensorBootCache bootCache = {};
+RTC_DATA_ATTR static BatteryState batteryState = {};
+
 // ==========================================
 // INITIALISATION DES CAPTEURS
 // ==========================================
@@ -31,6 +43,9 @@ bool CompostSensors::begin() {
                     Adafruit_BME280::SAMPLING_X1,  // humidity
                     Adafruit_BME280::FILTER_OFF);
     
+    bootCache.calib = bme.calibration();
+    bootCache.valid = true;
+    
     Serial.println("✓ BME280 initialisé");
     
 #ifdef HAS_OXYGEN_SENSOR
@@ -42,11 +57,126 @@ bool CompostSensors::begin() {
     } else {
         Serial.println("✓ Capteur O2 (SEN0322) initialisé");
     }
+    bootCache.oxygenHealthy = oxygenInitialized;
 #endif
     
     return bmeInitialized;
 }
 
+// ==========================================
+// INITIALISATION RAPIDE (RÉVEIL DE DEEP SLEEP)
+// ==========================================
+bool CompostSensors::beginFast() {
+    // Premier démarrage ou capteur en défaut au réveil précédent : sonde complète
+    if (!bootCache.valid) {
+        if (!begin()) return false;
+        // setSampling() en mode forcé a déjà lancé une conversion
+        conversionPending = true;
+        return true;
+    }
+    
+    Wire.begin(I2C_SDA, I2C_SCL);
+    Wire.setClock(400000);
+    
+    bmeInitialized = bme.restore(BME280_ADDRESS, &Wire, bootCache.calib);
+    if (!bmeInitialized) {
+        bootCache.valid = false;
+        return false;
+    }
+    
+    // Reprogrammer l'échantillonnage : l'écriture de ctrl_meas en mode forcé
+    // lance la conversion, le BLE peut démarrer pendant qu'elle s'effectue
+    bme.setSampling(Adafruit_BME280::MODE_FORCED,
+                    Adafruit_BME280::SAMPLING_X1,
+                    Adafruit_BME280::SAMPLING_X1,
+                    Adafruit_BME280::SAMPLING_X1,
+                    Adafruit_BME280::FILTER_OFF);
+    conversionPending = true;
+    
+#ifdef HAS_OXYGEN_SENSOR
+    // Le SEN0322 n'a pas d'initialisation coûteuse : begin() fixe l'adresse
+    // (une seule transaction I2C) ; on ne le sonde plus s'il était absent
+    if (bootCache.oxygenHealthy) {
+        oxygenInitialized = oxygen.begin(Oxygen_IIC);
+        bootCache.oxygenHealthy = oxygenInitialized;
+    }
+#endif
+    
+    return true;
+}
+
+// ==========================================
+// FILTRAGE DE LA RAFALE
+// ==========================================
+// Durée de conversion avec la configuration de begin() (X1 partout)
+#define BME280_FORCED_TIME_MS ((BME280_MEAS_TIME_US(1, 1, 1) + 999) / 1000)
+
+// Médiane d'un petit échantillon (tri par insertion, le tableau est modifié)
+static float median(float* values, uint8_t count) {
+    for (uint8_t i = 1; i < count; i++) {
+        float v = values[i];
+        int8_t j = i - 1;
+        while (j >= 0 && values[j] > v) {
+            values[j + 1] = values[j];
+            j--;
+        }
+        values[j + 1] = v;
+    }
+    if (count % 2) return values[count / 2];
+    return (values[count / 2 - 1] + values[count / 2]) / 2.0f;
+}
+
+// Valeur d'une rafale (mesures dans l'ordre d'acquisition) : médiane, bruit
+// (MAD x 1.4826 ~ écart-type pour un bruit gaussien), puis filtre
+// exponentiel sur les mesures de la rafale à moins de 3 écarts-types de la
+// médiane. Aucun état entre deux réveils : la mesure n'est pas retardée.
+static float burstEstimate(const float* samples, uint8_t count, float* noise) {
+    float sorted[SENSOR_BURST_COUNT > OXYGEN_BURST_COUNT ? SENSOR_BURST_COUNT : OXYGEN_BURST_COUNT];
+    memcpy(sorted, samples, count * sizeof(float));
+    float m = median(sorted, count);
+    for (uint8_t i = 0; i < count; i++) {
+        sorted[i] = fabsf(samples[i] - m);
+    }
+    *noise = (count > 1) ? median(sorted, count) * 1.4826f : 0.0f;
+    
+    float filtered = m;
+    for (uint8_t i = 0; i < count; i++) {
+        if (fabsf(samples[i] - m) <= 3.0f * *noise) {
+            filtered = SENSOR_IIR_ALPHA * samples[i] + (1.0f - SENSOR_IIR_ALPHA) * filtered;
+        }
+    }
+    return filtered;
+}
+
+bool CompostSensors::waitMeasurement() {
+    // La conversion est normalement terminée après BME280_FORCED_TIME_MS
+    unsigned long start = millis();
+    while (bme.isMeasuring()) {
+        if (millis() - start > BME280_FORCED_TIME_MS) return false;
+        delay(1);
+    }
+    return true;
+}
+
+// ==========================================
+// BATTERIE
+// ==========================================
+uint16_t CompostSensors::sampleBattery() {
+    return batteryReadMv(analogReadMilliVolts);
+}
+
+uint16_t CompostSensors::batteryMv() const {
+    return batteryState.valid ? batteryState.filteredMv : 0;
+}
+
+PowerMode CompostSensors::powerMode() const {
+    return (PowerMode)batteryState.mode;
+}
+
+uint16_t CompostSensors::sleepMinutes(uint16_t scheduledMinutes) const {
+    return powerSleepMinutes(scheduledMinutes, powerMode());
+}
+
 // ==========================================
 // LECTURE DES DONNÉES
 // ==========================================
@@ -55,38 +185,104 @@ SensorData CompostSensors::readSensors() {
     data.valid = false;
     data.boardId = BOARD_ID;
     data.timestamp = millis();
+    data.temperature = NAN;
+    data.humidity = NAN;
     data.oxygen = -1.0;  // Valeur par défaut si pas de capteur O2
+    data.temperatureNoise = 0.0;
+    data.humidityNoise = 0.0;
+    data.oxygenNoise = 0.0;
+    data.samples = 0;
     
-    // Lecture du BME280
-    if (bmeInitialized) {
-        // Forcer une nouvelle mesure
-        bme.takeForcedMeasurement();
+    // Batterie mesurée avant la rafale, capteurs au repos
+    if (powerUpdate(batteryState, sampleBattery())) {
+        Serial.printf("🔋 Mode d'énergie : %s (%u mV)\n",
+                      POWER_PROFILES[batteryState.mode].name, batteryState.filteredMv);
+    }
+    data.batteryMv = batteryMv();
+    
+    float temperatures[SENSOR_BURST_COUNT];
+    float humidities[SENSOR_BURST_COUNT];
+    uint8_t bmeCount = 0;
+    
+    // Rafale de mesures forcées, cadencée sur la durée de conversion du BME280
+    unsigned long burstStart = millis();
+    for (uint8_t n = 0; n < SENSOR_BURST_COUNT; n++) {
+        // Ne pas dépasser le budget : la première mesure est toujours faite
+        if (n > 0 && millis() - burstStart + BME280_FORCED_TIME_MS > SENSOR_BURST_BUDGET_MS) {
+            break;
+        }
         
-        data.temperature = bme.readTemperature();
-        data.humidity = bme.readHumidity();
+        // La première conversion a pu être lancée par beginFast()
+        bool pending = conversionPending;
+        conversionPending = false;
+        if (bmeInitialized && !pending) {
+            bme.startForcedMeasurement();
+        }
         
+        if (bmeInitialized) {
+            if (!pending) {
+                delay(BME280_FORCED_TIME_MS);
+            }
+            if (waitMeasurement()) {
+                float t = bme.readTemperature();
+                float h = bme.readHumidity();
+                if (!isnan(t) && !isnan(h)) {
+                    temperatures[bmeCount] = t;
+                    humidities[bmeCount] = h;
+                    bmeCount++;
+                }
+            }
+        }
+    }
+    
+    // Lecture du BME280
+    if (bmeInitialized) {
         // Vérification de la validité des données
-        if (!isnan(data.temperature) && !isnan(data.humidity)) {
+        if (bmeCount > 0) {
+            data.temperature = burstEstimate(temperatures, bmeCount, &data.temperatureNoise);
+            data.humidity = burstEstimate(humidities, bmeCount, &data.humidityNoise);
+            data.samples = bmeCount;
             data.valid = true;
             
 #ifdef DEBUG_SERIAL
             Serial.println("📊 Lecture BME280 :");
-            Serial.printf("   Température : %.2f °C\n", data.temperature);
-            Serial.printf("   Humidité : %.2f %%\n", data.humidity);
+            Serial.printf("   Température : %.2f °C (±%.2f)\n", data.temperature, data.temperatureNoise);
+            Serial.printf("   Humidité : %.2f %% (±%.2f)\n", data.humidity, data.humidityNoise);
+            Serial.printf("   Rafale : %d mesures en %lu ms\n", bmeCount, millis() - burstStart);
 #endif
         } else {
+            // Forcer une sonde complète au prochain réveil
+            bootCache.valid = false;
             Serial.println("❌ Erreur de lecture BME280");
         }
     }
     
 #ifdef HAS_OXYGEN_SENSOR
-    // Lecture du capteur d'oxygène
-    if (oxygenInitialized) {
-        data.oxygen = oxygen.readOxygenData(COLLECT_NUMBER);
+    // Lecture du capteur d'oxygène, hors de la rafale BME280 : chaque lecture
+    // du pilote SEN0322 comporte ses propres attentes, elle a son budget
+    // (batterie faible : le capteur n'est plus interrogé)
+    if (oxygenInitialized && POWER_PROFILES[batteryState.mode].oxygen) {
+        float oxygens[OXYGEN_BURST_COUNT];
+        uint8_t oxygenCount = 0;
+        unsigned long oxygenStart = millis();
+        unsigned long readMs = 0;
+        for (uint8_t n = 0; n < OXYGEN_BURST_COUNT; n++) {
+            // La lecture suivante durerait autant que la précédente
+            if (n > 0 && millis() - oxygenStart + readMs > OXYGEN_BURST_BUDGET_MS) {
+                break;
+            }
+            unsigned long readStart = millis();
+            float o2 = oxygen.readOxygenData(1);
+            readMs = millis() - readStart;
+            if (o2 >= 0) {
+                oxygens[oxygenCount++] = o2;
+            }
+        }
         
-        if (data.oxygen >= 0) {
+        if (oxygenCount > 0) {
+            data.oxygen = burstEstimate(oxygens, oxygenCount, &data.oxygenNoise);
 #ifdef DEBUG_SERIAL
-            Serial.printf("   Oxygène : %.2f %%\n", data.oxygen);
+            Serial.printf("   Oxygène : %.2f %% (±%.2f)\n", data.oxygen, data.oxygenNoise);
 #endif
         } else {
             Serial.println("⚠ Erreur de lecture capteur O2");
@@ -115,6 +311,8 @@ void CompostSensors::printData(const SensorData& data) {
         }
 #endif
         
+        Serial.printf("📈 Bruit       : T ±%.2f  H ±%.2f (%d mesures)\n",
+                      data.temperatureNoise, data.humidityNoise, data.samples);
         Serial.printf("⏱  Timestamp   : %lu ms\n", data.timestamp);
     } else {
         Serial.println("❌ Données invalides");
@@ -6,11 +6,17 @@
 #include <Adafruit_Sensor.h>
 #include <Adafruit_BME280.h>
 #include "config.h"
+#include "power.h"
 
 #ifdef HAS_OXYGEN_SENSOR
 #include <DFRobot_OxygenSensor.h>
 #endif
 
+// Durée de conversion max du BME280 en mode forcé (datasheet §9.1) :
+// 1.25 ms + 2.3 ms x osrs_t + (2.3 ms x osrs_p + 0.575 ms) + (2.3 ms x osrs_h + 0.575 ms)
+#define BME280_MEAS_TIME_US(osrsT, osrsP, osrsH) \
+    (1250 + 2300 * (osrsT) + 2300 * (osrsP) + 575 + 2300 * (osrsH) + 575)
+
 // ==========================================
 // Structure pour stocker les données des capteurs
 // ==========================================
@@ -18,17 +24,48 @@ struct SensorData {
     float temperature;      // °C
     float humidity;         // %
     float oxygen;          // % (seulement pour bac d'apport)
+    float temperatureNoise; // Écart-type robuste de la rafale (°C)
+    float humidityNoise;    // Écart-type robuste de la rafale (%)
+    float oxygenNoise;      // Écart-type robuste de la rafale (%)
+    uint8_t samples;       // Nombre de mesures retenues dans la rafale
+    uint16_t batteryMv;    // Tension batterie filtrée (mV, 0 = non mesurée)
     bool valid;            // Indique si les données sont valides
     uint8_t boardId;       // ID de la carte (1=apport, 2=maturation, 3=exterieur)
     unsigned long timestamp; // Timestamp en millisecondes
 };
 
+// ==========================================
+// BME280 avec déclenchement non bloquant de la mesure forcée
+// ==========================================
+class CompostBME280 : public Adafruit_BME280 {
+public:
+    // Lance une conversion forcée sans attendre la fin
+    void startForcedMeasurement() { write8(BME280_REGISTER_CONTROL, _measReg.get()); }
+    
+    // Vrai tant que la conversion est en cours
+    bool isMeasuring() { return read8(BME280_REGISTER_STATUS) & 0x08; }
+    
+    // Coefficients de calibration lus par begin()
+    const bme280_calib_data& calibration() const { return _bme280_calib; }
+    
+    // Démarrage à chaud : reprend la calibration sauvegardée sans soft-reset,
+    // sans attente de copie NVM ni délai de 100 ms de init()
+    bool restore(uint8_t addr, TwoWire* theWire, const bme280_calib_data& calib) {
+        if (i2c_dev) delete i2c_dev;
+        i2c_dev = new Adafruit_I2CDevice(addr, theWire);
+        if (!i2c_dev->begin(false)) return false;
+        _bme280_calib = calib;
+        _sensorID = 0x60;
+        return true;
+    }
+};
+
 // ==========================================
 // Classe de gestion des capteurs
 // ==========================================
 class CompostSensors {
 private:
-    Adafruit_BME280 bme;
+    CompostBME280 bme;
     
 #ifdef HAS_OXYGEN_SENSOR
     DFRobot_OxygenSensor oxygen;
@@ -36,6 +73,7 @@ private:
     
     bool bmeInitialized;
     bool oxygenInitialized;
+    bool conversionPending;     // Conversion lancée par beginFast(), pas encore lue
 
 public:
     CompostSensors();
@@ -43,15 +81,37 @@ public:
     // Initialisation des capteurs
     bool begin();
     
+    // Initialisation rapide au réveil : réutilise l'état RTC si les capteurs
+    // étaient sains et lance immédiatement la première conversion BME280,
+    // que readSensors() récupère. Séquence de réveil esclave :
+    //   beginFast() -> BLEDevice::init()/serveur -> readSensors() -> advertising
+    //   -> buffer.sleepFor(sleepMinutes(ack.sleepMinutes)) -> deep sleep
+    bool beginFast();
+    
     // Lecture des données
     SensorData readSensors();
     
+    // Tension batterie filtrée et mode d'énergie (mis à jour par readSensors())
+    uint16_t batteryMv() const;
+    PowerMode powerMode() const;
+    
+    // Sommeil de l'esclave : consigne brute du maître (sleep_min) allongée
+    // selon le mode de l'esclave, seul à l'ajuster
+    uint16_t sleepMinutes(uint16_t scheduledMinutes) const;
+    
     // Vérification de l'état des capteurs
     bool isBMEReady() { return bmeInitialized; }
     bool isOxygenReady() { return oxygenInitialized; }
     
     // Affichage des données (debug)
     void printData(const SensorData& data);
+
+private:
+    // Moyenne de BATTERY_SAMPLES lectures, avant la rafale (0 si désactivé)
+    uint16_t sampleBattery();
+    
+    // Attend la fin d'une conversion BME280 lancée par startForcedMeasurement()
+    bool waitMeasurement();
 };
 
 #endif // SENSORS_H
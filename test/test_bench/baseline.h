@@ -0,0 +1,39 @@
+#ifndef BASELINE_H
+#define BASELINE_H
+
+// ==========================================
+// RÉFÉRENCE DES BENCHMARKS
+// ==========================================
+// PC : rapport du temps de l'opération à celui du témoin (benchReferenceOp)
+// mesuré entre les mêmes passes, valeur haute de plusieurs exécutions ; il ne
+// dépend pas de la machine. Options gcc -O2 -std=gnu++11, fixées dans les
+// build_flags de env:native ; avec d'autres options (-O0, -Os) les rapports
+// ne sont pas comparables.
+// ESP32 : ns/op à 240 MHz, options de env:master (framework Arduino). Colonne
+// pas encore relevée sur la carte : à 0, env:bench_esp32 ne contrôle que les
+// allocations et l'indique ("time not checked").
+// -1 octet = pas de contrôle. Après une optimisation validée, recopier les
+// lignes "[BASELINE]" de la sortie du test dans la colonne correspondante.
+
+struct BenchBaseline {
+    const char* name;
+    double nativeRatio;         // PC (env:native) : temps / temps du témoin de la même exécution
+    double targetNsPerOp;       // ESP32 à 240 MHz (env:bench_esp32)
+    int bytesPerOp;
+};
+
+static const BenchBaseline BENCH_BASELINE[] = {
+    // nom                       PC      ESP32   octets
+    {"format_iso8601",          2.50,   0,      0},
+    {"parse_iso8601",           0.11,   0,      0},
+    {"advance_datetime_30min",  0.20,   0,      0},
+    {"offset_datetime_-24h",    0.22,   0,      0},
+    {"csv_row_apport",          0.75,   0,      0},
+    {"csv_batch_48",            180,    0,      0},
+    {"csv_parse_apport",        0.45,   0,      0},
+    {"gorilla_encode_240",      190,    0,      0},
+    {"gorilla_decode_240",      235,    0,      0},
+    {"export_frame_236",        20,     0,      0},
+};
+
+#endif // BASELINE_H
@@ -0,0 +1,117 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <esp_timer.h>
+#else
+#include <chrono>
+#endif
+
+// ==========================================
+// MINI-HARNAIS DE BENCHMARK
+// ==========================================
+// Chaque benchmark est calibré (itérations doublées jusqu'à BENCH_MIN_TIME_NS),
+// puis répété BENCH_REPEATS fois : le meilleur temps est retenu (le moins
+// perturbé par l'OS ou les interruptions).
+// Les allocations sont comptées en enveloppant malloc/calloc/realloc à
+// l'édition de liens (-Wl,--wrap=..., activé par -DBENCH_COUNT_ALLOCS).
+
+#ifndef BENCH_MIN_TIME_NS
+  #ifdef ARDUINO
+    #define BENCH_MIN_TIME_NS 200000000ULL   // 200 ms sur la carte
+  #else
+    #define BENCH_MIN_TIME_NS 50000000ULL    // 50 ms sur PC
+  #endif
+#endif
+#define BENCH_REPEATS 5
+
+struct BenchResult {
+    const char* name;
+    double nsPerOp;
+    double referenceNs;             // Témoin (benchReferenceOp), mesuré entre les passes
+    double bytesPerOp;
+    double allocsPerOp;
+};
+
+// Compteurs d'allocation (voir bench_alloc.cpp)
+extern volatile uint64_t benchAllocBytes;
+extern volatile uint64_t benchAllocCount;
+
+// Empêche le compilateur d'éliminer le résultat d'une opération
+extern volatile uint32_t benchSink;
+
+inline uint64_t benchNowNs() {
+#ifdef ARDUINO
+    return (uint64_t)esp_timer_get_time() * 1000ULL;
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// Opération témoin, chronométrée après chaque passe d'un benchmark : une
+// charge fixe (xorshift, dépendances en chaîne), indépendante du code
+// mesuré. Sur PC, les références sont des rapports à son temps, qui ne
+// dépendent ni de la machine ni de sa fréquence du moment.
+inline uint32_t benchReferenceOp(uint32_t seed) {
+    uint32_t x = seed | 1;
+    for (int i = 0; i < 64; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+    }
+    return x;
+}
+
+// Itérations pour qu'une passe dure au moins BENCH_MIN_TIME_NS / 4
+template <typename Op>
+uint32_t benchCalibrate(Op op) {
+    uint32_t iterations = 1;
+    for (;;) {
+        uint64_t start = benchNowNs();
+        for (uint32_t i = 0; i < iterations; i++) op();
+        if (benchNowNs() - start >= BENCH_MIN_TIME_NS / 4 || iterations >= (1UL << 30)) break;
+        iterations *= 2;
+    }
+    return iterations;
+}
+
+inline void benchReferenceStep() {
+    benchSink += benchReferenceOp(benchSink);
+}
+
+template <typename Op>
+BenchResult runBench(const char* name, Op op) {
+    BenchResult result = {name, 0, 0, 0, 0};
+    uint32_t iterations = benchCalibrate(op);
+    uint32_t referenceIterations = benchCalibrate(benchReferenceStep);
+    
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        uint64_t bytes = benchAllocBytes;
+        uint64_t count = benchAllocCount;
+        uint64_t start = benchNowNs();
+        for (uint32_t i = 0; i < iterations; i++) op();
+        uint64_t elapsed = benchNowNs() - start;
+        
+        double nsPerOp = (double)elapsed / iterations;
+        if (r == 0 || nsPerOp < result.nsPerOp) result.nsPerOp = nsPerOp;
+        result.bytesPerOp = (double)(benchAllocBytes - bytes) / iterations;
+        result.allocsPerOp = (double)(benchAllocCount - count) / iterations;
+        
+        // Témoin juste après chaque passe : même état de la machine
+        start = benchNowNs();
+        for (uint32_t i = 0; i < referenceIterations; i++) benchReferenceStep();
+        nsPerOp = (double)(benchNowNs() - start) / referenceIterations;
+        if (r == 0 || nsPerOp < result.referenceNs) result.referenceNs = nsPerOp;
+    }
+    
+    return result;
+}
+
+#endif // BENCH_H
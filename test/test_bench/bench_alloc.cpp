@@ -0,0 +1,66 @@
+#include "bench.h"
+#include <new>
+
+volatile uint64_t benchAllocBytes = 0;
+volatile uint64_t benchAllocCount = 0;
+volatile uint32_t benchSink = 0;
+
+#ifdef BENCH_COUNT_ALLOCS
+
+// ==========================================
+// COMPTAGE DES ALLOCATIONS (-Wl,--wrap=malloc,...)
+// ==========================================
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    benchAllocBytes += size;
+    benchAllocCount++;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    benchAllocBytes += count * size;
+    benchAllocCount++;
+    return __real_calloc(count, size);
+}
+
+// Un realloc compte comme une nouvelle allocation de la taille demandée
+void* __wrap_realloc(void* ptr, size_t size) {
+    benchAllocBytes += size;
+    benchAllocCount++;
+    return __real_realloc(ptr, size);
+}
+}
+
+// new passe par malloc de cette unité (enveloppé), y compris sur PC où
+// l'opérateur de libstdc++ appellerait le malloc non enveloppé
+void* operator new(size_t size) {
+    void* p = malloc(size);
+    if (p == nullptr) abort();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+
+#endif // BENCH_COUNT_ALLOCS
@@ -0,0 +1,320 @@
+// ==========================================
+// BENCHMARKS DES FONCTIONS DU MAÎTRE
+// Dates, lecture de la date SD, lignes CSV, blocs compactés
+// ==========================================
+// PC :     pio test -e native -f test_bench
+// Carte :  pio test -e bench_esp32 -f test_bench
+// Chaque ligne "[BENCH]" donne ns/op, le rapport au témoin (benchReferenceOp),
+// octets alloués/op et allocations/op ; un test échoue si le résultat
+// régresse par rapport à baseline.h.
+#include <unity.h>
+#include <format.h>
+#include <records.h>
+#include <gorilla.h>
+#include <export_frame.h>
+#include "bench.h"
+#include "baseline.h"
+
+// Tolérance sur le temps (les octets alloués doivent être identiques ou moindres).
+// Un PC partagé est bien plus bruité que la carte.
+#ifndef BENCH_TOLERANCE_PCT
+  #ifdef ARDUINO
+    #define BENCH_TOLERANCE_PCT 10
+  #else
+    #define BENCH_TOLERANCE_PCT 50
+  #endif
+#endif
+
+// Lot d'un esclave dont le tampon est plein
+#define SLAVE_BATCH_SIZE SLAVE_BUFFER_CAPACITY
+
+static const DateTime REFERENCE = {2026, 2, 28, 23, 45, 10};
+static SlaveRecord batch[SLAVE_BATCH_SIZE];
+static char rows[SLAVE_BATCH_SIZE * CSV_ROW_MAX];
+static uint32_t archiveTimes[GORILLA_BLOCK_MAX_ROWS];
+static int32_t archiveValues[GORILLA_BLOCK_MAX_ROWS][3];
+static uint8_t archiveBlock[GORILLA_BLOCK_MAX_BYTES];
+
+void setUp() {}
+void tearDown() {}
+
+// ==========================================
+// COMPARAISON AVEC LA RÉFÉRENCE
+// ==========================================
+static const BenchBaseline* findBaseline(const char* name) {
+    for (size_t i = 0; i < sizeof(BENCH_BASELINE) / sizeof(BENCH_BASELINE[0]); i++) {
+        if (strcmp(BENCH_BASELINE[i].name, name) == 0) return &BENCH_BASELINE[i];
+    }
+    return nullptr;
+}
+
+static void report(const BenchResult& result) {
+    char line[128];
+    double ratio = result.nsPerOp / result.referenceNs;
+    snprintf(line, sizeof(line), "[BENCH] %-24s %10.1f ns/op %8.2f x ref %8.1f B/op %6.2f allocs/op",
+             result.name, result.nsPerOp, ratio, result.bytesPerOp, result.allocsPerOp);
+    TEST_MESSAGE(line);
+    
+    // Colonnes à recopier dans baseline.h après une optimisation validée
+#ifdef ARDUINO
+    snprintf(line, sizeof(line), "[BASELINE] {\"%s\", <PC>, %.0f, %.0f},",
+             result.name, result.nsPerOp, result.bytesPerOp);
+#else
+    snprintf(line, sizeof(line), "[BASELINE] {\"%s\", %.2f, <ESP32>, %.0f},",
+             result.name, ratio, result.bytesPerOp);
+#endif
+    TEST_MESSAGE(line);
+    
+    const BenchBaseline* baseline = findBaseline(result.name);
+    if (baseline == nullptr) {
+        TEST_MESSAGE("[BENCH]    no baseline");
+        return;
+    }
+    
+#ifdef ARDUINO
+    double measured = result.nsPerOp;
+    double reference = baseline->targetNsPerOp;
+    const char* unit = "ns/op";
+#else
+    double measured = ratio;
+    double reference = baseline->nativeRatio;
+    const char* unit = "x ref";
+#endif
+    if (reference > 0) {
+        double limit = reference * (100 + BENCH_TOLERANCE_PCT) / 100.0;
+        snprintf(line, sizeof(line), "%s: %.2f %s, baseline %.2f (+%d%% allowed)",
+                 result.name, measured, unit, reference, BENCH_TOLERANCE_PCT);
+        TEST_ASSERT_TRUE_MESSAGE(measured <= limit, line);
+    } else {
+        // Colonne pas encore relevée : seules les allocations sont vérifiées
+        TEST_MESSAGE("[BENCH]    no time baseline on this platform: time not checked");
+    }
+    
+#ifdef BENCH_COUNT_ALLOCS
+    if (baseline->bytesPerOp >= 0) {
+        snprintf(line, sizeof(line), "%s: %.1f B/op, baseline %d",
+                 result.name, result.bytesPerOp, baseline->bytesPerOp);
+        TEST_ASSERT_TRUE_MESSAGE(result.bytesPerOp <= baseline->bytesPerOp, line);
+    }
+#endif
+}
+
+// ==========================================
+// BENCHMARKS
+// ==========================================
+void test_format_iso8601() {
+    char buffer[ISO8601_LENGTH + 1];
+    report(runBench("format_iso8601", [&]() {
+        formatISO8601(buffer, REFERENCE);
+        benchSink += buffer[18];
+    }));
+    TEST_ASSERT_EQUAL_STRING("2026-02-28T23:45:10", buffer);
+}
+
+void test_parse_iso8601() {
+    DateTime dt;
+    report(runBench("parse_iso8601", [&]() {
+        parseISO8601("2026-02-28T23:45:10\r", &dt);
+        benchSink += dt.second;
+    }));
+    TEST_ASSERT_EQUAL(2026, dt.year);
+    TEST_ASSERT_EQUAL(10, dt.second);
+}
+
+// Incrément d'un cycle de sommeil (état TIME)
+void test_advance_datetime() {
+    DateTime dt = REFERENCE;
+    report(runBench("advance_datetime_30min", [&]() {
+        dt = REFERENCE;
+        advanceDateTime(dt, 30 * 60);
+        benchSink += dt.day;
+    }));
+    TEST_ASSERT_EQUAL(3, dt.month);
+    TEST_ASSERT_EQUAL(1, dt.day);
+    TEST_ASSERT_EQUAL(0, dt.hour);
+    TEST_ASSERT_EQUAL(15, dt.minute);
+}
+
+// Datation d'une mesure d'un lot (âge en cycles)
+void test_offset_datetime() {
+    DateTime dt;
+    report(runBench("offset_datetime_-24h", [&]() {
+        dt = offsetDateTime(REFERENCE, -86400L);
+        benchSink += dt.day;
+    }));
+    TEST_ASSERT_EQUAL(27, dt.day);
+    TEST_ASSERT_EQUAL(23, dt.hour);
+}
+
+void test_csv_row() {
+    char row[CSV_ROW_MAX];
+    const float values[] = {65.25f, 48.5f, 17.75f};
+    size_t length = 0;
+    report(runBench("csv_row_apport", [&]() {
+        length = formatCsvRow(row, sizeof(row), 1, "2026-02-28T23:45:10", values);
+        benchSink += length;
+    }));
+    TEST_ASSERT_EQUAL_STRING("2026-02-28T23:45:10;65.25;48.50;17.75;\n", row);
+}
+
+// Relecture d'une ligne (rollup, export des archives, outil sdingest)
+void test_csv_parse() {
+    DateTime dt;
+    int32_t centi[4];
+    int count = 0;
+    report(runBench("csv_parse_apport", [&]() {
+        count = parseCsvRow("2026-02-28T23:45:10;65.25;-48.50;nan;---;\n", &dt, centi, 3);
+        benchSink += centi[0];
+    }));
+    TEST_ASSERT_EQUAL(3, count);
+    TEST_ASSERT_EQUAL(6525, centi[0]);
+    TEST_ASSERT_EQUAL(-4850, centi[1]);
+    TEST_ASSERT_EQUAL(CSV_NO_VALUE, centi[2]);
+}
+
+// Chemin complet de saveDataToSD() pour un lot de SLAVE_BATCH_SIZE mesures
+void test_csv_batch() {
+    for (int i = 0; i < SLAVE_BATCH_SIZE; i++) {
+        batch[i].seq = i;
+        batch[i].ageMinutes = (SLAVE_BATCH_SIZE - 1 - i) * 30;
+        batch[i].values[FIELD_TEMPERATURE] = encodeCenti(60.0f + i * 0.1f);
+        batch[i].values[FIELD_HUMIDITY] = encodeCenti(50.0f - i * 0.1f);
+        batch[i].values[FIELD_OXYGEN] = encodeCenti(18.0f);
+    }
+    
+    size_t length = 0;
+    report(runBench("csv_batch_48", [&]() {
+        length = 0;
+        for (int r = 0; r < SLAVE_BATCH_SIZE; r++) {
+            char isoTime[ISO8601_LENGTH + 1];
+            float values[SCHEMA_MAX_FIELDS];
+            formatISO8601(isoTime, offsetDateTime(REFERENCE, -(long)batch[r].ageMinutes * 60));
+            for (uint8_t n = 0; n < boardFieldCount(1); n++) {
+                values[n] = decodeCenti(batch[r].values[boardField(1, n)]);
+            }
+            length += formatCsvRow(rows + length, sizeof(rows) - length, 1, isoTime, values);
+        }
+        benchSink += length;
+    }));
+    TEST_ASSERT_EQUAL_STRING_LEN("2026-02-28T00:15:10;60.00;50.00;18.00;\n", rows, 39);
+}
+
+// Bloc complet d'une carte apport (5 jours à 30 min, horloge à +-1 s)
+static void fillArchiveRows() {
+    uint32_t time = (uint32_t)dateTimeToEpoch(REFERENCE);
+    for (int r = 0; r < GORILLA_BLOCK_MAX_ROWS; r++) {
+        archiveTimes[r] = time;
+        time += 30 * 60 + (r % 7 == 3 ? 1 : 0) - (r % 11 == 5 ? 1 : 0);
+        archiveValues[r][0] = 6000 + (r * 7) % 60 - r / 4;      // T : dérive lente
+        archiveValues[r][1] = 5000 - (r * 13) % 40;              // H
+        archiveValues[r][2] = r % 48 == 0 ? CSV_NO_VALUE : 1800 + r % 5;  // O2
+    }
+}
+
+static size_t encodeArchive(GorillaBlockHeader* header) {
+    GorillaEncoder encoder;
+    encoder.begin(archiveBlock, sizeof(archiveBlock), 3);
+    for (int r = 0; r < GORILLA_BLOCK_MAX_ROWS; r++) {
+        encoder.append(archiveTimes[r], archiveValues[r]);
+    }
+    return encoder.finish(header);
+}
+
+// Compaction d'un bloc plein (runCompaction)
+void test_gorilla_encode() {
+    fillArchiveRows();
+    GorillaBlockHeader header;
+    size_t bytes = 0;
+    report(runBench("gorilla_encode_240", [&]() {
+        bytes = encodeArchive(&header);
+        benchSink += bytes;
+    }));
+    TEST_ASSERT_EQUAL(GORILLA_BLOCK_MAX_ROWS, header.count);
+    
+    // Le même bloc en CSV : 39 octets par ligne apport
+    char line[64];
+    snprintf(line, sizeof(line), "gorilla_encode_240: %u bytes for %u CSV bytes",
+             (unsigned)(sizeof(header) + bytes), (unsigned)(GORILLA_BLOCK_MAX_ROWS * 39));
+    TEST_MESSAGE(line);
+    TEST_ASSERT_TRUE((sizeof(header) + bytes) * 8 <= GORILLA_BLOCK_MAX_ROWS * 39);
+}
+
+// Export vers Android d'un bloc plein (exportArchive, hors mise en forme CSV)
+void test_gorilla_decode() {
+    fillArchiveRows();
+    GorillaBlockHeader header;
+    encodeArchive(&header);
+    
+    int rowsOk = 0;
+    report(runBench("gorilla_decode_240", [&]() {
+        GorillaDecoder decoder;
+        decoder.begin(header, archiveBlock);
+        uint32_t time;
+        int32_t values[3];
+        rowsOk = 0;
+        while (decoder.next(&time, values)) {
+            if (time == archiveTimes[rowsOk] && values[0] == archiveValues[rowsOk][0] &&
+                values[1] == archiveValues[rowsOk][1] && values[2] == archiveValues[rowsOk][2]) {
+                rowsOk++;
+            }
+        }
+        benchSink += rowsOk;
+    }));
+    TEST_ASSERT_EQUAL(GORILLA_BLOCK_MAX_ROWS, rowsOk);
+}
+
+// Trame d'export au MTU de 247 octets (sendExportFrame, hors notification)
+// Trame construite en place, comme sendExportFrame() : les données sont lues
+// directement derrière l'en-tête
+void test_export_frame() {
+    const size_t payloadLength = 236;
+    uint8_t frame[sizeof(ExportFrameHeader) + payloadLength];
+    uint8_t* payload = frame + sizeof(ExportFrameHeader);
+    for (size_t i = 0; i < payloadLength; i++) payload[i] = (uint8_t)('0' + i % 64);
+    uint16_t seq = 0;
+    size_t size = 0;
+    report(runBench("export_frame_236", [&]() {
+        size = buildExportFrame(frame, 1, seq++, false, payload, payloadLength);
+        benchSink += frame[6];
+    }));
+    
+    ExportFrameHeader header;
+    const uint8_t* data;
+    size_t length;
+    TEST_ASSERT_TRUE(parseExportFrame(frame, size, &header, &data, &length));
+    TEST_ASSERT_EQUAL(payloadLength, length);
+    TEST_ASSERT_EQUAL('0' + 10, data[10]);
+    frame[sizeof(ExportFrameHeader) + 10] ^= 0x04;
+    TEST_ASSERT_FALSE(parseExportFrame(frame, size, &header, &data, &length));
+}
+
+// ==========================================
+// POINT D'ENTRÉE
+// ==========================================
+int runBenchmarks() {
+    UNITY_BEGIN();
+    RUN_TEST(test_format_iso8601);
+    RUN_TEST(test_parse_iso8601);
+    RUN_TEST(test_advance_datetime);
+    RUN_TEST(test_offset_datetime);
+    RUN_TEST(test_csv_row);
+    RUN_TEST(test_csv_batch);
+    RUN_TEST(test_csv_parse);
+    RUN_TEST(test_gorilla_encode);
+    RUN_TEST(test_gorilla_decode);
+    RUN_TEST(test_export_frame);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    delay(2000);    // Laisser le temps au moniteur série de se connecter
+    runBenchmarks();
+}
+
+void loop() {}
+#else
+int main() {
+    return runBenchmarks();
+}
+#endif
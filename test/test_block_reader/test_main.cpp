@@ -0,0 +1,253 @@
+// ==========================================
+// TESTS DU LECTEUR PAR BLOCS
+// Lignes à cheval, début non aligné, reprise après repositionnement
+// ==========================================
+// PC : pio test -e test_native -f test_block_reader
+#include <unity.h>
+#include <string.h>
+#include <block_reader.h>
+
+// Fichier en mémoire, lu bloc par bloc comme sur la carte SD
+struct MemoryFile {
+    const uint8_t* data;
+    uint32_t size;
+    uint16_t reads;
+};
+
+static size_t readMemory(void* context, uint32_t offset, uint8_t* buffer, size_t length) {
+    MemoryFile* file = (MemoryFile*)context;
+    TEST_ASSERT_EQUAL_UINT32(0, offset % BLOCK_SIZE);
+    if (offset >= file->size) return 0;
+    if (length > file->size - offset) length = file->size - offset;
+    memcpy(buffer, file->data + offset, length);
+    file->reads++;
+    return length;
+}
+
+static char text[3 * BLOCK_SIZE];
+static MemoryFile file;
+static BlockReader reader;
+
+static void useText(size_t size) {
+    file.data = (const uint8_t*)text;
+    file.size = size;
+    file.reads = 0;
+}
+
+// Remplit text[from, to[ de lignes "ligne NN" et retourne la fin écrite
+static size_t fillLines(size_t from, size_t to) {
+    int n = 0;
+    while (from + 9 <= to) {
+        memcpy(text + from, "ligne ", 6);
+        text[from + 6] = '0' + n / 10 % 10;
+        text[from + 7] = '0' + n % 10;
+        text[from + 8] = '\n';
+        from += 9;
+        n++;
+    }
+    return from;
+}
+
+static void assertLine(const char* expected) {
+    const char* line;
+    size_t length;
+    TEST_ASSERT_TRUE(reader.nextLine(&line, &length));
+    TEST_ASSERT_EQUAL(strlen(expected), length);
+    TEST_ASSERT_EQUAL_MEMORY(expected, line, length);
+}
+
+void setUp() {
+    memset(text, 'x', sizeof(text));
+}
+
+void tearDown() {}
+
+// ==========================================
+// LIGNES
+// ==========================================
+// Les octets sont rendus tels quels : '\r' et lignes vides conservés
+void test_lines_kept_as_is() {
+    const char* content = "date;t1\r\n\n2026-10-18T10:30:00;52.10\r\nfin";
+    memcpy(text, content, strlen(content));
+    useText(strlen(content));
+    reader.begin(readMemory, &file, 0, file.size);
+
+    assertLine("date;t1\r");
+    assertLine("");
+    assertLine("2026-10-18T10:30:00;52.10\r");
+    assertLine("fin");                              // Dernière ligne sans '\n'
+    TEST_ASSERT_FALSE(reader.lineContinues());
+
+    const char* line;
+    size_t length;
+    TEST_ASSERT_FALSE(reader.nextLine(&line, &length));
+}
+
+// Ligne coupée par la limite du bloc : recopiée entière
+void test_line_across_block_boundary() {
+    size_t end = fillLines(0, BLOCK_SIZE - 4);
+    memcpy(text + end, "a cheval\n", 9);
+    size_t size = end + 9;
+    useText(size);
+    reader.begin(readMemory, &file, end, size);
+
+    assertLine("a cheval");
+    TEST_ASSERT_FALSE(reader.lineContinues());
+    TEST_ASSERT_EQUAL_UINT32(size, reader.position());
+    TEST_ASSERT_EQUAL_UINT16(2, file.reads);
+}
+
+// '\n' en premier octet du bloc suivant
+void test_newline_at_block_start() {
+    size_t end = fillLines(0, BLOCK_SIZE - 20);
+    memset(text + end, 'y', BLOCK_SIZE - end);
+    text[BLOCK_SIZE] = '\n';
+    memcpy(text + BLOCK_SIZE + 1, "suite\n", 6);
+    useText(BLOCK_SIZE + 7);
+    reader.begin(readMemory, &file, end, file.size);
+
+    const char* line;
+    size_t length;
+    TEST_ASSERT_TRUE(reader.nextLine(&line, &length));
+    TEST_ASSERT_EQUAL(BLOCK_SIZE - end, length);
+    assertLine("suite");
+}
+
+// Début au milieu d'un bloc : lecture à partir de l'octet demandé
+void test_unaligned_begin() {
+    size_t size = fillLines(0, 2 * BLOCK_SIZE);
+    useText(size);
+    uint32_t start = 9 * 60;                        // Bloc 1, décalé de 28 octets
+    reader.begin(readMemory, &file, start, size);
+    TEST_ASSERT_EQUAL_UINT32(start, reader.position());
+
+    assertLine("ligne 60");
+    assertLine("ligne 61");
+    TEST_ASSERT_EQUAL_UINT32(start + 18, reader.position());
+}
+
+// Le bloc suivant chargé d'avance n'est pas relu
+void test_prefetch() {
+    size_t size = fillLines(0, 2 * BLOCK_SIZE);
+    useText(size);
+    reader.begin(readMemory, &file, 0, size);
+    TEST_ASSERT_TRUE(reader.prefetch());
+    TEST_ASSERT_FALSE(reader.prefetch());           // Tampon libre déjà rempli
+    TEST_ASSERT_EQUAL_UINT16(2, file.reads);
+
+    size_t lines = 0;
+    const char* line;
+    size_t length;
+    while (reader.nextLine(&line, &length)) lines++;
+    TEST_ASSERT_EQUAL(size / 9, lines);
+    TEST_ASSERT_EQUAL_UINT16(2, file.reads);
+}
+
+// Ligne à cheval plus longue que BLOCK_LINE_MAX : rendue en morceaux, rien n'est perdu
+void test_long_line_in_pieces() {
+    size_t start = BLOCK_SIZE - 100;
+    size_t longLength = 300;
+    for (size_t i = 0; i < longLength; i++) text[start + i] = 'a' + i % 26;
+    text[start + longLength] = '\n';
+    memcpy(text + start + longLength + 1, "courte\n", 7);
+    useText(start + longLength + 8);
+    reader.begin(readMemory, &file, start, file.size);
+
+    const char* line;
+    size_t length;
+    TEST_ASSERT_TRUE(reader.nextLine(&line, &length));
+    TEST_ASSERT_EQUAL(BLOCK_LINE_MAX, length);
+    TEST_ASSERT_TRUE(reader.lineContinues());
+    TEST_ASSERT_EQUAL_MEMORY(text + start, line, length);
+
+    size_t total = length;
+    do {
+        TEST_ASSERT_TRUE(reader.nextLine(&line, &length));
+        TEST_ASSERT_EQUAL_MEMORY(text + start + total, line, length);
+        total += length;
+    } while (reader.lineContinues());
+    TEST_ASSERT_EQUAL(longLength, total);
+
+    assertLine("courte");
+}
+
+// Copie terminée par '\0' ; une ligne trop longue pour le tampon est sautée entière
+void test_read_line_copies_or_skips() {
+    size_t start = BLOCK_SIZE - 100;
+    size_t longLength = 300;
+    memcpy(text + start - 9, "ligne 00\n", 9);
+    for (size_t i = 0; i < longLength; i++) text[start + i] = 'a' + i % 26;
+    text[start + longLength] = '\n';
+    memcpy(text + start + longLength + 1, "courte", 6);
+    useText(start + longLength + 7);
+    reader.begin(readMemory, &file, start - 9, file.size);
+
+    char line[32];
+    TEST_ASSERT_TRUE(reader.readLine(line, sizeof(line)));
+    TEST_ASSERT_EQUAL_STRING("ligne 00", line);
+    TEST_ASSERT_TRUE(reader.readLine(line, sizeof(line)));
+    TEST_ASSERT_EQUAL_STRING("", line);
+    TEST_ASSERT_TRUE(reader.readLine(line, sizeof(line)));
+    TEST_ASSERT_EQUAL_STRING("courte", line);
+    TEST_ASSERT_FALSE(reader.readLine(line, sizeof(line)));
+}
+
+// ==========================================
+// LECTURE BRUTE
+// ==========================================
+// Lecture après repositionnement, comme une trame retransmise
+void test_read_after_seek() {
+    for (size_t i = 0; i < sizeof(text); i++) text[i] = (char)(i * 7);
+    useText(sizeof(text));
+
+    uint8_t out[236];
+    reader.begin(readMemory, &file, 0, file.size);
+    TEST_ASSERT_EQUAL(sizeof(out), reader.read(out, sizeof(out)));
+    TEST_ASSERT_EQUAL(sizeof(out), reader.read(out, sizeof(out)));
+    TEST_ASSERT_EQUAL(sizeof(out), reader.read(out, sizeof(out)));
+    TEST_ASSERT_EQUAL_UINT32(3 * sizeof(out), reader.position());
+
+    // Retour à la trame 2, à cheval sur les blocs 0 et 1
+    reader.begin(readMemory, &file, sizeof(out) * 2, file.size);
+    TEST_ASSERT_EQUAL(sizeof(out), reader.read(out, sizeof(out)));
+    TEST_ASSERT_EQUAL_MEMORY(text + sizeof(out) * 2, out, sizeof(out));
+
+    // Fin du fichier : lecture partielle puis 0
+    reader.begin(readMemory, &file, sizeof(text) - 100, file.size);
+    TEST_ASSERT_EQUAL(100, reader.read(out, sizeof(out)));
+    TEST_ASSERT_EQUAL_MEMORY(text + sizeof(text) - 100, out, 100);
+    TEST_ASSERT_EQUAL(0, reader.read(out, sizeof(out)));
+}
+
+// Fin demandée avant la fin du fichier (export limité à ses octets écrits)
+void test_end_before_file_size() {
+    size_t size = fillLines(0, 2 * BLOCK_SIZE);
+    useText(size);
+    reader.begin(readMemory, &file, 0, 18);
+    assertLine("ligne 00");
+    assertLine("ligne 01");
+    const char* line;
+    size_t length;
+    TEST_ASSERT_FALSE(reader.nextLine(&line, &length));
+}
+
+// ==========================================
+// POINT D'ENTRÉE
+// ==========================================
+int runTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_lines_kept_as_is);
+    RUN_TEST(test_line_across_block_boundary);
+    RUN_TEST(test_newline_at_block_start);
+    RUN_TEST(test_unaligned_begin);
+    RUN_TEST(test_prefetch);
+    RUN_TEST(test_long_line_in_pieces);
+    RUN_TEST(test_read_line_copies_or_skips);
+    RUN_TEST(test_read_after_seek);
+    RUN_TEST(test_end_before_file_size);
+    return UNITY_END();
+}
+
+int main() {
+    return runTests();
+}
@@ -0,0 +1,253 @@
+// ==========================================
+// TESTS DE LA COMPACTION DES MESURES ANCIENNES
+// Blocs mensuels, recopie du CSV, reprise après coupure et budget de temps
+// ==========================================
+// PC : pio test -e test_native -f test_compaction
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <compaction.h>
+#include <format.h>
+#include <memory_storage.h>
+#include <retention.h>
+#include <screening.h>
+
+#define BOARD 2                         // maturation : température, humidité
+#define STEP_S 1800                     // Une mesure toutes les 30 min
+
+static MemoryStorage storage;
+static ArchiveScratch scratch;
+static CompactionJob job;
+static uint8_t nextBoard;
+static uint32_t clockNow;
+
+static uint32_t epoch(uint16_t year, uint8_t month, uint8_t day, uint8_t hour = 0) {
+    DateTime dt = {year, month, day, hour, 0, 0};
+    return (uint32_t)dateTimeToEpoch(dt);
+}
+
+// Chaque lecture de l'horloge avance d'une milliseconde
+static uint32_t tickClock() {
+    return ++clockNow;
+}
+
+static int32_t rowValue(uint32_t time) {
+    return 4000 + time / STEP_S % 1000;
+}
+
+// CSV de la carte : en-tête puis count mesures à partir de start
+static void writeCsv(uint32_t start, int count) {
+    char header[CSV_ROW_MAX];
+    size_t length = formatCsvHeader(header, sizeof(header), BOARD);
+    snprintf(header + length, sizeof(header) - length, "qualite;\n");
+    TEST_ASSERT_TRUE(storage.put(BOARD_SPECS[BOARD - 1].file, header));
+
+    StorageFile csv = storage.open(BOARD_SPECS[BOARD - 1].file, STORAGE_APPEND);
+    for (int i = 0; i < count; i++) {
+        uint32_t time = start + i * STEP_S;
+        char iso[ISO8601_LENGTH + 1];
+        formatISO8601(iso, epochToDateTime(time));
+        float values[2] = {rowValue(time) / 100.0f, 55.5f};
+        char row[CSV_ROW_MAX];
+        length = formatCsvRow(row, sizeof(row), BOARD, iso, values);
+        length = appendQualityColumn(row, length, sizeof(row), 0, 2);
+        storage.write(csv, (const uint8_t*)row, length);
+    }
+    storage.close(csv);
+}
+
+static void compact(uint32_t now, uint32_t budgetMs, CompactionReport* report) {
+    runCompaction(storage, job, &nextBoard, now, clockNow + budgetMs, tickClock, scratch, report);
+}
+
+// Mesures archivées d'un mois : nombre, et chronologie stricte depuis *last
+static int archivedRecords(uint32_t period, uint32_t* last) {
+    ArchivePeriod archive;
+    if (!archive.open(storage, BOARD, period, scratch.block)) return 0;
+
+    int count = 0;
+    ArchiveIndexEntry entry;
+    GorillaDecoder decoder;
+    for (uint32_t index = 0; archive.read(index, &entry, &decoder) == ARCHIVE_BLOCK_OK; index++) {
+        TEST_ASSERT_EQUAL_UINT8(3, entry.header.channels);     // T, H + qualité
+        uint32_t time;
+        int32_t values[GORILLA_MAX_CHANNELS];
+        while (decoder.next(&time, values)) {
+            TEST_ASSERT_TRUE(time > *last);
+            TEST_ASSERT_EQUAL_INT32(rowValue(time), values[0]);
+            TEST_ASSERT_EQUAL_INT32(5550, values[1]);
+            TEST_ASSERT_EQUAL_INT32(0, values[2]);
+            *last = time;
+            count++;
+        }
+    }
+    archive.close();
+    return count;
+}
+
+// Lignes de mesures restées dans le CSV, toutes postérieures à cutoff
+static int csvRows(uint32_t cutoff) {
+    const char* text = storage.text(BOARD_SPECS[BOARD - 1].file);
+    TEST_ASSERT_NOT_NULL(text);
+    TEST_ASSERT_EQUAL_MEMORY("date;", text, 5);
+
+    int rows = 0;
+    for (const char* line = strchr(text, '\n'); line && line[1]; line = strchr(line + 1, '\n')) {
+        DateTime dt;
+        TEST_ASSERT_TRUE(parseISO8601(line + 1, &dt));
+        TEST_ASSERT_TRUE((uint32_t)dateTimeToEpoch(dt) >= cutoff);
+        rows++;
+    }
+    return rows;
+}
+
+void setUp() {
+    storage.reset();
+    memset(&job, 0, sizeof(job));
+    nextBoard = 1;
+    clockNow = 0;
+}
+
+void tearDown() {}
+
+// ==========================================
+// COMPACTION
+// ==========================================
+// 10 jours de mesures : les 7 plus anciens passent en blocs, le CSV garde le reste
+void test_old_rows_archived_and_csv_trimmed() {
+    uint32_t now = epoch(2026, 3, 20, 12);
+    uint32_t start = now - 10 * 86400UL;
+    writeCsv(start, 10 * 48);
+
+    CompactionReport report;
+    compact(now, 1000000, &report);
+    TEST_ASSERT_TRUE(report.compacted);
+    TEST_ASSERT_FALSE(report.writeFailed);
+    TEST_ASSERT_EQUAL(COMPACT_IDLE, job.phase);
+    TEST_ASSERT_EQUAL_UINT8(BOARD, job.boardId);
+
+    uint32_t cutoff = now - COMPACT_AGE_DAYS * 86400UL;
+    uint32_t last = 0;
+    int archived = archivedRecords(202603, &last);
+    TEST_ASSERT_EQUAL(7 * 48, archived);
+    TEST_ASSERT_EQUAL_UINT32(report.records, (uint32_t)archived);
+    TEST_ASSERT_EQUAL_UINT32(last, archiveLastTime(storage, BOARD));
+    TEST_ASSERT_EQUAL(3 * 48, csvRows(cutoff));
+
+    char tmpPath[24];
+    boardArchivePath(tmpPath, sizeof(tmpPath), BOARD, ".tmp");
+    TEST_ASSERT_FALSE(storage.exists(tmpPath));
+}
+
+// Un CSV dont la première mesure est trop récente pour remplir un bloc n'est pas réécrit
+void test_young_csv_left_alone() {
+    uint32_t now = epoch(2026, 3, 20, 12);
+    writeCsv(now - 6 * 86400UL, 6 * 48);
+    uint32_t size = storage.fileSize(BOARD_SPECS[BOARD - 1].file);
+
+    CompactionReport report;
+    compact(now, 1000000, &report);
+    TEST_ASSERT_EQUAL(COMPACT_IDLE, job.phase);
+    TEST_ASSERT_EQUAL_UINT16(0, report.blocks);
+    TEST_ASSERT_EQUAL_UINT32(size, storage.fileSize(BOARD_SPECS[BOARD - 1].file));
+    TEST_ASSERT_EQUAL_UINT8(1, nextBoard);
+}
+
+// Un bloc ne couvre qu'un mois : fichiers de février et de mars
+void test_blocks_split_by_month() {
+    uint32_t now = epoch(2026, 3, 8);
+    writeCsv(epoch(2026, 2, 25), 11 * 48);
+
+    CompactionReport report;
+    compact(now, 1000000, &report);
+    TEST_ASSERT_TRUE(report.compacted);
+
+    uint32_t last = 0;
+    int february = archivedRecords(202602, &last);
+    int march = archivedRecords(202603, &last);
+    TEST_ASSERT_EQUAL(4 * 48, february);
+    TEST_ASSERT_EQUAL(4 * 48, march);
+
+    uint32_t periods[4];
+    TEST_ASSERT_EQUAL(2, listTierPeriods(storage, BOARD, TIER_RAW, ".idx", periods, 4));
+    TEST_ASSERT_EQUAL_UINT32(202602, periods[0]);
+}
+
+// ==========================================
+// REPRISE
+// ==========================================
+// Budget de quelques millisecondes : le travail avance par morceaux, sans perte ni doublon
+void test_short_budgets_resume() {
+    uint32_t now = epoch(2026, 3, 20, 12);
+    writeCsv(now - 10 * 86400UL, 10 * 48);
+
+    CompactionReport report;
+    int calls = 0;
+    do {
+        compact(now, 40, &report);
+        TEST_ASSERT_FALSE(report.writeFailed);
+        calls++;
+    } while (!report.compacted && calls < 1000);
+    TEST_ASSERT_TRUE(report.compacted);
+    TEST_ASSERT_TRUE(calls > 2);
+
+    uint32_t last = 0;
+    TEST_ASSERT_EQUAL(7 * 48, archivedRecords(202603, &last));
+    TEST_ASSERT_EQUAL(3 * 48, csvRows(now - COMPACT_AGE_DAYS * 86400UL));
+}
+
+// État perdu avant la recopie : les lignes déjà archivées ne le sont pas deux fois
+void test_restart_skips_archived_rows() {
+    uint32_t now = epoch(2026, 3, 20, 12);
+    uint32_t start = now - 10 * 86400UL;
+    writeCsv(start, 10 * 48);
+
+    CompactionReport report;
+    compact(now, 1000000, &report);
+    TEST_ASSERT_TRUE(report.compacted);
+
+    // CSV d'origine, état RTC perdu
+    writeCsv(start, 10 * 48);
+    memset(&job, 0, sizeof(job));
+    nextBoard = BOARD;
+    compact(now, 1000000, &report);
+    TEST_ASSERT_TRUE(report.compacted);
+    TEST_ASSERT_EQUAL_UINT16(0, report.blocks);
+
+    uint32_t last = 0;
+    TEST_ASSERT_EQUAL(7 * 48, archivedRecords(202603, &last));
+    TEST_ASSERT_EQUAL(3 * 48, csvRows(now - COMPACT_AGE_DAYS * 86400UL));
+}
+
+// Carte pleine : travail abandonné, CSV intact
+void test_write_failure_keeps_csv() {
+    uint32_t now = epoch(2026, 3, 20, 12);
+    writeCsv(now - 10 * 86400UL, 10 * 48);
+    uint32_t size = storage.fileSize(BOARD_SPECS[BOARD - 1].file);
+
+    storage.failWrites = true;
+    CompactionReport report;
+    compact(now, 1000000, &report);
+    TEST_ASSERT_TRUE(report.writeFailed);
+    TEST_ASSERT_FALSE(report.compacted);
+    TEST_ASSERT_EQUAL(COMPACT_IDLE, job.phase);
+    TEST_ASSERT_EQUAL_UINT32(size, storage.fileSize(BOARD_SPECS[BOARD - 1].file));
+}
+
+// ==========================================
+// POINT D'ENTRÉE
+// ==========================================
+int runTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_old_rows_archived_and_csv_trimmed);
+    RUN_TEST(test_young_csv_left_alone);
+    RUN_TEST(test_blocks_split_by_month);
+    RUN_TEST(test_short_budgets_resume);
+    RUN_TEST(test_restart_skips_archived_rows);
+    RUN_TEST(test_write_failure_keeps_csv);
+    return UNITY_END();
+}
+
+int main() {
+    return runTests();
+}
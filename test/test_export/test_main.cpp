@@ -0,0 +1,191 @@
+// ==========================================
+// TESTS DU TRANSFERT EXPORT
+// Trames, fenêtre, ACK, NACK et reprise sur un fichier en mémoire
+// ==========================================
+// PC : pio test -e test_native -f test_export
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <block_reader.h>
+#include <export_frame.h>
+#include <export_session.h>
+#include <memory_storage.h>
+
+#define EXPORT_PATH "/export.bin"
+#define PAYLOAD 100
+
+static MemoryStorage storage;
+static ExportTransfer transfer;
+static BlockReader reader;
+static char content[20000];
+
+// Trames reçues par le « téléphone »
+static uint16_t sentSeq[256];
+static int sentCount;
+static int retransmits;
+
+static void receiveFrame(void* context, const uint8_t* frame, size_t length, bool retransmit,
+                         BlockReader& frameReader) {
+    (void)context;
+    (void)frameReader;
+    ExportFrameHeader header;
+    const uint8_t* payload;
+    size_t payloadLength;
+    TEST_ASSERT_TRUE(parseExportFrame(frame, length, &header, &payload, &payloadLength));
+    TEST_ASSERT_EQUAL_UINT16(transfer.transferId, header.transferId);
+    TEST_ASSERT_EQUAL_MEMORY(content + header.seq * PAYLOAD, payload, payloadLength);
+    TEST_ASSERT_EQUAL(header.seq + 1 == transfer.frames, (header.flags & EXPORT_FRAME_LAST) != 0);
+    TEST_ASSERT_TRUE(sentCount < 256);
+    sentSeq[sentCount++] = header.seq;
+    if (retransmit) retransmits++;
+}
+
+// Fichier d'export de size octets
+static void writeExportFile(uint32_t size) {
+    for (uint32_t i = 0; i < size; i++) content[i] = (char)('a' + i * 7 % 26);
+    StorageFile file = storage.open(EXPORT_PATH, STORAGE_WRITE);
+    TEST_ASSERT_EQUAL(size, storage.write(file, (const uint8_t*)content, size));
+    storage.close(file);
+}
+
+static int pump(ExportSession& session, int burst) {
+    return session.pump(reader, burst, receiveFrame, nullptr);
+}
+
+void setUp() {
+    storage.reset();
+    memset(&transfer, 0, sizeof(transfer));
+    sentCount = 0;
+    retransmits = 0;
+}
+
+void tearDown() {}
+
+// ==========================================
+// ENVOI
+// ==========================================
+// Trames dans l'ordre, dernière trame courte et marquée
+void test_frames_in_order() {
+    writeExportFile(1050);
+    ExportSession session(transfer, storage, EXPORT_PATH);
+    TEST_ASSERT_TRUE(session.start(1050, PAYLOAD));
+    TEST_ASSERT_EQUAL_UINT16(11, transfer.frames);
+    TEST_ASSERT_NOT_EQUAL(0, transfer.transferId);
+
+    TEST_ASSERT_EQUAL(8, pump(session, 8));
+    TEST_ASSERT_EQUAL(3, pump(session, 8));
+    TEST_ASSERT_FALSE(session.hasFrames());
+    for (int i = 0; i < sentCount; i++) TEST_ASSERT_EQUAL_UINT16(i, sentSeq[i]);
+    TEST_ASSERT_EQUAL(11, sentCount);
+}
+
+// Jamais plus de EXPORT_WINDOW trames au-delà du dernier ACK
+void test_window_waits_for_ack() {
+    writeExportFile(EXPORT_WINDOW * PAYLOAD + 10 * PAYLOAD);
+    ExportSession session(transfer, storage, EXPORT_PATH);
+    TEST_ASSERT_TRUE(session.start(EXPORT_WINDOW * PAYLOAD + 10 * PAYLOAD, PAYLOAD));
+
+    while (pump(session, 8) > 0) {}
+    TEST_ASSERT_EQUAL(EXPORT_WINDOW, sentCount);
+    TEST_ASSERT_FALSE(session.hasFrames());
+
+    TEST_ASSERT_EQUAL(EXPORT_REPLY_OK, session.ack("4"));
+    TEST_ASSERT_TRUE(session.hasFrames());
+    while (pump(session, 8) > 0) {}
+    TEST_ASSERT_EQUAL(EXPORT_WINDOW + 5, sentCount);
+}
+
+// Dernier ACK : fichier supprimé, identifiant suivant au transfert d'après
+void test_last_ack_completes() {
+    writeExportFile(250);
+    ExportSession session(transfer, storage, EXPORT_PATH);
+    TEST_ASSERT_TRUE(session.start(250, PAYLOAD));
+    uint16_t id = transfer.transferId;
+    while (pump(session, 8) > 0) {}
+
+    TEST_ASSERT_EQUAL(EXPORT_REPLY_OK, session.ack("1"));
+    TEST_ASSERT_EQUAL(EXPORT_REPLY_COMPLETE, session.ack("2"));
+    TEST_ASSERT_FALSE(session.active());
+    TEST_ASSERT_FALSE(storage.exists(EXPORT_PATH));
+    TEST_ASSERT_EQUAL_UINT16(id, transfer.lastId);
+    TEST_ASSERT_EQUAL(EXPORT_REPLY_INVALID, session.ack("2"));
+
+    writeExportFile(250);
+    TEST_ASSERT_TRUE(session.start(250, PAYLOAD));
+    TEST_ASSERT_EQUAL_UINT16(id + 1, transfer.transferId);
+}
+
+// Fichier trop grand pour 65535 trames : pas de transfert
+void test_too_many_frames_rejected() {
+    ExportSession session(transfer, storage, EXPORT_PATH);
+    TEST_ASSERT_FALSE(session.start(70000UL * 20, 20));
+    TEST_ASSERT_FALSE(session.active());
+    TEST_ASSERT_FALSE(session.start(1000, EXPORT_FRAME_MAX));
+}
+
+// ==========================================
+// RETRANSMISSION ET REPRISE
+// ==========================================
+// Les NACK passent avant les trames nouvelles ; plages hors transfert ignorées
+void test_nack_served_first() {
+    writeExportFile(2000);
+    ExportSession session(transfer, storage, EXPORT_PATH);
+    TEST_ASSERT_TRUE(session.start(2000, PAYLOAD));
+    TEST_ASSERT_EQUAL(5, pump(session, 5));
+
+    TEST_ASSERT_EQUAL(EXPORT_REPLY_OK, session.nack("1-2,4,30-40"));
+    TEST_ASSERT_EQUAL(4, pump(session, 4));
+    TEST_ASSERT_EQUAL_UINT16(1, sentSeq[5]);
+    TEST_ASSERT_EQUAL_UINT16(2, sentSeq[6]);
+    TEST_ASSERT_EQUAL_UINT16(4, sentSeq[7]);
+    TEST_ASSERT_EQUAL_UINT16(5, sentSeq[8]);
+    TEST_ASSERT_EQUAL(3, retransmits);
+
+    TEST_ASSERT_EQUAL(EXPORT_REPLY_INVALID, session.nack("x"));
+    TEST_ASSERT_EQUAL(EXPORT_REPLY_INVALID, session.ack("20"));
+}
+
+// Réveil suivant : seul l'état RTC reste, RESUME repart de la trame demandée
+void test_resume_after_wake() {
+    writeExportFile(2000);
+    {
+        ExportSession session(transfer, storage, EXPORT_PATH);
+        TEST_ASSERT_TRUE(session.start(2000, PAYLOAD));
+        pump(session, 8);
+        session.ack("5");
+    }
+
+    ExportSession session(transfer, storage, EXPORT_PATH);
+    TEST_ASSERT_FALSE(session.hasFrames());
+    char argument[16];
+    snprintf(argument, sizeof(argument), "%u 7", transfer.transferId);
+    TEST_ASSERT_EQUAL(EXPORT_REPLY_MTU, session.resume(argument, PAYLOAD - 1));
+    TEST_ASSERT_EQUAL(EXPORT_REPLY_UNKNOWN, session.resume("999 7", PAYLOAD));
+    TEST_ASSERT_EQUAL(EXPORT_REPLY_OK, session.resume(argument, PAYLOAD));
+
+    sentCount = 0;
+    TEST_ASSERT_EQUAL(8, pump(session, 8));
+    TEST_ASSERT_EQUAL_UINT16(7, sentSeq[0]);
+    TEST_ASSERT_EQUAL_UINT16(14, sentSeq[7]);
+
+    storage.remove(EXPORT_PATH);
+    TEST_ASSERT_EQUAL(EXPORT_REPLY_UNKNOWN, session.resume(argument, PAYLOAD));
+}
+
+// ==========================================
+// POINT D'ENTRÉE
+// ==========================================
+int runTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_frames_in_order);
+    RUN_TEST(test_window_waits_for_ack);
+    RUN_TEST(test_last_ack_completes);
+    RUN_TEST(test_too_many_frames_rejected);
+    RUN_TEST(test_nack_served_first);
+    RUN_TEST(test_resume_after_wake);
+    return UNITY_END();
+}
+
+int main() {
+    return runTests();
+}
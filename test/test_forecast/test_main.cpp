@@ -0,0 +1,109 @@
+// ==========================================
+// TESTS DE LA PRÉVISION DE RETOURNEMENT
+// Lissage de Holt et passage sous le seuil
+// ==========================================
+// PC : pio test -e test_native -f test_forecast
+#include <unity.h>
+#include <forecast.h>
+
+#define ALPHA 0.5f
+#define BETA 0.3f
+#define T0 1790000000UL             // Octobre 2026
+
+static HoltState state;
+
+void setUp() {
+    holtReset(state);
+}
+
+void tearDown() {}
+
+// ==========================================
+// LISSAGE
+// ==========================================
+void test_first_readings() {
+    holtUpdate(state, 60.0f, T0, ALPHA, BETA);
+    TEST_ASSERT_EQUAL_UINT16(1, state.count);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 60.0f, state.level);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, state.trend);
+
+    // Deuxième mesure : pente directe, en °C/h
+    holtUpdate(state, 59.0f, T0 + 7200, ALPHA, BETA);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 59.0f, state.level);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, -0.5f, state.trend);
+}
+
+// Mesure pas plus récente que la précédente : ignorée
+void test_stale_reading_ignored() {
+    holtUpdate(state, 60.0f, T0, ALPHA, BETA);
+    holtUpdate(state, 50.0f, T0, ALPHA, BETA);
+    holtUpdate(state, 50.0f, T0 - 1800, ALPHA, BETA);
+    TEST_ASSERT_EQUAL_UINT16(1, state.count);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 60.0f, state.level);
+}
+
+// Baisse régulière, mesures irrégulières : la pente reste celle de la baisse
+void test_linear_decline_irregular_steps() {
+    const uint32_t steps[] = {1800, 1800, 3600, 1800, 7200, 1800, 1800, 5400};
+    uint32_t time = T0;
+    holtUpdate(state, 60.0f, time, ALPHA, BETA);
+    for (unsigned i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+        time += steps[i];
+        holtUpdate(state, 60.0f - 0.25f * (time - T0) / 3600.0f, time, ALPHA, BETA);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, -0.25f, state.trend);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 60.0f - 0.25f * (time - T0) / 3600.0f, state.level);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, state.level - 0.5f, holtPredict(state, time + 7200));
+    // Pas de projection dans le passé
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, state.level, holtPredict(state, time - 3600));
+}
+
+// ==========================================
+// PASSAGE SOUS LE SEUIL
+// ==========================================
+void test_hours_until_below() {
+    holtUpdate(state, 55.0f, T0, ALPHA, BETA);
+    holtUpdate(state, 54.0f, T0 + 3600, ALPHA, BETA);
+    // 54 °C, -1 °C/h : 45 °C dans 9 h
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 9.0f, holtHoursUntilBelow(state, 45.0f));
+}
+
+void test_already_below_and_falling() {
+    holtUpdate(state, 44.0f, T0, ALPHA, BETA);
+    holtUpdate(state, 43.0f, T0 + 3600, ALPHA, BETA);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, holtHoursUntilBelow(state, 45.0f));
+}
+
+void test_hot_and_stable_not_predictable() {
+    holtUpdate(state, 60.0f, T0, ALPHA, BETA);
+    holtUpdate(state, 60.0f, T0 + 3600, ALPHA, BETA);
+    TEST_ASSERT_EQUAL_FLOAT(HOLT_NOT_FALLING, holtHoursUntilBelow(state, 45.0f));
+}
+
+// Tas neuf en chauffe, encore sous le seuil : ce n'est pas le moment de le retourner
+void test_heating_below_threshold_not_predictable() {
+    holtUpdate(state, 25.0f, T0, ALPHA, BETA);
+    holtUpdate(state, 30.0f, T0 + 3600, ALPHA, BETA);
+    holtUpdate(state, 35.0f, T0 + 7200, ALPHA, BETA);
+    TEST_ASSERT_TRUE(state.level < 45.0f);
+    TEST_ASSERT_EQUAL_FLOAT(HOLT_NOT_FALLING, holtHoursUntilBelow(state, 45.0f));
+}
+
+// ==========================================
+// POINT D'ENTRÉE
+// ==========================================
+int runTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_readings);
+    RUN_TEST(test_stale_reading_ignored);
+    RUN_TEST(test_linear_decline_irregular_steps);
+    RUN_TEST(test_hours_until_below);
+    RUN_TEST(test_already_below_and_falling);
+    RUN_TEST(test_hot_and_stable_not_predictable);
+    RUN_TEST(test_heating_below_threshold_not_predictable);
+    return UNITY_END();
+}
+
+int main() {
+    return runTests();
+}
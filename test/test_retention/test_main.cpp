@@ -0,0 +1,147 @@
+// ==========================================
+// TESTS DES NIVEAUX DE RÉTENTION
+// Périodes des fichiers, expiration et moyennes des agrégats
+// ==========================================
+// PC : pio test -e test_native -f test_retention
+#include <unity.h>
+#include <format.h>
+#include <retention.h>
+
+static uint32_t epoch(uint16_t year, uint8_t month, uint8_t day, uint8_t hour = 0) {
+    DateTime dt = {year, month, day, hour, 0, 0};
+    return (uint32_t)dateTimeToEpoch(dt);
+}
+
+void setUp() {}
+void tearDown() {}
+
+// ==========================================
+// PÉRIODES
+// ==========================================
+void test_period_of_each_tier() {
+    uint32_t time = epoch(2026, 3, 15, 12);
+    TEST_ASSERT_EQUAL_UINT32(202603, tierPeriod(TIER_RAW, time));
+    TEST_ASSERT_EQUAL_UINT32(202603, tierPeriod(TIER_HOURLY, time));
+    TEST_ASSERT_EQUAL_UINT32(2026, tierPeriod(TIER_DAILY, time));
+}
+
+// Dernière seconde d'un mois et première du suivant
+void test_period_boundaries() {
+    uint32_t start = epoch(2026, 2, 1);
+    TEST_ASSERT_EQUAL_UINT32(202601, tierPeriod(TIER_RAW, start - 1));
+    TEST_ASSERT_EQUAL_UINT32(202602, tierPeriod(TIER_RAW, start));
+    TEST_ASSERT_EQUAL_UINT32(2025, tierPeriod(TIER_DAILY, epoch(2026, 1, 1) - 1));
+}
+
+void test_period_end() {
+    TEST_ASSERT_EQUAL_UINT32(epoch(2026, 3, 1), tierPeriodEnd(TIER_RAW, 202602));
+    TEST_ASSERT_EQUAL_UINT32(epoch(2027, 1, 1), tierPeriodEnd(TIER_HOURLY, 202612));
+    TEST_ASSERT_EQUAL_UINT32(epoch(2027, 1, 1), tierPeriodEnd(TIER_DAILY, 2026));
+}
+
+// ==========================================
+// EXPIRATION
+// ==========================================
+// Le fichier n'expire que lorsque toute sa période dépasse l'horizon
+void test_expired_only_when_whole_period_is_past() {
+    uint32_t end = tierPeriodEnd(TIER_RAW, 202601);
+    TEST_ASSERT_FALSE(tierExpired(TIER_RAW, 202601, end + 30 * 86400UL - 1, 30));
+    TEST_ASSERT_TRUE(tierExpired(TIER_RAW, 202601, end + 30 * 86400UL, 30));
+}
+
+void test_keep_forever() {
+    TEST_ASSERT_FALSE(tierExpired(TIER_DAILY, 2000, epoch(2026, 1, 1), 0));
+}
+
+// Horloge pas encore réglée (maintenant < horizon) : rien n'expire
+void test_horizon_before_epoch() {
+    TEST_ASSERT_FALSE(tierExpired(TIER_RAW, 197001, 86400UL, 30));
+}
+
+void test_steps() {
+    TEST_ASSERT_EQUAL_UINT32(0, tierStep(TIER_RAW));
+    TEST_ASSERT_EQUAL_UINT32(3600, tierStep(TIER_HOURLY));
+    TEST_ASSERT_EQUAL_UINT32(86400, tierStep(TIER_DAILY));
+}
+
+// ==========================================
+// AGRÉGATS
+// ==========================================
+void test_bucket_mean_skips_missing_values() {
+    TierBucket bucket;
+    bucketReset(bucket, 3600);
+    TEST_ASSERT_TRUE(bucketEmpty(bucket, 2));
+
+    int32_t a[2] = {5000, CSV_NO_VALUE};
+    int32_t b[2] = {5100, CSV_NO_VALUE};
+    bucketAdd(bucket, a, 2);
+    bucketAdd(bucket, b, 2);
+    TEST_ASSERT_FALSE(bucketEmpty(bucket, 2));
+
+    int32_t mean[2];
+    bucketMean(bucket, mean, 2);
+    TEST_ASSERT_EQUAL_INT32(5050, mean[0]);
+    TEST_ASSERT_EQUAL_INT32(CSV_NO_VALUE, mean[1]);
+    TEST_ASSERT_EQUAL_UINT32(3600, bucket.start);
+}
+
+// Arrondi au plus proche, symétrique autour de zéro
+void test_bucket_mean_rounding() {
+    TierBucket bucket;
+    int32_t mean[1];
+
+    bucketReset(bucket, 0);
+    int32_t up[3][1] = {{1}, {2}, {2}};             // 5/3 = 1.67
+    for (int i = 0; i < 3; i++) bucketAdd(bucket, up[i], 1);
+    bucketMean(bucket, mean, 1);
+    TEST_ASSERT_EQUAL_INT32(2, mean[0]);
+
+    bucketReset(bucket, 0);
+    int32_t down[3][1] = {{-1}, {-2}, {-2}};
+    for (int i = 0; i < 3; i++) bucketAdd(bucket, down[i], 1);
+    bucketMean(bucket, mean, 1);
+    TEST_ASSERT_EQUAL_INT32(-2, mean[0]);
+
+    bucketReset(bucket, 0);
+    int32_t half[2][1] = {{-1}, {-2}};              // -1.5
+    for (int i = 0; i < 2; i++) bucketAdd(bucket, half[i], 1);
+    bucketMean(bucket, mean, 1);
+    TEST_ASSERT_EQUAL_INT32(-2, mean[0]);
+}
+
+// Une heure de mesures toutes les 30 s ramenée à une seule valeur
+void test_bucket_many_values() {
+    TierBucket bucket;
+    bucketReset(bucket, 0);
+    for (int i = 0; i < 120; i++) {
+        int32_t values[TIER_MAX_CHANNELS] = {6000 + i, CSV_NO_VALUE, -150};
+        bucketAdd(bucket, values, TIER_MAX_CHANNELS);
+    }
+    int32_t mean[TIER_MAX_CHANNELS];
+    bucketMean(bucket, mean, TIER_MAX_CHANNELS);
+    TEST_ASSERT_EQUAL_INT32(6060, mean[0]);         // 6059.5 arrondi
+    TEST_ASSERT_EQUAL_INT32(CSV_NO_VALUE, mean[1]);
+    TEST_ASSERT_EQUAL_INT32(-150, mean[2]);
+}
+
+// ==========================================
+// POINT D'ENTRÉE
+// ==========================================
+int runTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_period_of_each_tier);
+    RUN_TEST(test_period_boundaries);
+    RUN_TEST(test_period_end);
+    RUN_TEST(test_expired_only_when_whole_period_is_past);
+    RUN_TEST(test_keep_forever);
+    RUN_TEST(test_horizon_before_epoch);
+    RUN_TEST(test_steps);
+    RUN_TEST(test_bucket_mean_skips_missing_values);
+    RUN_TEST(test_bucket_mean_rounding);
+    RUN_TEST(test_bucket_many_values);
+    return UNITY_END();
+}
+
+int main() {
+    return runTests();
+}
@@ -0,0 +1,306 @@
+// ==========================================
+// TESTS DE L'AGRÉGATION DES FICHIERS EXPIRÉS
+// Brut -> horaire, horaire -> journalier, suppression, reprise et budget
+// ==========================================
+// PC : pio test -e test_native -f test_rollup
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <compaction.h>
+#include <format.h>
+#include <memory_storage.h>
+#include <retention.h>
+#include <rollup.h>
+#include <screening.h>
+
+#define BOARD 2                         // maturation : température, humidité
+#define STEP_S 1800                     // Une mesure toutes les 30 min
+#define TODAY 20260315
+
+static MemoryStorage storage;
+static ArchiveScratch scratch;
+static RetentionJob job;
+static RetentionHorizons keepDays;
+static uint32_t checkedDay;
+static uint32_t clockNow;
+
+static uint32_t epoch(uint16_t year, uint8_t month, uint8_t day, uint8_t hour = 0) {
+    DateTime dt = {year, month, day, hour, 0, 0};
+    return (uint32_t)dateTimeToEpoch(dt);
+}
+
+// Chaque lecture de l'horloge avance d'une milliseconde
+static uint32_t tickClock() {
+    return ++clockNow;
+}
+
+// CSV de la carte : à chaque heure, une mesure correcte (20,00 °C) puis une
+// variation suspecte (90,00 °C) ; humidité constante
+static void writeCsv(uint32_t start, int count) {
+    char header[CSV_ROW_MAX];
+    size_t length = formatCsvHeader(header, sizeof(header), BOARD);
+    snprintf(header + length, sizeof(header) - length, "qualite;\n");
+    TEST_ASSERT_TRUE(storage.put(BOARD_SPECS[BOARD - 1].file, header));
+
+    StorageFile csv = storage.open(BOARD_SPECS[BOARD - 1].file, STORAGE_APPEND);
+    for (int i = 0; i < count; i++) {
+        uint32_t time = start + i * STEP_S;
+        bool spike = time % 3600 != 0;
+        char iso[ISO8601_LENGTH + 1];
+        formatISO8601(iso, epochToDateTime(time));
+        float values[2] = {spike ? 90.0f : 20.0f, 55.5f};
+        char row[CSV_ROW_MAX];
+        length = formatCsvRow(row, sizeof(row), BOARD, iso, values);
+        length = appendQualityColumn(row, length, sizeof(row),
+                                     spike ? withQuality(0, 0, QUALITY_RATE) : 0, 2);
+        storage.write(csv, (const uint8_t*)row, length);
+    }
+    storage.close(csv);
+}
+
+// Mois de mesures brutes compactées en blocs (/maturation/rAAAAMM.gor)
+static void writeRawMonth(uint32_t start, int count) {
+    writeCsv(start, count);
+    CompactionJob compaction;
+    memset(&compaction, 0, sizeof(compaction));
+    uint8_t nextBoard = BOARD;
+    CompactionReport report;
+    runCompaction(storage, compaction, &nextBoard, start + 40 * 86400UL, clockNow + 1000000, tickClock,
+                  scratch, &report);
+    TEST_ASSERT_TRUE(report.compacted);
+}
+
+// Fichier horaire : 24 moyennes par jour, température 10,00 + heure / 10
+static void writeHourlyDays(uint32_t period, uint32_t start, int days) {
+    char path[32];
+    char row[CSV_ROW_MAX];
+    tierPath(path, sizeof(path), BOARD, TIER_HOURLY, period, ".csv");
+    size_t length = formatCsvHeader(row, sizeof(row) - 1, BOARD);
+    row[length++] = '\n';
+    row[length] = '\0';
+    TEST_ASSERT_TRUE(storage.put(path, row));
+
+    StorageFile file = storage.open(path, STORAGE_APPEND);
+    for (int h = 0; h < days * 24; h++) {
+        int32_t values[2] = {1000 + h % 24 * 10, 5000};
+        length = formatArchiveRow(row, sizeof(row), BOARD, start + h * 3600UL, values);
+        storage.write(file, (const uint8_t*)row, length);
+    }
+    storage.close(file);
+}
+
+static void retain(uint32_t now, uint32_t budgetMs, RetentionReport* report, uint32_t today = TODAY) {
+    runRetention(storage, job, &checkedDay, today, keepDays, now, clockNow + budgetMs, tickClock,
+                 scratch, report);
+}
+
+// Lignes de mesures d'un CSV agrégé : nombre, valeurs attendues, chronologie stricte
+static int checkRows(const char* path, int32_t temperature) {
+    const char* text = storage.text(path);
+    TEST_ASSERT_NOT_NULL(text);
+    TEST_ASSERT_EQUAL_MEMORY("date;", text, 5);
+
+    int rows = 0;
+    uint32_t last = 0;
+    for (const char* line = strchr(text, '\n'); line && line[1]; line = strchr(line + 1, '\n')) {
+        DateTime dt;
+        int32_t values[2];
+        TEST_ASSERT_EQUAL(2, parseCsvRow(line + 1, &dt, values, 2));
+        uint32_t time = (uint32_t)dateTimeToEpoch(dt);
+        TEST_ASSERT_TRUE(time > last);
+        TEST_ASSERT_EQUAL_INT32(temperature, values[0]);
+        last = time;
+        rows++;
+    }
+    return rows;
+}
+
+void setUp() {
+    storage.reset();
+    TEST_ASSERT_TRUE(storage.mkdir("/maturation"));
+    memset(&job, 0, sizeof(job));
+    for (int b = 0; b < SCHEMA_BOARDS; b++) {
+        keepDays[b][TIER_RAW] = 30;
+        keepDays[b][TIER_HOURLY] = 60;
+        keepDays[b][TIER_DAILY] = 365;
+    }
+    checkedDay = 0;
+    clockNow = 0;
+}
+
+void tearDown() {}
+
+// ==========================================
+// NIVEAUX
+// ==========================================
+// Mois brut expiré : moyennes horaires sans les mesures suspectes, blocs supprimés
+void test_raw_month_rolled_into_hourly() {
+    writeRawMonth(epoch(2026, 1, 10), 2 * 48);
+
+    RetentionReport report;
+    retain(epoch(2026, 3, 15), 1000000, &report);
+    TEST_ASSERT_FALSE(report.writeFailed);
+    TEST_ASSERT_EQUAL_UINT16(1, report.rollups);
+    TEST_ASSERT_EQUAL_UINT32(48, report.rows);
+    TEST_ASSERT_TRUE(report.checked);
+    TEST_ASSERT_EQUAL_UINT32(TODAY, checkedDay);
+    TEST_ASSERT_EQUAL_UINT8(0, job.boardId);
+
+    TEST_ASSERT_EQUAL(48, checkRows("/maturation/h202601.csv", 2000));
+    TEST_ASSERT_FALSE(storage.exists("/maturation/r202601.gor"));
+    TEST_ASSERT_FALSE(storage.exists("/maturation/r202601.idx"));
+}
+
+// Mois horaire expiré : moyennes journalières dans le fichier de l'année
+void test_hourly_month_rolled_into_daily() {
+    writeHourlyDays(202512, epoch(2025, 12, 30), 2);
+
+    RetentionReport report;
+    retain(epoch(2026, 3, 15), 1000000, &report);
+    TEST_ASSERT_EQUAL_UINT16(1, report.rollups);
+    TEST_ASSERT_EQUAL(2, checkRows("/maturation/d2025.csv", 1115));
+    TEST_ASSERT_FALSE(storage.exists("/maturation/h202512.csv"));
+}
+
+// Fichiers récents ou gardés indéfiniment : rien ne bouge
+void test_recent_and_kept_files_left_alone() {
+    writeHourlyDays(202602, epoch(2026, 2, 1), 1);
+    writeHourlyDays(202512, epoch(2025, 12, 1), 1);
+    keepDays[BOARD - 1][TIER_HOURLY] = 0;
+
+    RetentionReport report;
+    retain(epoch(2026, 3, 15), 1000000, &report);
+    TEST_ASSERT_EQUAL_UINT16(0, report.rollups);
+    TEST_ASSERT_TRUE(report.checked);
+    TEST_ASSERT_TRUE(storage.exists("/maturation/h202602.csv"));
+    TEST_ASSERT_TRUE(storage.exists("/maturation/h202512.csv"));
+}
+
+// Année journalière expirée : supprimée directement
+void test_expired_daily_file_dropped() {
+    TEST_ASSERT_TRUE(storage.put("/maturation/d2024.csv", "date;temperature;humidity;\n"));
+    TEST_ASSERT_TRUE(storage.put("/maturation/d2025.csv", "date;temperature;humidity;\n"));
+
+    RetentionReport report;
+    retain(epoch(2026, 3, 15), 1000000, &report);
+    TEST_ASSERT_EQUAL_UINT16(1, report.dropped);
+    TEST_ASSERT_FALSE(storage.exists("/maturation/d2024.csv"));
+    TEST_ASSERT_TRUE(storage.exists("/maturation/d2025.csv"));
+}
+
+// ==========================================
+// REPRISE
+// ==========================================
+// Budget de quelques millisecondes : même résultat qu'en une fois
+void test_short_budgets_resume() {
+    writeHourlyDays(202512, epoch(2025, 12, 1), 20);
+    RetentionReport report;
+    retain(epoch(2026, 3, 15), 1000000, &report);
+    char expected[2048];
+    strcpy(expected, storage.text("/maturation/d2025.csv"));
+
+    setUp();
+    writeHourlyDays(202512, epoch(2025, 12, 1), 20);
+    int calls = 0;
+    do {
+        retain(epoch(2026, 3, 15), 25, &report);
+        TEST_ASSERT_FALSE(report.writeFailed);
+        calls++;
+    } while (!report.checked && calls < 1000);
+    TEST_ASSERT_TRUE(calls > 2);
+    TEST_ASSERT_EQUAL_STRING(expected, storage.text("/maturation/d2025.csv"));
+}
+
+// État perdu en cours d'agrégation : les agrégats déjà écrits ne sont pas répétés
+void test_restart_skips_written_rows() {
+    writeRawMonth(epoch(2026, 1, 1), 15 * 48);
+    RetentionReport report;
+    retain(epoch(2026, 3, 15), 3, &report);             // Un bloc agrégé
+    TEST_ASSERT_NOT_EQUAL(0, job.boardId);
+    TEST_ASSERT_TRUE(report.rows > 0);
+
+    memset(&job, 0, sizeof(job));
+    retain(epoch(2026, 3, 15), 1000000, &report);
+    TEST_ASSERT_TRUE(report.checked);
+    TEST_ASSERT_EQUAL(15 * 24, checkRows("/maturation/h202601.csv", 2000));
+}
+
+// Examen une fois par jour : un fichier expiré attend le lendemain
+void test_checked_once_per_day() {
+    RetentionReport report;
+    retain(epoch(2026, 3, 15), 1000000, &report);
+    TEST_ASSERT_TRUE(report.checked);
+
+    writeHourlyDays(202512, epoch(2025, 12, 1), 1);
+    retain(epoch(2026, 3, 15), 1000000, &report);
+    TEST_ASSERT_FALSE(report.checked);
+    TEST_ASSERT_TRUE(storage.exists("/maturation/h202512.csv"));
+
+    retain(epoch(2026, 3, 16), 1000000, &report, TODAY + 1);
+    TEST_ASSERT_EQUAL_UINT16(1, report.rollups);
+    TEST_ASSERT_FALSE(storage.exists("/maturation/h202512.csv"));
+}
+
+// Carte pleine : agrégation abandonnée, fichier source intact
+void test_write_failure_keeps_source() {
+    writeHourlyDays(202512, epoch(2025, 12, 1), 1);
+    uint32_t size = storage.fileSize("/maturation/h202512.csv");
+
+    storage.failWrites = true;
+    RetentionReport report;
+    retain(epoch(2026, 3, 15), 1000000, &report);
+    TEST_ASSERT_TRUE(report.writeFailed);
+    TEST_ASSERT_EQUAL_UINT8(0, job.boardId);
+    TEST_ASSERT_EQUAL_UINT32(size, storage.fileSize("/maturation/h202512.csv"));
+}
+
+// ==========================================
+// EXPORT
+// ==========================================
+// Heures déjà agrégées d'un fichier en cours : masquées à l'export
+void test_rolled_up_hours_hidden() {
+    job.boardId = BOARD;
+    job.source = TIER_RAW;
+    job.period = 202601;
+    job.lastTime = epoch(2026, 1, 10, 5);
+    TEST_ASSERT_TRUE(rolledUp(job, BOARD, TIER_RAW, 202601, epoch(2026, 1, 10, 5) + 1800));
+    TEST_ASSERT_FALSE(rolledUp(job, BOARD, TIER_RAW, 202601, epoch(2026, 1, 10, 6)));
+    TEST_ASSERT_FALSE(rolledUp(job, BOARD, TIER_RAW, 202602, epoch(2026, 1, 10, 1)));
+    TEST_ASSERT_FALSE(rolledUp(job, 1, TIER_RAW, 202601, epoch(2026, 1, 10, 1)));
+}
+
+// Ligne d'une mesure brute : colonne qualité, vide si la qualité est inconnue
+void test_archive_row_quality_column() {
+    int32_t values[2] = {2050, CSV_NO_VALUE};
+    char row[CSV_ROW_MAX];
+    size_t length = formatArchiveRow(row, sizeof(row), BOARD, epoch(2026, 1, 10, 5), values,
+                                     withQuality(0, 1, QUALITY_MISSING));
+    TEST_ASSERT_EQUAL(strlen(row), length);
+    TEST_ASSERT_EQUAL_UINT16(withQuality(0, 1, QUALITY_MISSING), parseQualityColumn(row, 2));
+
+    length = formatArchiveRow(row, sizeof(row), BOARD, epoch(2026, 1, 10, 5), values, QUALITY_UNKNOWN);
+    TEST_ASSERT_EQUAL_UINT16(QUALITY_UNKNOWN, parseQualityColumn(row, 2));
+    TEST_ASSERT_EQUAL('\n', row[length - 1]);
+}
+
+// ==========================================
+// POINT D'ENTRÉE
+// ==========================================
+int runTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_raw_month_rolled_into_hourly);
+    RUN_TEST(test_hourly_month_rolled_into_daily);
+    RUN_TEST(test_recent_and_kept_files_left_alone);
+    RUN_TEST(test_expired_daily_file_dropped);
+    RUN_TEST(test_short_budgets_resume);
+    RUN_TEST(test_restart_skips_written_rows);
+    RUN_TEST(test_checked_once_per_day);
+    RUN_TEST(test_write_failure_keeps_source);
+    RUN_TEST(test_rolled_up_hours_hidden);
+    RUN_TEST(test_archive_row_quality_column);
+    return UNITY_END();
+}
+
+int main() {
+    return runTests();
+}
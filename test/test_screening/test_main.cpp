@@ -0,0 +1,164 @@
+// ==========================================
+// TESTS DU CONTRÔLE DES MESURES
+// Plage, vitesse, capteur bloqué et colonne qualité du CSV
+// ==========================================
+// PC : pio test -e test_native -f test_screening
+#include <unity.h>
+#include <string.h>
+#include <records.h>
+#include <screening.h>
+
+// Température d'un tas : 0-90 °C, 5 °C/h au plus, 6 valeurs identiques tolérées
+static const ScreenLimits LIMITS = {0, 9000, 500, 6};
+
+static ScreenState state;
+
+void setUp() {
+    memset(&state, 0, sizeof(state));
+}
+
+void tearDown() {}
+
+// ==========================================
+// CONTRÔLE D'UNE VALEUR
+// ==========================================
+void test_missing_and_out_of_range() {
+    TEST_ASSERT_EQUAL(QUALITY_MISSING, screenValue(LIMITS, state, RECORD_NO_VALUE, 1000));
+    TEST_ASSERT_EQUAL(QUALITY_RANGE, screenValue(LIMITS, state, -10, 1000));
+    TEST_ASSERT_EQUAL(QUALITY_RANGE, screenValue(LIMITS, state, 9001, 1000));
+    // Aucune valeur retenue
+    TEST_ASSERT_EQUAL_UINT32(0, state.lastTime);
+}
+
+void test_first_value_is_reference() {
+    TEST_ASSERT_EQUAL(QUALITY_OK, screenValue(LIMITS, state, 5000, 1000));
+    TEST_ASSERT_EQUAL_INT16(5000, state.last);
+    TEST_ASSERT_EQUAL_UINT32(1000, state.lastTime);
+}
+
+// Pointe isolée : signalée, la référence reste l'ancienne valeur
+void test_isolated_spike() {
+    screenValue(LIMITS, state, 5000, 1);
+    TEST_ASSERT_EQUAL(QUALITY_RATE, screenValue(LIMITS, state, 7000, 1801));
+    TEST_ASSERT_EQUAL_INT16(5000, state.last);
+    TEST_ASSERT_EQUAL(QUALITY_OK, screenValue(LIMITS, state, 5100, 3601));
+}
+
+// Variation lente : acceptée (2 °C en une heure)
+void test_slow_change_accepted() {
+    screenValue(LIMITS, state, 5000, 1);
+    TEST_ASSERT_EQUAL(QUALITY_OK, screenValue(LIMITS, state, 5200, 3601));
+}
+
+// Plusieurs variations rapides de suite : nouveau niveau réel
+void test_rebase_after_repeated_jumps() {
+    screenValue(LIMITS, state, 5000, 1);
+    uint32_t time = 1;
+    for (int i = 1; i < SCREEN_REBASE_COUNT; i++) {
+        time += 60;
+        TEST_ASSERT_EQUAL(QUALITY_RATE, screenValue(LIMITS, state, 8000, time));
+    }
+    time += 60;
+    TEST_ASSERT_EQUAL(QUALITY_OK, screenValue(LIMITS, state, 8000, time));
+    TEST_ASSERT_EQUAL_INT16(8000, state.last);
+}
+
+void test_stuck_sensor() {
+    uint32_t time = 1;
+    screenValue(LIMITS, state, 4321, time);
+    for (int i = 1; i < LIMITS.stuckCount; i++) {
+        time += 1800;
+        TEST_ASSERT_EQUAL(QUALITY_OK, screenValue(LIMITS, state, 4321, time));
+    }
+    time += 1800;
+    TEST_ASSERT_EQUAL(QUALITY_STUCK, screenValue(LIMITS, state, 4321, time));
+    time += 1800;
+    TEST_ASSERT_EQUAL(QUALITY_OK, screenValue(LIMITS, state, 4322, time));
+}
+
+// Horloge revenue en arrière : la valeur devient la nouvelle référence
+void test_clock_backwards_resets_reference() {
+    screenValue(LIMITS, state, 5000, 10000);
+    TEST_ASSERT_EQUAL(QUALITY_OK, screenValue(LIMITS, state, 8000, 5000));
+    TEST_ASSERT_EQUAL_UINT32(5000, state.lastTime);
+}
+
+// ==========================================
+// CODES QUALITÉ
+// ==========================================
+void test_with_quality_sets_one_channel() {
+    uint16_t quality = 0;
+    quality = withQuality(quality, 0, QUALITY_RATE);
+    quality = withQuality(quality, 2, QUALITY_STUCK);
+    TEST_ASSERT_EQUAL(QUALITY_RATE, qualityCode(quality, 0));
+    TEST_ASSERT_EQUAL(QUALITY_OK, qualityCode(quality, 1));
+    TEST_ASSERT_EQUAL(QUALITY_STUCK, qualityCode(quality, 2));
+
+    // Remplacement d'un code sans toucher aux autres
+    quality = withQuality(quality, 0, QUALITY_OK);
+    TEST_ASSERT_EQUAL(QUALITY_OK, qualityCode(quality, 0));
+    TEST_ASSERT_EQUAL(QUALITY_STUCK, qualityCode(quality, 2));
+    TEST_ASSERT_TRUE(qualityUsable(quality, 1));
+    TEST_ASSERT_FALSE(qualityUsable(quality, 2));
+}
+
+// ==========================================
+// COLONNE QUALITÉ DU CSV
+// ==========================================
+void test_append_quality_column() {
+    char row[64] = "2026-10-18T10:30:00;52.10;61.30;\n";
+    uint16_t quality = withQuality(0, 1, QUALITY_RATE);
+    size_t length = appendQualityColumn(row, strlen(row), sizeof(row), quality, 2);
+    TEST_ASSERT_EQUAL_STRING("2026-10-18T10:30:00;52.10;61.30;-D;\n", row);
+    TEST_ASSERT_EQUAL(strlen(row), length);
+}
+
+void test_append_quality_column_too_small() {
+    char row[36] = "2026-10-18T10:30:00;52.10;61.30;\n";
+    TEST_ASSERT_EQUAL(0, appendQualityColumn(row, strlen(row), sizeof(row), 0, 2));
+}
+
+// Écriture puis relecture de chaque code
+void test_parse_quality_round_trip() {
+    for (uint8_t code = 0; code < QUALITY_CODE_COUNT; code++) {
+        char row[64] = "2026-10-18T10:30:00;52.10;nan;20.90;\n";
+        uint16_t quality = withQuality(withQuality(0, 0, (QualityCode)code), 2, QUALITY_MISSING);
+        TEST_ASSERT_NOT_EQUAL(0, appendQualityColumn(row, strlen(row), sizeof(row), quality, 3));
+        TEST_ASSERT_EQUAL_HEX16(quality, parseQualityColumn(row, 3));
+    }
+}
+
+// Colonne absente (ligne coupée ou antérieure au contrôle), vide, incomplète
+// ou code inconnu : qualité inconnue, jamais « tout bon »
+void test_parse_quality_unknown() {
+    TEST_ASSERT_EQUAL_HEX16(QUALITY_UNKNOWN, parseQualityColumn("2026-10-18T10:30:00;52.10;61.30;\n", 2));
+    TEST_ASSERT_EQUAL_HEX16(QUALITY_UNKNOWN, parseQualityColumn("2026-10-18T10:30:00;52.10;61.30;", 2));
+    TEST_ASSERT_EQUAL_HEX16(QUALITY_UNKNOWN, parseQualityColumn("2026-10-18T10:30:00;52.10;61.30;;\n", 2));
+    TEST_ASSERT_EQUAL_HEX16(QUALITY_UNKNOWN, parseQualityColumn("2026-10-18T10:30:00;52.10;61.30;-", 2));
+    TEST_ASSERT_EQUAL_HEX16(QUALITY_UNKNOWN, parseQualityColumn("2026-10-18T10:30:00;52.10;61.30;-?;\n", 2));
+    TEST_ASSERT_EQUAL_HEX16(QUALITY_UNKNOWN, parseQualityColumn("2026-10-18T10:30:00;52.10", 2));
+}
+
+// ==========================================
+// POINT D'ENTRÉE
+// ==========================================
+int runTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_missing_and_out_of_range);
+    RUN_TEST(test_first_value_is_reference);
+    RUN_TEST(test_isolated_spike);
+    RUN_TEST(test_slow_change_accepted);
+    RUN_TEST(test_rebase_after_repeated_jumps);
+    RUN_TEST(test_stuck_sensor);
+    RUN_TEST(test_clock_backwards_resets_reference);
+    RUN_TEST(test_with_quality_sets_one_channel);
+    RUN_TEST(test_append_quality_column);
+    RUN_TEST(test_append_quality_column_too_small);
+    RUN_TEST(test_parse_quality_round_trip);
+    RUN_TEST(test_parse_quality_unknown);
+    return UNITY_END();
+}
+
+int main() {
+    return runTests();
+}
@@ -0,0 +1,319 @@
+// ==========================================
+// TESTS DU TRANSPORT ESCLAVES -> MAÎTRE
+// Lots envoyés par le backend loopback, doublons, fenêtre de séquences
+// ==========================================
+// PC : pio test -e test_native -f test_transport
+//
+// Le handler reprend l'enregistrement du maître (storeSlaveBatch) : les
+// mesures passent par storeNewRecords() dans un lot de capacité réglable.
+#include <unity.h>
+#include <string.h>
+#include <records.h>
+#include <transport.h>
+#include <loopback_transport.h>
+
+#define TEST_BOARDS 3
+
+// Côté maître : lots du cycle et fenêtre de séquences par carte
+struct MasterStore {
+    SeqWindow windows[TEST_BOARDS];
+    SlaveRecord records[TEST_BOARDS][RECORD_BATCH_MAX_COUNT];
+    uint8_t count[TEST_BOARDS];
+    uint8_t capacity;
+    StoreResult last[TEST_BOARDS];
+};
+
+static MasterStore store;
+static LoopbackTransport loopback;
+
+static bool storeBatch(const SlaveBatchHeader& header, const SlaveRecord* records, void* context) {
+    MasterStore* master = (MasterStore*)context;
+    if (header.boardId < 1 || header.boardId > TEST_BOARDS) {
+        return header.hops > 0;
+    }
+    uint8_t idx = header.boardId - 1;
+    master->last[idx] = storeNewRecords(master->windows[idx], records, header.count,
+                                        master->records[idx], &master->count[idx], master->capacity);
+    return master->last[idx].complete;
+}
+
+// Fin de cycle : les lots sont écrits, la fenêtre est conservée
+static void flushCycle() {
+    memset(store.count, 0, sizeof(store.count));
+}
+
+// Lot de la carte boardId : séquences first .. first + count - 1
+static size_t appendBatch(uint8_t* out, uint8_t boardId, uint8_t hops, uint16_t first, uint8_t count) {
+    SlaveBatchHeader header = {RECORD_FORMAT_VERSION, boardId, count, hops};
+    memcpy(out, &header, sizeof(header));
+    size_t used = sizeof(header);
+    for (uint8_t i = 0; i < count; i++) {
+        SlaveRecord record;
+        memset(&record, 0, sizeof(record));
+        record.seq = (uint16_t)(first + i);
+        record.ageMinutes = (uint16_t)((count - 1 - i) * SLEEP_TIME_MINUTES);
+        record.values[0] = (int16_t)(2000 + i);
+        memcpy(out + used, &record, sizeof(record));
+        used += sizeof(record);
+    }
+    return used;
+}
+
+static int acquireAll() {
+    return loopback.acquire(0, TEST_BOARDS, storeBatch, &store);
+}
+
+void setUp() {
+    memset(&store, 0, sizeof(store));
+    store.capacity = RECORD_BATCH_MAX_COUNT;
+    loopback.begin();
+}
+
+void tearDown() {}
+
+// ==========================================
+// LIVRAISON ET ACQUITTEMENT
+// ==========================================
+void test_batch_delivered_and_acknowledged() {
+    uint8_t frame[RECORD_BATCH_MAX_BYTES];
+    size_t length = appendBatch(frame, 1, 0, 10, 3);
+    TEST_ASSERT_TRUE(loopback.deliver(frame, length, nullptr));
+    TEST_ASSERT_EQUAL(1, loopback.pending());
+
+    TEST_ASSERT_EQUAL(1, acquireAll());
+    TEST_ASSERT_EQUAL(0, loopback.pending());
+    TEST_ASSERT_EQUAL(3, store.count[0]);
+    TEST_ASSERT_EQUAL_UINT16(12, store.records[0][2].seq);
+
+    TransportAck ack;
+    TEST_ASSERT_TRUE(loopback.takeAck(1, &ack));
+    TEST_ASSERT_EQUAL(TRANSPORT_FRAME_ACK, ack.type);
+    TEST_ASSERT_EQUAL_UINT16(12, ack.lastSeq);
+    TEST_ASSERT_FALSE(loopback.takeAck(1, &ack));
+}
+
+// Sans setSchedule() (relais), l'acquittement porte la configuration par défaut
+void test_default_schedule() {
+    uint8_t frame[RECORD_BATCH_MAX_BYTES];
+    size_t length = appendBatch(frame, 2, 0, 1, 1);
+    loopback.deliver(frame, length, nullptr);
+    acquireAll();
+
+    TransportAck ack;
+    TEST_ASSERT_TRUE(loopback.takeAck(2, &ack));
+    TEST_ASSERT_EQUAL_UINT16(SLEEP_TIME_MINUTES, ack.sleepMinutes);
+    TEST_ASSERT_EQUAL_UINT16(BLE_ADVERTISE_TIME, ack.advertiseSeconds);
+
+    SlaveSchedule schedule = {60, 20};
+    loopback.setSchedule(schedule);
+    loopback.deliver(frame, length, nullptr);
+    acquireAll();
+    TEST_ASSERT_TRUE(loopback.takeAck(2, &ack));
+    TEST_ASSERT_EQUAL_UINT16(60, ack.sleepMinutes);
+    TEST_ASSERT_EQUAL_UINT16(20, ack.advertiseSeconds);
+}
+
+// Perte simulée : l'esclave garde son lot et le renvoie
+void test_dropped_delivery() {
+    uint8_t frame[RECORD_BATCH_MAX_BYTES];
+    size_t length = appendBatch(frame, 1, 0, 1, 2);
+    loopback.dropNextDeliveries(1);
+    TEST_ASSERT_FALSE(loopback.deliver(frame, length, nullptr));
+    TEST_ASSERT_EQUAL(0, acquireAll());
+
+    TEST_ASSERT_TRUE(loopback.deliver(frame, length, nullptr));
+    TEST_ASSERT_EQUAL(1, acquireAll());
+    TEST_ASSERT_EQUAL(2, store.count[0]);
+}
+
+// Version inconnue ou lot tronqué : ignoré, sans acquittement
+void test_invalid_batch_ignored() {
+    uint8_t frame[RECORD_BATCH_MAX_BYTES];
+    size_t length = appendBatch(frame, 1, 0, 1, 2);
+    frame[0] = RECORD_FORMAT_VERSION + 1;
+    loopback.deliver(frame, length, nullptr);
+
+    frame[0] = RECORD_FORMAT_VERSION;
+    loopback.deliver(frame, length - 1, nullptr);
+
+    TEST_ASSERT_EQUAL(0, acquireAll());
+    TransportAck ack;
+    TEST_ASSERT_FALSE(loopback.takeAck(1, &ack));
+    TEST_ASSERT_EQUAL(0, store.count[0]);
+}
+
+// ==========================================
+// DOUBLONS
+// ==========================================
+// Acquittement perdu : le même lot revient, rien n'est ajouté mais il est acquitté
+void test_resent_batch_is_duplicate() {
+    uint8_t frame[RECORD_BATCH_MAX_BYTES];
+    size_t length = appendBatch(frame, 1, 0, 5, 4);
+    loopback.deliver(frame, length, nullptr);
+    acquireAll();
+    flushCycle();
+
+    loopback.deliver(frame, length, nullptr);
+    TEST_ASSERT_EQUAL(1, acquireAll());
+    TEST_ASSERT_EQUAL(0, store.count[0]);
+    TEST_ASSERT_EQUAL(4, store.last[0].duplicates);
+
+    TransportAck ack;
+    TEST_ASSERT_TRUE(loopback.takeAck(1, &ack));
+    TEST_ASSERT_EQUAL_UINT16(8, ack.lastSeq);
+}
+
+// Mesures reçues en direct puis par un relais : seules les nouvelles sont ajoutées
+void test_relayed_duplicates() {
+    uint8_t frame[RECORD_BATCH_MAX_BYTES];
+    size_t length = appendBatch(frame, 2, 0, 1, 3);
+    loopback.deliver(frame, length, nullptr);
+
+    // Relais (carte 1) : son lot, puis celui de la carte 2 (séquences 2 à 5)
+    length = appendBatch(frame, 1, 0, 100, 1);
+    length += appendBatch(frame + length, 2, 1, 2, 4);
+    loopback.deliver(frame, length, nullptr);
+
+    TEST_ASSERT_EQUAL(2, acquireAll());
+    TEST_ASSERT_EQUAL(1, store.count[0]);
+    TEST_ASSERT_EQUAL(5, store.count[1]);
+    TEST_ASSERT_EQUAL(2, store.last[1].stored);
+    TEST_ASSERT_EQUAL(2, store.last[1].duplicates);
+
+    TransportAck ack;
+    TEST_ASSERT_TRUE(loopback.takeAck(1, &ack));
+    TEST_ASSERT_EQUAL_UINT16(100, ack.lastSeq);
+}
+
+// ==========================================
+// FENÊTRE DE SÉQUENCES
+// ==========================================
+// Plus de SEQ_WINDOW_SIZE séquences de retard : "trop ancienne", pas doublon
+void test_out_of_window_is_too_old() {
+    SeqWindow window = {};
+    TEST_ASSERT_TRUE(seqWindowAccept(window, 200));
+    TEST_ASSERT_EQUAL(SEQ_DUPLICATE, seqWindowCheck(window, 200));
+    TEST_ASSERT_EQUAL(SEQ_NEW, seqWindowCheck(window, 200 - (SEQ_WINDOW_SIZE - 1)));
+    TEST_ASSERT_EQUAL(SEQ_TOO_OLD, seqWindowCheck(window, 200 - SEQ_WINDOW_SIZE));
+
+    uint8_t frame[RECORD_BATCH_MAX_BYTES];
+    size_t length = appendBatch(frame, 3, 0, 300, 1);
+    loopback.deliver(frame, length, nullptr);
+    acquireAll();
+    length = appendBatch(frame, 3, 0, 300 - SEQ_WINDOW_SIZE - 1, 2);
+    loopback.deliver(frame, length, nullptr);
+    TEST_ASSERT_EQUAL(1, acquireAll());
+    TEST_ASSERT_EQUAL(1, store.count[2]);
+    TEST_ASSERT_EQUAL(2, store.last[2].tooOld);
+    TEST_ASSERT_EQUAL(0, store.last[2].duplicates);
+}
+
+// Rebouclage sur 16 bits, puis carte redémarrée (séquences remises à 0)
+void test_wraparound_and_restart() {
+    SeqWindow window = {};
+    TEST_ASSERT_TRUE(seqWindowAccept(window, 65534));
+    TEST_ASSERT_TRUE(seqWindowAccept(window, 65535));
+    TEST_ASSERT_TRUE(seqWindowAccept(window, 0));
+    TEST_ASSERT_TRUE(seqWindowAccept(window, 1));
+    TEST_ASSERT_FALSE(seqWindowAccept(window, 65535));
+    TEST_ASSERT_EQUAL_UINT16(1, window.highest);
+
+    TEST_ASSERT_TRUE(seqWindowAccept(window, 30000));
+    TEST_ASSERT_TRUE(seqWindowAccept(window, 0));
+    TEST_ASSERT_EQUAL_UINT16(0, window.highest);
+}
+
+// Examiner une séquence ne la marque pas
+void test_check_does_not_mark() {
+    SeqWindow window = {};
+    seqWindowMark(window, 50);
+    TEST_ASSERT_EQUAL(SEQ_NEW, seqWindowCheck(window, 49));
+    TEST_ASSERT_EQUAL(SEQ_NEW, seqWindowCheck(window, 49));
+    seqWindowMark(window, 49);
+    TEST_ASSERT_EQUAL(SEQ_DUPLICATE, seqWindowCheck(window, 49));
+}
+
+// ==========================================
+// LOT PLEIN
+// ==========================================
+// Le reste du lot n'est ni marqué ni acquitté : il est accepté au renvoi
+void test_full_batch_resent_later() {
+    store.capacity = 4;
+    uint8_t frame[RECORD_BATCH_MAX_BYTES];
+    size_t length = appendBatch(frame, 1, 0, 1, 6);
+    loopback.deliver(frame, length, nullptr);
+
+    TEST_ASSERT_EQUAL(0, acquireAll());
+    TEST_ASSERT_EQUAL(4, store.count[0]);
+    TEST_ASSERT_FALSE(store.last[0].complete);
+    TransportAck ack;
+    TEST_ASSERT_FALSE(loopback.takeAck(1, &ack));
+
+    flushCycle();
+    loopback.deliver(frame, length, nullptr);
+    TEST_ASSERT_EQUAL(1, acquireAll());
+    TEST_ASSERT_EQUAL(2, store.count[0]);
+    TEST_ASSERT_EQUAL_UINT16(5, store.records[0][0].seq);
+    TEST_ASSERT_EQUAL_UINT16(6, store.records[0][1].seq);
+    TEST_ASSERT_EQUAL(4, store.last[0].duplicates);
+    TEST_ASSERT_TRUE(loopback.takeAck(1, &ack));
+    TEST_ASSERT_EQUAL_UINT16(6, ack.lastSeq);
+}
+
+// Lot relayé qui ne tient pas : l'envoi du relais n'est pas acquitté
+// (il libérerait aussi les lots relayés)
+void test_full_relayed_batch_blocks_ack() {
+    store.capacity = 2;
+    uint8_t frame[RECORD_BATCH_MAX_BYTES];
+    size_t length = appendBatch(frame, 1, 0, 1, 1);
+    length += appendBatch(frame + length, 3, 1, 40, 3);
+    loopback.deliver(frame, length, nullptr);
+
+    acquireAll();
+    TransportAck ack;
+    TEST_ASSERT_FALSE(loopback.takeAck(1, &ack));
+    TEST_ASSERT_EQUAL(2, store.count[2]);
+
+    flushCycle();
+    loopback.deliver(frame, length, nullptr);
+    acquireAll();
+    TEST_ASSERT_TRUE(loopback.takeAck(1, &ack));
+    TEST_ASSERT_EQUAL(1, store.count[2]);
+    TEST_ASSERT_EQUAL_UINT16(42, store.records[2][0].seq);
+}
+
+// Lot relayé d'une carte inconnue : ignoré sans bloquer l'acquittement
+void test_unknown_relayed_board_ignored() {
+    uint8_t frame[RECORD_BATCH_MAX_BYTES];
+    size_t length = appendBatch(frame, 1, 0, 1, 1);
+    length += appendBatch(frame + length, 9, 1, 1, 2);
+    loopback.deliver(frame, length, nullptr);
+
+    acquireAll();
+    TransportAck ack;
+    TEST_ASSERT_TRUE(loopback.takeAck(1, &ack));
+}
+
+// ==========================================
+// POINT D'ENTRÉE
+// ==========================================
+int runTests() {
+    UNITY_BEGIN();
+    RUN_TEST(test_batch_delivered_and_acknowledged);
+    RUN_TEST(test_default_schedule);
+    RUN_TEST(test_dropped_delivery);
+    RUN_TEST(test_invalid_batch_ignored);
+    RUN_TEST(test_resent_batch_is_duplicate);
+    RUN_TEST(test_relayed_duplicates);
+    RUN_TEST(test_out_of_window_is_too_old);
+    RUN_TEST(test_wraparound_and_restart);
+    RUN_TEST(test_check_does_not_mark);
+    RUN_TEST(test_full_batch_resent_later);
+    RUN_TEST(test_full_relayed_batch_blocks_ack);
+    RUN_TEST(test_unknown_relayed_board_ignored);
+    return UNITY_END();
+}
+
+int main() {
+    return runTests();
+}
@@ -0,0 +1,673 @@
+// ==========================================
+// SIMULATEUR DE FLOTTE (PC)
+// ==========================================
+// Simulation à événements discrets, en temps virtuel (ms), d'un maître et de
+// N esclaves sur plusieurs mois : dérive des horloges RTC, pertes radio,
+// fenêtres de scan/advertising, tentatives de connexion et fenêtres Android.
+//
+// Le cycle du maître (BOOT/TIME -> SCAN -> SCAN_SLAVES -> PROCESS_DATA ->
+// WAIT_ANDROID -> sommeil) est modélisé ici ; les décisions, elles, viennent
+// des mêmes en-têtes que le firmware : schedule.h (fenêtre Android, timeout
+// adaptatif, backoff, envoi par lots), records.h (déduplication par fenêtre
+// de séquences) et format.h (calendrier du maître).
+//
+// Usage : fleetsim [--clé valeur]... [--csv fichier]   (--help pour la liste)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <algorithm>
+#include <queue>
+#include <random>
+#include <vector>
+#include <config.h>
+#include <records.h>
+#include <format.h>
+#include <schedule.h>
+
+#define MAX_TIMEOUT_COUNT 3           // Valeur par défaut du firmware (src/main.cpp)
+
+// ==========================================
+// PARAMÈTRES
+// ==========================================
+// Tous surchargeables en ligne de commande (--sleepMinutes 15 ...).
+// Courants moyens en mA par état, durées en ms sauf mention contraire.
+struct SimParams {
+    double slaves = 50;
+    double days = 365;
+    double seed = 1;
+
+    // Configuration d'exécution (mêmes défauts que RuntimeConfig)
+    double sleepMinutes = SLEEP_TIME_MINUTES;
+    double scanSeconds = BLE_SCAN_TIME;
+    double advertiseSeconds = BLE_ADVERTISE_TIME;
+    double scanIntervalMs = BLE_SCAN_INTERVAL_MS;
+    double scanWindowMs = BLE_SCAN_WINDOW_MS;
+    double syncPeriodMinutes = ANDROID_SYNC_PERIOD_MINUTES;
+    double maxTimeouts = MAX_TIMEOUT_COUNT;
+    double androidWaitSeconds = ANDROID_WAIT_TIMEOUT_S;
+    double concurrency = ACQUISITION_CONCURRENCY;
+
+    // Environnement
+    double driftPpm = 200;            // Écart-type de la dérive RTC (ppm)
+    double loss = 0.05;               // Taux de perte moyen (annonce, connexion, acquittement)
+    double phoneProbability = 0;      // Probabilité qu'un téléphone se connecte pendant une fenêtre
+    double phoneSyncSeconds = 30;     // Durée d'une synchronisation Android
+
+    // Durées
+    double advIntervalMs = 100;       // Intervalle d'advertising des esclaves
+    double connectMs = 400;           // Latence moyenne d'ouverture de connexion
+    double readMs = 150;              // Lecture du lot + acquittement
+    double masterBootMs = 400;        // Démarrage + état TIME
+    double sdBaseMs = 40;             // PROCESS_DATA : ouverture des fichiers
+    double sdRecordMs = 1.5;          // PROCESS_DATA : par mesure écrite
+    double sleepPrepMs = 30;
+    double slaveBootMs = 150;         // Démarrage esclave (hors rafale capteurs)
+
+    // Courants (mA)
+    double maBoot = 50;
+    double maScan = 100;
+    double maAcquire = 110;
+    double maProcess = 70;
+    double maAndroid = 60;
+    double maMasterSleep = 0.15;
+    double maSlaveAwake = 45;
+    double maSlaveAdv = 40;
+    double maSlaveSleep = 0.01;
+    double batteryMah = 3000;
+};
+
+struct ParamField {
+    const char* key;
+    double SimParams::* field;
+    const char* help;
+};
+
+static const ParamField PARAM_FIELDS[] = {
+    {"slaves",             &SimParams::slaves,             "simulated slave boards"},
+    {"days",               &SimParams::days,               "virtual days"},
+    {"seed",               &SimParams::seed,               "random seed"},
+    {"sleepMinutes",       &SimParams::sleepMinutes,       "master/slave sleep (min)"},
+    {"scanSeconds",        &SimParams::scanSeconds,        "master scan (s)"},
+    {"advertiseSeconds",   &SimParams::advertiseSeconds,   "slave advertising (s)"},
+    {"scanIntervalMs",     &SimParams::scanIntervalMs,     "scan interval (ms)"},
+    {"scanWindowMs",       &SimParams::scanWindowMs,       "scan window (ms)"},
+    {"syncPeriodMinutes",  &SimParams::syncPeriodMinutes,  "Android window period (min, 0 = off)"},
+    {"maxTimeouts",        &SimParams::maxTimeouts,        "Android wait timeouts per window"},
+    {"androidWaitSeconds", &SimParams::androidWaitSeconds, "Android wait timeout (s)"},
+    {"concurrency",        &SimParams::concurrency,        "concurrent GATT connections"},
+    {"driftPpm",           &SimParams::driftPpm,           "RTC drift standard deviation (ppm)"},
+    {"loss",               &SimParams::loss,               "mean packet loss rate (0-1)"},
+    {"phoneProbability",   &SimParams::phoneProbability,   "chance a phone syncs in a window (0-1)"},
+    {"phoneSyncSeconds",   &SimParams::phoneSyncSeconds,   "Android sync duration (s)"},
+    {"advIntervalMs",      &SimParams::advIntervalMs,      "slave advertising interval (ms)"},
+    {"connectMs",          &SimParams::connectMs,          "mean connection latency (ms)"},
+    {"readMs",             &SimParams::readMs,             "batch read + ack (ms)"},
+    {"masterBootMs",       &SimParams::masterBootMs,       "master boot + TIME (ms)"},
+    {"sdBaseMs",           &SimParams::sdBaseMs,           "PROCESS_DATA fixed cost (ms)"},
+    {"sdRecordMs",         &SimParams::sdRecordMs,         "PROCESS_DATA per record (ms)"},
+    {"sleepPrepMs",        &SimParams::sleepPrepMs,        "PREPARE_SLEEP (ms)"},
+    {"slaveBootMs",        &SimParams::slaveBootMs,        "slave boot excluding sensor burst (ms)"},
+    {"maBoot",             &SimParams::maBoot,             "master boot/TIME current (mA)"},
+    {"maScan",             &SimParams::maScan,             "master scan current (mA)"},
+    {"maAcquire",          &SimParams::maAcquire,          "master acquisition current (mA)"},
+    {"maProcess",          &SimParams::maProcess,          "master SD current (mA)"},
+    {"maAndroid",          &SimParams::maAndroid,          "master Android window current (mA)"},
+    {"maMasterSleep",      &SimParams::maMasterSleep,      "master deep sleep current (mA)"},
+    {"maSlaveAwake",       &SimParams::maSlaveAwake,       "slave boot/sensors current (mA)"},
+    {"maSlaveAdv",         &SimParams::maSlaveAdv,         "slave advertising/connected current (mA)"},
+    {"maSlaveSleep",       &SimParams::maSlaveSleep,       "slave deep sleep current (mA)"},
+    {"batteryMah",         &SimParams::batteryMah,         "battery capacity for autonomy (mAh)"},
+};
+
+#define PARAM_COUNT (sizeof(PARAM_FIELDS) / sizeof(PARAM_FIELDS[0]))
+
+// États du maître pour le temps d'éveil et l'énergie
+enum SimState { ST_BOOT, ST_SCAN, ST_ACQUIRE, ST_PROCESS, ST_ANDROID, ST_SLEEP_PREP, ST_COUNT };
+static const char* STATE_NAMES[ST_COUNT] = {"boot", "scan", "acquire", "process", "android", "sleep_prep"};
+
+// ==========================================
+// MODÈLE
+// ==========================================
+// Statistiques de lien, mêmes règles que recordConnectResult() du maître
+struct SimLink {
+    uint32_t attempts;
+    uint32_t failures;
+    uint32_t connectMs;
+    uint8_t failureRate;
+};
+
+struct SimSlave {
+    int id;
+    double periodScale;               // 1 + dérive RTC
+    double driftPpm;
+    double loss;
+    int rssi;
+
+    // Tampon RTC (ReadingBuffer) : séquences [oldestSeq, oldestSeq + count)
+    uint16_t nextSeq;
+    uint16_t oldestSeq;
+    uint8_t count;
+    uint8_t cyclesSinceUpload;
+
+    // Réveil et fenêtre d'advertising en cours
+    int64_t nextWake;
+    bool advertising;
+    int64_t advStart;
+    int64_t advEnd;
+    int64_t detectedAt;
+
+    SimLink link;
+    SeqWindow window;                 // Côté maître
+
+    // Résultats
+    uint32_t produced;
+    uint32_t delivered;
+    uint32_t duplicates;
+    uint32_t dropped;
+    uint32_t windows;
+    uint32_t missedWindows;
+    double awakeMs;
+    double advMs;
+};
+
+struct SimMaster {
+    int64_t nextWake;
+    double periodScale;
+    DateTime calendar;
+    uint32_t cycles;
+    uint32_t androidWindows;
+    uint32_t phoneSyncs;
+    uint32_t connectAttempts;
+    uint32_t connectFailures;
+    uint32_t budgetSkips;
+    double stateMs[ST_COUNT];
+};
+
+static SimParams params;
+static std::mt19937_64 rng;
+
+static double uniform() {
+    return std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+}
+
+static double normal(double sigma) {
+    return std::normal_distribution<double>(0.0, sigma)(rng);
+}
+
+static int64_t sleepMs(double scale) {
+    return (int64_t)(params.sleepMinutes * 60000.0 * scale);
+}
+
+// ==========================================
+// ESCLAVE
+// ==========================================
+// Fenêtre non servie : l'esclave a diffusé jusqu'au bout puis s'est endormi
+static void closeMissedWindow(SimSlave& s) {
+    if (!s.advertising) return;
+    s.advertising = false;
+    s.missedWindows++;
+    s.advMs += (double)(s.advEnd - s.advStart);
+}
+
+// Réveil : mesure, mise en tampon (ReadingBuffer::push) et décision d'envoi
+static void slaveWake(SimSlave& s) {
+    int64_t t = s.nextWake;
+    closeMissedWindow(s);
+
+    double activeMs = params.slaveBootMs + SENSOR_BURST_BUDGET_MS;
+    s.awakeMs += activeMs;
+    int64_t ready = t + (int64_t)activeMs;
+
+    s.cyclesSinceUpload++;
+    if (s.count == SLAVE_BUFFER_CAPACITY) {
+        s.oldestSeq++;
+        s.count--;
+        s.dropped++;
+    }
+    s.nextSeq++;
+    s.count++;
+    s.produced++;
+
+    if (uploadDue(s.count, s.cyclesSinceUpload)) {
+        s.advertising = true;
+        s.advStart = ready;
+        s.advEnd = ready + (int64_t)(params.advertiseSeconds * 1000.0);
+        s.detectedAt = -1;
+        s.windows++;
+        s.nextWake = s.advEnd + sleepMs(s.periodScale);
+    } else {
+        s.nextWake = ready + sleepMs(s.periodScale);
+    }
+}
+
+// Première annonce reçue pendant le scan, -1 si aucune
+static int64_t detectSlave(const SimSlave& s, int64_t scanStart, int64_t scanEnd) {
+    int64_t from = std::max(s.advStart, scanStart);
+    int64_t to = std::min(s.advEnd, scanEnd);
+    if (from >= to) return -1;
+
+    double duty = params.scanWindowMs / params.scanIntervalMs;
+    double p = (1.0 - s.loss) * (duty > 1.0 ? 1.0 : duty);
+
+    // advDelay BLE : 0-10 ms aléatoires ajoutés à chaque annonce
+    double t = (double)from + uniform() * params.advIntervalMs;
+    while (t < (double)to) {
+        if (uniform() < p) return (int64_t)t;
+        t += params.advIntervalMs + uniform() * 10.0;
+    }
+    return -1;
+}
+
+// ==========================================
+// MAÎTRE : ACQUISITION
+// ==========================================
+static void recordConnectResult(SimLink& link, bool success, uint32_t latencyMs) {
+    link.attempts++;
+    if (success) {
+        link.connectMs = (link.attempts - link.failures == 1)
+            ? latencyMs
+            : (link.connectMs * 3 + latencyMs) / 4;
+        link.failureRate = (link.failureRate * 7) / 8;
+    } else {
+        link.failures++;
+        link.failureRate = (link.failureRate * 7 + 100) / 8;
+    }
+}
+
+// Lecture du lot : déduplication par séquence, acquittement éventuellement perdu
+static uint32_t deliverBatch(SimSlave& s) {
+    for (uint8_t i = 0; i < s.count; i++) {
+        if (seqWindowAccept(s.window, (uint16_t)(s.oldestSeq + i))) {
+            s.delivered++;
+        } else {
+            s.duplicates++;
+        }
+    }
+    uint32_t records = s.count;
+
+    if (uniform() >= s.loss) {
+        s.oldestSeq = s.nextSeq;
+        s.count = 0;
+        s.cyclesSinceUpload = 0;
+    }
+    return records;
+}
+
+struct AcqEvent {
+    int64_t time;
+    int slave;                        // -1 : tâche libre
+    int attempt;
+    bool operator>(const AcqEvent& other) const { return time > other.time; }
+};
+
+// Tâches d'acquisition parallèles, ouverture de connexion sérialisée
+// (connectMutex), tentatives avec backoff dans le budget du cycle.
+// Retourne la fin de l'acquisition, records reçoit le nombre de mesures lues.
+static int64_t acquire(std::vector<SimSlave>& slaves, std::vector<int>& order,
+                       int64_t start, SimMaster& master, uint32_t* records) {
+    *records = 0;
+    if (order.empty()) return start;
+
+    // orderSlavesByLinkQuality()
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return slaves[a].rssi - slaves[a].link.failureRate / 5 >
+               slaves[b].rssi - slaves[b].link.failureRate / 5;
+    });
+
+    int64_t deadline = start + ACQUISITION_BUDGET_MS;
+    int64_t mutexFree = start;
+    int64_t end = start;
+    size_t next = 0;
+
+    std::priority_queue<AcqEvent, std::vector<AcqEvent>, std::greater<AcqEvent> > events;
+    int tasks = std::max(1, (int)params.concurrency);
+    for (int i = 0; i < tasks; i++) {
+        events.push(AcqEvent{start, -1, 0});
+    }
+
+    while (!events.empty()) {
+        AcqEvent e = events.top();
+        events.pop();
+
+        if (e.slave < 0) {
+            if (next < order.size()) {
+                events.push(AcqEvent{e.time, order[next++], 1});
+            } else {
+                end = std::max(end, e.time);
+            }
+            continue;
+        }
+
+        SimSlave& s = slaves[e.slave];
+        int64_t timeoutMs = connectTimeoutMs(s.link.attempts != s.link.failures, s.link.connectMs);
+
+        // Pas assez de temps pour une tentative complète
+        if (deadline - e.time < timeoutMs) {
+            master.budgetSkips++;
+            events.push(AcqEvent{e.time, -1, 0});
+            continue;
+        }
+
+        int64_t grant = std::max(e.time, mutexFree);
+        uint32_t latencyMs = (uint32_t)(params.connectMs * (0.6 + 0.8 * uniform()));
+        bool success = latencyMs < timeoutMs &&
+                       grant + latencyMs < s.advEnd &&
+                       uniform() >= s.loss;
+
+        master.connectAttempts++;
+        recordConnectResult(s.link, success, latencyMs);
+
+        if (success) {
+            mutexFree = grant + latencyMs;
+            int64_t readEnd = mutexFree + (int64_t)params.readMs;
+            *records += deliverBatch(s);
+
+            // L'esclave se déconnecte et se rendort
+            s.advertising = false;
+            s.advMs += (double)(readEnd - s.advStart);
+            s.nextWake = readEnd + sleepMs(s.periodScale);
+            events.push(AcqEvent{readEnd, -1, 0});
+        } else {
+            master.connectFailures++;
+            mutexFree = grant + timeoutMs;
+            if (e.attempt < SLAVE_MAX_ATTEMPTS) {
+                events.push(AcqEvent{mutexFree + retryBackoffMs(e.attempt), e.slave, e.attempt + 1});
+            } else {
+                events.push(AcqEvent{mutexFree, -1, 0});
+            }
+        }
+    }
+
+    return end;
+}
+
+// ==========================================
+// MAÎTRE : CYCLE COMPLET
+// ==========================================
+static void masterCycle(SimMaster& master, std::vector<SimSlave>& slaves) {
+    int64_t t = master.nextWake;
+    master.cycles++;
+
+    // BOOT + TIME (le calendrier avance de sleepMinutes, comme incrementDateTime)
+    master.stateMs[ST_BOOT] += params.masterBootMs;
+    t += (int64_t)params.masterBootMs;
+    advanceDateTime(master.calendar, (int)(params.sleepMinutes * 60));
+
+    // SCAN : les esclaves réveillés d'ici la fin du scan ont ouvert leur fenêtre
+    int64_t scanStart = t;
+    int64_t scanEnd = scanStart + (int64_t)(params.scanSeconds * 1000.0);
+    for (SimSlave& s : slaves) {
+        while (s.nextWake <= scanEnd) {
+            slaveWake(s);
+        }
+    }
+
+    std::vector<int> found;
+    int64_t lastDetection = scanStart;
+    for (SimSlave& s : slaves) {
+        if (!s.advertising) continue;
+        s.detectedAt = detectSlave(s, scanStart, scanEnd);
+        if (s.detectedAt >= 0) {
+            found.push_back(s.id);
+            lastDetection = std::max(lastDetection, s.detectedAt);
+        }
+    }
+
+    // BLE_SCAN_MODE 2 : arrêt anticipé quand tous les esclaves connus sont vus
+    if (BLE_SCAN_MODE == 2 && found.size() == slaves.size()) {
+        scanEnd = lastDetection;
+    }
+    master.stateMs[ST_SCAN] += (double)(scanEnd - scanStart);
+
+    // SCAN_SLAVES
+    uint32_t records = 0;
+    int64_t acqEnd = acquire(slaves, found, scanEnd, master, &records);
+    master.stateMs[ST_ACQUIRE] += (double)(acqEnd - scanEnd);
+    t = acqEnd;
+
+    // PROCESS_DATA
+    double processMs = params.sdBaseMs + params.sdRecordMs * records;
+    master.stateMs[ST_PROCESS] += processMs;
+    t += (int64_t)processMs;
+
+    // WAIT_ANDROID
+    if (syncWindowDue(master.calendar, (uint16_t)params.syncPeriodMinutes,
+                      (uint16_t)params.sleepMinutes, ANDROID_SYNC_HOURS_MASK)) {
+        master.androidWindows++;
+        double windowMs;
+        if (uniform() < params.phoneProbability) {
+            master.phoneSyncs++;
+            windowMs = params.phoneSyncSeconds * 1000.0;
+        } else {
+            windowMs = params.maxTimeouts * params.androidWaitSeconds * 1000.0;
+        }
+        master.stateMs[ST_ANDROID] += windowMs;
+        t += (int64_t)windowMs;
+    }
+
+    // PREPARE_SLEEP : durée fixe, comptée à partir de la fin du cycle
+    master.stateMs[ST_SLEEP_PREP] += params.sleepPrepMs;
+    t += (int64_t)params.sleepPrepMs;
+    master.nextWake = t + sleepMs(master.periodScale);
+}
+
+// ==========================================
+// LIGNE DE COMMANDE
+// ==========================================
+static void printUsage() {
+    SimParams defaults;
+    printf("Usage: fleetsim [--<param> <value>]... [--csv <file>]\n\n");
+    for (size_t i = 0; i < PARAM_COUNT; i++) {
+        printf("  --%-20s %10g  %s\n", PARAM_FIELDS[i].key,
+               defaults.*(PARAM_FIELDS[i].field), PARAM_FIELDS[i].help);
+    }
+}
+
+static bool parseArgs(int argc, char** argv, const char** csvPath) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+            printUsage();
+            exit(0);
+        }
+        if (strncmp(arg, "--", 2) != 0 || i + 1 >= argc) {
+            fprintf(stderr, "[SIM] Bad argument: %s\n", arg);
+            return false;
+        }
+        const char* key = arg + 2;
+        const char* value = argv[++i];
+
+        if (strcmp(key, "csv") == 0) {
+            *csvPath = value;
+            continue;
+        }
+
+        bool known = false;
+        for (size_t f = 0; f < PARAM_COUNT; f++) {
+            if (strcmp(key, PARAM_FIELDS[f].key) == 0) {
+                char* endPtr;
+                double parsed = strtod(value, &endPtr);
+                if (*endPtr != '\0') {
+                    fprintf(stderr, "[SIM] Bad value for %s: %s\n", key, value);
+                    return false;
+                }
+                params.*(PARAM_FIELDS[f].field) = parsed;
+                known = true;
+                break;
+            }
+        }
+        if (!known) {
+            fprintf(stderr, "[SIM] Unknown parameter: %s\n", key);
+            return false;
+        }
+    }
+
+    if (params.slaves < 1 || params.days <= 0 || params.sleepMinutes < 1 ||
+        params.scanIntervalMs <= 0 || params.advIntervalMs <= 0) {
+        fprintf(stderr, "[SIM] Invalid parameters\n");
+        return false;
+    }
+    return true;
+}
+
+// ==========================================
+// RAPPORT
+// ==========================================
+static void writeCsv(const char* path, const std::vector<SimSlave>& slaves, double days) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "[SIM] Cannot write %s\n", path);
+        return;
+    }
+    fprintf(file, "slave,produced,delivered,duplicates,dropped,pending,delivery_ratio,"
+                  "windows,missed_windows,mah_per_day,drift_ppm,loss,rssi\n");
+    for (const SimSlave& s : slaves) {
+        double mah = (s.awakeMs * params.maSlaveAwake + s.advMs * params.maSlaveAdv +
+                      (days * 86400000.0 - s.awakeMs - s.advMs) * params.maSlaveSleep) / 3600000.0;
+        fprintf(file, "%d,%u,%u,%u,%u,%u,%.4f,%u,%u,%.3f,%.1f,%.3f,%d\n",
+                s.id + 1, s.produced, s.delivered, s.duplicates, s.dropped, s.count,
+                s.produced ? (double)s.delivered / s.produced : 0.0,
+                s.windows, s.missedWindows, mah / days, s.driftPpm, s.loss, s.rssi);
+    }
+    fclose(file);
+}
+
+static void printReport(const SimMaster& master, const std::vector<SimSlave>& slaves,
+                        double days, double elapsedS) {
+    double dayMs = 86400000.0;
+    double totalMs = days * dayMs;
+    const double currents[ST_COUNT] = {params.maBoot, params.maScan, params.maAcquire,
+                                       params.maProcess, params.maAndroid, params.maBoot};
+
+    printf("fleetsim: %d slaves, %.0f days, sleep %.0f min, scan %.0f s, advertise %.0f s, "
+           "loss %.0f %%, drift %.0f ppm\n\n",
+           (int)slaves.size(), days, params.sleepMinutes, params.scanSeconds,
+           params.advertiseSeconds, params.loss * 100.0, params.driftPpm);
+
+    double awakeMs = 0;
+    double masterMah = 0;
+    for (int i = 0; i < ST_COUNT; i++) {
+        awakeMs += master.stateMs[i];
+        masterMah += master.stateMs[i] * currents[i] / 3600000.0;
+    }
+    masterMah += (totalMs - awakeMs) * params.maMasterSleep / 3600000.0;
+
+    printf("Master\n");
+    printf("  cycles           %u (%.1f / day)\n", master.cycles, master.cycles / days);
+    printf("  awake            %.0f s/day (%.2f %%)\n", awakeMs / days / 1000.0,
+           100.0 * awakeMs / totalMs);
+    for (int i = 0; i < ST_COUNT; i++) {
+        printf("    %-12s   %8.1f s/day  %7.2f mAh/day\n", STATE_NAMES[i],
+               master.stateMs[i] / days / 1000.0,
+               master.stateMs[i] * currents[i] / 3600000.0 / days);
+    }
+    printf("    %-12s   %8.1f s/day  %7.2f mAh/day\n", "deep_sleep",
+           (totalMs - awakeMs) / days / 1000.0,
+           (totalMs - awakeMs) * params.maMasterSleep / 3600000.0 / days);
+    printf("  energy           %.2f mAh/day (%.0f days on %.0f mAh)\n",
+           masterMah / days, params.batteryMah / (masterMah / days), params.batteryMah);
+    printf("  connections      %u attempts, %u failed, %u skipped (cycle budget)\n",
+           master.connectAttempts, master.connectFailures, master.budgetSkips);
+    printf("  android windows  %u (%u with a phone)\n", master.androidWindows, master.phoneSyncs);
+
+    // Le calendrier avance de sleepMinutes par cycle alors que la période réelle
+    // vaut sommeil + éveil (+ dérive RTC)
+    double calendarMin = (double)master.cycles * params.sleepMinutes;
+    double realMin = (double)master.nextWake / 60000.0;
+    printf("  calendar lag     %.0f min after %.0f days\n\n", realMin - calendarMin, days);
+
+    uint64_t produced = 0, delivered = 0, duplicates = 0, dropped = 0, pending = 0;
+    double worstRatio = 1.0, bestRatio = 0.0, maxMah = 0.0, sumMah = 0.0;
+    std::vector<std::pair<double, int> > ratios;
+    for (const SimSlave& s : slaves) {
+        produced += s.produced;
+        delivered += s.delivered;
+        duplicates += s.duplicates;
+        dropped += s.dropped;
+        pending += s.count;
+        double ratio = s.produced ? (double)s.delivered / s.produced : 0.0;
+        worstRatio = std::min(worstRatio, ratio);
+        bestRatio = std::max(bestRatio, ratio);
+        ratios.push_back(std::make_pair(ratio, s.id));
+
+        double mah = (s.awakeMs * params.maSlaveAwake + s.advMs * params.maSlaveAdv +
+                      (totalMs - s.awakeMs - s.advMs) * params.maSlaveSleep) / 3600000.0 / days;
+        sumMah += mah;
+        maxMah = std::max(maxMah, mah);
+    }
+
+    printf("Slaves\n");
+    printf("  readings         %llu produced, %llu delivered, %llu pending, %llu dropped (buffer full)\n",
+           (unsigned long long)produced, (unsigned long long)delivered,
+           (unsigned long long)pending, (unsigned long long)dropped);
+    printf("  duplicates       %llu (lost acks, removed by sequence window)\n",
+           (unsigned long long)duplicates);
+    printf("  delivery ratio   min %.4f  mean %.4f  max %.4f\n",
+           worstRatio, produced ? (double)delivered / produced : 0.0, bestRatio);
+    printf("  energy           mean %.2f mAh/day, max %.2f mAh/day\n",
+           sumMah / slaves.size(), maxMah);
+
+    std::sort(ratios.begin(), ratios.end());
+    printf("  worst slaves    ");
+    for (size_t i = 0; i < ratios.size() && i < 5; i++) {
+        const SimSlave& s = slaves[ratios[i].second];
+        printf(" #%d %.3f (%d dBm, %.0f ppm)%s", s.id + 1, ratios[i].first, s.rssi, s.driftPpm,
+               (i + 1 < ratios.size() && i < 4) ? "," : "");
+    }
+    printf("\n\nSimulated in %.2f s\n", elapsedS);
+}
+
+// ==========================================
+// MAIN
+// ==========================================
+int main(int argc, char** argv) {
+    const char* csvPath = nullptr;
+    if (!parseArgs(argc, argv, &csvPath)) {
+        printUsage();
+        return 1;
+    }
+    rng.seed((uint64_t)params.seed);
+    clock_t started = clock();
+
+    // Réveils des esclaves répartis sur la première période
+    std::vector<SimSlave> slaves((size_t)params.slaves);
+    for (size_t i = 0; i < slaves.size(); i++) {
+        SimSlave& s = slaves[i];
+        memset(&s, 0, sizeof(s));
+        s.id = (int)i;
+        s.driftPpm = normal(params.driftPpm);
+        s.periodScale = 1.0 + s.driftPpm * 1e-6;
+        s.loss = std::min(1.0, params.loss * 2.0 * uniform());
+        s.rssi = -50 - (int)(45 * uniform());
+        s.nextWake = (int64_t)(uniform() * sleepMs(1.0));
+        s.detectedAt = -1;
+    }
+
+    SimMaster master;
+    memset(&master, 0, sizeof(master));
+    master.periodScale = 1.0 + normal(params.driftPpm) * 1e-6;
+    parseISO8601("2026-01-01T00:00:00", &master.calendar);
+
+    int64_t endMs = (int64_t)(params.days * 86400000.0);
+    while (master.nextWake < endMs) {
+        masterCycle(master, slaves);
+    }
+
+    // Esclaves jusqu'à la fin de la simulation
+    for (SimSlave& s : slaves) {
+        while (s.nextWake < endMs) {
+            slaveWake(s);
+        }
+        closeMissedWindow(s);
+    }
+
+    double elapsedS = (double)(clock() - started) / CLOCKS_PER_SEC;
+    printReport(master, slaves, params.days, elapsedS);
+    if (csvPath) {
+        writeCsv(csvPath, slaves, params.days);
+    }
+    return 0;
+}
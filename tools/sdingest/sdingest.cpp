@@ -0,0 +1,771 @@
+// ==========================================
+// INGESTION DES CARTES SD (PC)
+// ==========================================
+// Relit en fin de saison le contenu d'une ou plusieurs cartes SD du maître
+// (carte montée, ou copie de ses fichiers) et produit une seule série
+// chronologique, toutes cartes et tous niveaux confondus :
+//   /master.csv                      température du maître (carte 0)
+//   /<carte>.csv                     mesures brutes récentes (+ colonne qualité)
+//   /<carte>/rAAAAMM.gor + .idx      mesures brutes compactées (lib/Gorilla)
+//   /<carte>/hAAAAMM.csv             moyennes horaires (lib/Retention)
+//   /<carte>/dAAAA.csv               moyennes journalières
+// Les noms et colonnes des cartes viennent de lib/Schema ; chaque CSV est
+// lu d'après son propre en-tête (anciens fichiers sans colonne qualité,
+// maître à une seule colonne).
+//
+// Les fichiers sont projetés en mémoire (mmap) et découpés en tranches de
+// lignes entières, lues en parallèle (une tâche par tranche ou par fichier
+// de blocs). Une ligne tronquée par une coupure (pas de ';' final, octets
+// nuls de la FAT, mesure suivante collée derrière) est réparée quand une
+// mesure complète y commence, sinon ignorée. Les tranches, déjà triées,
+// sont fusionnées deux à deux en parallèle puis les doublons (même date,
+// carte et niveau, ex. compaction interrompue avant la recopie du CSV)
+// sont éliminés.
+//
+// Sorties : <préfixe>.csv (une ligne par mesure) et <préfixe>.col (colonnes
+// binaires contiguës, voir writeColumns).
+//
+// Une image brute de la carte se monte en lecture seule avant l'ingestion :
+//   sudo mount -o loop,ro carte.img /mnt/carte && sdingest /mnt/carte
+//
+// Usage : sdingest [--out préfixe] [--threads n] [--format csv|col|both] racine...
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <strings.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <format.h>
+#include <schema.h>
+#include <gorilla.h>
+#include <compaction.h>
+#include <screening.h>
+#include <retention.h>
+
+#define CHUNK_BYTES (16u << 20)         // Tranche de CSV lue par une tâche
+#define MAX_COLUMNS 8                   // Colonnes d'un CSV après la date
+#define MASTER_BOARD 0                  // Carte du fichier /master.csv
+
+// Une mesure de la série : valeurs et qualité indexées par SensorField
+struct Row {
+    uint32_t time;                      // Secondes depuis 1970 (heure locale du maître)
+    uint8_t board;
+    uint8_t tier;                       // RetentionTier
+    uint16_t quality;                   // 4 bits par champ, QUALITY_UNKNOWN (lib/Screening) pour
+                                        // un agrégat ou une colonne qualité absente ou illisible
+    int32_t values[FIELD_COUNT];        // Centièmes, CSV_NO_VALUE si absente
+};
+
+static bool rowBefore(const Row& a, const Row& b) {
+    if (a.time != b.time) return a.time < b.time;
+    if (a.board != b.board) return a.board < b.board;
+    return a.tier < b.tier;
+}
+
+static bool sameKey(const Row& a, const Row& b) {
+    return a.time == b.time && a.board == b.board && a.tier == b.tier;
+}
+
+// ==========================================
+// FICHIERS PROJETÉS EN MÉMOIRE
+// ==========================================
+struct MappedFile {
+    std::string path;
+    const char* data;
+    size_t size;
+    uint8_t board;
+    uint8_t tier;
+    bool blocks;                        // .gor (+ .idx), sinon CSV
+
+    // Colonnes du CSV d'après son en-tête
+    size_t bodyStart;
+    int8_t columns[MAX_COLUMNS];        // SensorField de chaque colonne, -1 si inconnue
+    uint8_t numeric;                    // Colonnes de valeurs
+    bool hasQuality;                    // Colonne "qualite" après les valeurs
+};
+
+static bool mapFile(MappedFile& file) {
+    int fd = open(file.path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return false;
+    }
+    file.size = info.st_size;
+    file.data = nullptr;
+    if (file.size > 0) {
+        void* data = mmap(nullptr, file.size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        madvise(data, file.size, MADV_SEQUENTIAL);
+        file.data = (const char*)data;
+    }
+    close(fd);
+    return true;
+}
+
+static void unmapFile(MappedFile& file) {
+    if (file.data) munmap((void*)file.data, file.size);
+    file.data = nullptr;
+}
+
+// Colonnes par défaut (fichier sans en-tête) : celles du schéma de la carte
+static void schemaColumns(MappedFile& file) {
+    if (file.board == MASTER_BOARD) {
+        file.numeric = 1;
+        file.columns[0] = FIELD_TEMPERATURE;
+    } else {
+        file.numeric = boardFieldCount(file.board);
+        for (uint8_t n = 0; n < file.numeric; n++) file.columns[n] = boardField(file.board, n);
+    }
+    file.hasQuality = file.board != MASTER_BOARD && file.tier == TIER_RAW;
+}
+
+// En-tête "date;temperature;humidity;...;[qualite;]" : une colonne par champ connu
+static void parseHeader(MappedFile& file) {
+    file.bodyStart = 0;
+    schemaColumns(file);
+    if (file.size < 5 || strncmp(file.data, "date;", 5) != 0) return;
+
+    const char* end = (const char*)memchr(file.data, '\n', file.size);
+    size_t length = end ? end - file.data : file.size;
+    file.bodyStart = end ? length + 1 : file.size;
+    file.numeric = 0;
+    file.hasQuality = false;
+
+    const char* p = file.data + 5;
+    const char* stop = file.data + length;
+    while (p < stop && file.numeric < MAX_COLUMNS && !file.hasQuality) {
+        const char* semicolon = (const char*)memchr(p, ';', stop - p);
+        if (!semicolon) break;
+        size_t nameLength = semicolon - p;
+        if (nameLength == 7 && strncmp(p, "qualite", 7) == 0) {
+            file.hasQuality = true;
+        } else {
+            int8_t field = -1;
+            for (uint8_t f = 0; f < FIELD_COUNT; f++) {
+                if (strlen(FIELD_SPECS[f].column) == nameLength &&
+                    strncmp(p, FIELD_SPECS[f].column, nameLength) == 0) {
+                    field = f;
+                }
+            }
+            file.columns[file.numeric++] = field;
+        }
+        p = semicolon + 1;
+    }
+}
+
+// ==========================================
+// LECTURE DES CSV
+// ==========================================
+struct IngestStats {
+    uint64_t rows = 0;
+    uint64_t repaired = 0;              // Lignes tronquées dont la fin a été récupérée
+    uint64_t dropped = 0;               // Fragments inutilisables
+};
+
+struct Task {
+    MappedFile* file;
+    size_t begin;
+    size_t end;
+    std::vector<Row> rows;
+    IngestStats stats;
+};
+
+// Mesure complète commençant en line ; false si la ligne est tronquée
+static bool parseLine(const MappedFile& file, const char* line, const char* end, Row& row) {
+    // Fin de ligne attendue : "...;" (+ '\r' des println)
+    const char* last = end;
+    while (last > line && (last[-1] == '\r' || last[-1] == '\0')) last--;
+    if (last - line < ISO8601_LENGTH + 2 || last[-1] != ';') return false;
+
+    // parseCsvRow s'arrête au '\n' ; la dernière ligne du fichier peut ne pas en avoir
+    char copy[128];
+    if (end == file.data + file.size) {
+        size_t length = std::min((size_t)(last - line), sizeof(copy) - 1);
+        memcpy(copy, line, length);
+        copy[length] = '\0';
+        line = copy;
+    }
+
+    DateTime dt;
+    int32_t centi[MAX_COLUMNS];
+    if (parseCsvRow(line, &dt, centi, file.numeric) != file.numeric) return false;
+
+    row.time = (uint32_t)dateTimeToEpoch(dt);
+    row.board = file.board;
+    row.tier = file.tier;
+    for (uint8_t f = 0; f < FIELD_COUNT; f++) row.values[f] = CSV_NO_VALUE;
+    for (uint8_t c = 0; c < file.numeric; c++) {
+        if (file.columns[c] >= 0) row.values[file.columns[c]] = centi[c];
+    }
+
+    row.quality = QUALITY_UNKNOWN;
+    // Ligne tronquée avant sa colonne qualité ou code inconnu : qualité inconnue
+    uint16_t byColumn = file.hasQuality ? parseQualityColumn(line, file.numeric) : QUALITY_UNKNOWN;
+    if (byColumn != QUALITY_UNKNOWN) {
+        // Codes par colonne -> codes par champ
+        row.quality = 0;
+        for (uint8_t c = 0; c < file.numeric; c++) {
+            if (file.columns[c] >= 0) {
+                row.quality = withQuality(row.quality, file.columns[c], qualityCode(byColumn, c));
+            }
+        }
+    }
+    return true;
+}
+
+// Début d'une mesure complète dans un fragment ("...;6020-01-03T02:30:00;...")
+static const char* findRowStart(const char* line, const char* end) {
+    DateTime dt;
+    for (const char* p = line + 1; p + ISO8601_LENGTH < end; p++) {
+        if (*p >= '0' && *p <= '9' && p[ISO8601_LENGTH] == ';' && parseISO8601(p, &dt)) {
+            return p;
+        }
+    }
+    return nullptr;
+}
+
+static void readCsvChunk(Task& task) {
+    const MappedFile& file = *task.file;
+    const char* p = file.data + task.begin;
+    const char* stop = file.data + task.end;
+    task.rows.reserve((task.end - task.begin) / 40);
+
+    Row row;
+    while (p < stop) {
+        const char* newline = (const char*)memchr(p, '\n', stop - p);
+        const char* end = newline ? newline : stop;
+
+        if (end > p && !(end - p == 1 && *p == '\r')) {
+            if (parseLine(file, p, end, row)) {
+                task.rows.push_back(row);
+            } else {
+                const char* start = findRowStart(p, end);
+                if (start && parseLine(file, start, end, row)) {
+                    task.rows.push_back(row);
+                    task.stats.repaired++;
+                } else {
+                    task.stats.dropped++;
+                }
+            }
+        }
+        p = end + 1;
+    }
+    task.stats.rows = task.rows.size();
+}
+
+// ==========================================
+// LECTURE DES BLOCS COMPACTÉS
+// ==========================================
+// Seuls les blocs présents dans l'index sont lus (un bloc écrit sans son
+// entrée, après une coupure, est ignoré comme sur le maître).
+static void readBlocks(Task& task) {
+    const MappedFile& gor = *task.file;
+    std::string idxPath = gor.path.substr(0, gor.path.size() - 4) + ".idx";
+    MappedFile idx;
+    idx.path = idxPath;
+    if (!mapFile(idx)) {
+        task.stats.dropped++;
+        return;
+    }
+
+    uint8_t fields = boardFieldCount(gor.board);
+    size_t entries = idx.size / sizeof(ArchiveIndexEntry);
+    for (size_t i = 0; i < entries; i++) {
+        ArchiveIndexEntry entry;
+        memcpy(&entry, idx.data + i * sizeof(entry), sizeof(entry));
+        size_t dataStart = (size_t)entry.offset + sizeof(GorillaBlockHeader);
+        if (dataStart + entry.header.bytes > gor.size || entry.header.channels < fields) {
+            task.stats.dropped++;
+            continue;
+        }
+
+        GorillaDecoder decoder;
+        if (!decoder.begin(entry.header, (const uint8_t*)gor.data + dataStart)) {
+            task.stats.dropped++;
+            continue;
+        }
+        bool hasQuality = entry.header.channels > fields;
+        uint32_t time;
+        int32_t values[GORILLA_MAX_CHANNELS];
+        while (decoder.next(&time, values)) {
+            Row row;
+            row.time = time;
+            row.board = gor.board;
+            row.tier = TIER_RAW;
+            bool known = hasQuality && values[fields] != QUALITY_UNKNOWN;
+            row.quality = known ? 0 : QUALITY_UNKNOWN;
+            for (uint8_t f = 0; f < FIELD_COUNT; f++) row.values[f] = CSV_NO_VALUE;
+            for (uint8_t n = 0; n < fields; n++) {
+                uint8_t f = boardField(gor.board, n);
+                row.values[f] = values[n];
+                if (known) {
+                    row.quality = withQuality(row.quality, f, qualityCode((uint16_t)values[fields], n));
+                }
+            }
+            task.rows.push_back(row);
+        }
+    }
+    unmapFile(idx);
+    task.stats.rows = task.rows.size();
+}
+
+// ==========================================
+// RECHERCHE DES FICHIERS
+// ==========================================
+static bool hasSuffix(const char* name, const char* suffix) {
+    size_t length = strlen(name);
+    size_t suffixLength = strlen(suffix);
+    return length > suffixLength && strcasecmp(name + length - suffixLength, suffix) == 0;
+}
+
+static void addFile(std::vector<MappedFile>& files, const std::string& path, uint8_t board,
+                    uint8_t tier, bool blocks) {
+    MappedFile file;
+    memset(file.columns, -1, sizeof(file.columns));
+    file.path = path;
+    file.board = board;
+    file.tier = tier;
+    file.blocks = blocks;
+    file.data = nullptr;
+    file.size = 0;
+    file.bodyStart = 0;
+    file.numeric = 0;
+    file.hasQuality = false;
+    if (mapFile(file)) {
+        files.push_back(file);
+    } else {
+        fprintf(stderr, "[INGEST] Cannot read %s\n", path.c_str());
+    }
+}
+
+static void findFiles(const std::string& root, std::vector<MappedFile>& files) {
+    struct stat info;
+    std::string master = root + "/master.csv";
+    if (stat(master.c_str(), &info) == 0) addFile(files, master, MASTER_BOARD, TIER_RAW, false);
+
+    for (uint8_t boardId = 1; boardId <= SCHEMA_BOARDS; boardId++) {
+        const BoardSpec& board = BOARD_SPECS[boardId - 1];
+        std::string csv = root + board.file;
+        if (stat(csv.c_str(), &info) == 0) addFile(files, csv, boardId, TIER_RAW, false);
+
+        // Niveaux de rétention : /<carte>/rAAAAMM.gor, hAAAAMM.csv, dAAAA.csv
+        std::string dir = root + "/" + board.name;
+        DIR* handle = opendir(dir.c_str());
+        if (!handle) continue;
+        struct dirent* entry;
+        while ((entry = readdir(handle)) != nullptr) {
+            const char* name = entry->d_name;
+            for (uint8_t tier = 0; tier < TIER_COUNT; tier++) {
+                if ((name[0] | 0x20) != TIER_PREFIX[tier] || name[1] < '0' || name[1] > '9') continue;
+                if (tier == TIER_RAW ? hasSuffix(name, ".gor") : hasSuffix(name, ".csv")) {
+                    addFile(files, dir + "/" + name, boardId, tier, tier == TIER_RAW);
+                }
+            }
+        }
+        closedir(handle);
+    }
+}
+
+// Tranches d'un CSV, coupées après un '\n'
+static void splitFile(MappedFile& file, std::vector<Task>& tasks) {
+    if (file.blocks) {
+        Task task;
+        task.file = &file;
+        task.begin = 0;
+        task.end = file.size;
+        tasks.push_back(task);
+        return;
+    }
+
+    parseHeader(file);
+    size_t begin = file.bodyStart;
+    while (begin < file.size) {
+        size_t end = std::min(file.size, begin + CHUNK_BYTES);
+        if (end < file.size) {
+            const char* newline = (const char*)memchr(file.data + end, '\n', file.size - end);
+            end = newline ? newline - file.data + 1 : file.size;
+        }
+        Task task;
+        task.file = &file;
+        task.begin = begin;
+        task.end = end;
+        tasks.push_back(task);
+        begin = end;
+    }
+}
+
+// ==========================================
+// TRAITEMENT PARALLÈLE
+// ==========================================
+template <typename Work>
+static void parallelFor(size_t count, unsigned threads, Work work) {
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> pool;
+    unsigned workers = (unsigned)std::min<size_t>(threads, count);
+    for (unsigned t = 0; t < workers; t++) {
+        pool.push_back(std::thread([&]() {
+            for (size_t i = next++; i < count; i = next++) work(i);
+        }));
+    }
+    for (std::thread& thread : pool) thread.join();
+}
+
+// Fusion deux à deux des séries triées, chaque passe en parallèle. Les
+// tranches successives d'un même fichier se suivent déjà : elles sont
+// d'abord mises bout à bout.
+static std::vector<Row> mergeRuns(std::vector<std::vector<Row> >& runs, unsigned threads) {
+    std::vector<std::vector<Row> > joined;
+    for (std::vector<Row>& run : runs) {
+        if (!joined.empty() && !rowBefore(run.front(), joined.back().back())) {
+            joined.back().insert(joined.back().end(), run.begin(), run.end());
+            std::vector<Row>().swap(run);
+        } else {
+            joined.push_back(std::vector<Row>());
+            joined.back().swap(run);
+        }
+    }
+    runs.swap(joined);
+
+    while (runs.size() > 1) {
+        size_t pairs = runs.size() / 2;
+        std::vector<std::vector<Row> > merged(pairs + runs.size() % 2);
+        parallelFor(pairs, threads, [&](size_t i) {
+            std::vector<Row>& a = runs[2 * i];
+            std::vector<Row>& b = runs[2 * i + 1];
+            merged[i].resize(a.size() + b.size());
+            std::merge(a.begin(), a.end(), b.begin(), b.end(), merged[i].begin(), rowBefore);
+            std::vector<Row>().swap(a);
+            std::vector<Row>().swap(b);
+        });
+        if (runs.size() % 2) merged.back().swap(runs.back());
+        runs.swap(merged);
+    }
+    std::vector<Row> result;
+    if (!runs.empty()) result.swap(runs[0]);
+    return result;
+}
+
+// ==========================================
+// SORTIES
+// ==========================================
+// Date ISO 8601 sans snprintf (formatISO8601 reste la référence)
+static char* appendDigits(char* out, int value, int count) {
+    for (int i = count - 1; i >= 0; i--) {
+        out[i] = '0' + value % 10;
+        value /= 10;
+    }
+    return out + count;
+}
+
+static char* appendIsoTime(char* out, uint32_t time) {
+    DateTime dt = epochToDateTime(time);
+    out = appendDigits(out, dt.year, 4);
+    *out++ = '-';
+    out = appendDigits(out, dt.month, 2);
+    *out++ = '-';
+    out = appendDigits(out, dt.day, 2);
+    *out++ = 'T';
+    out = appendDigits(out, dt.hour, 2);
+    *out++ = ':';
+    out = appendDigits(out, dt.minute, 2);
+    *out++ = ':';
+    out = appendDigits(out, dt.second, 2);
+    return out;
+}
+
+// Valeur en centièmes -> "-12.34;" (ou "nan;")
+static char* appendCenti(char* out, int32_t value) {
+    if (value == CSV_NO_VALUE) {
+        memcpy(out, "nan;", 4);
+        return out + 4;
+    }
+    uint32_t magnitude = value < 0 ? -(uint32_t)value : value;
+    if (value < 0) *out++ = '-';
+    char digits[12];
+    int count = 0;
+    do {
+        digits[count++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude > 0 || count < 3);
+    while (count > 0) {
+        *out++ = digits[--count];
+        if (count == 2) *out++ = '.';
+    }
+    *out++ = ';';
+    return out;
+}
+
+static const char* boardName(uint8_t board) {
+    return board == MASTER_BOARD ? "master" : BOARD_SPECS[board - 1].name;
+}
+
+static const char* const TIER_NAMES[TIER_COUNT] = {"raw", "hourly", "daily"};
+
+// date;board;tier;<un champ par colonne>;qualite; (une lettre par champ, vide si inconnue)
+static bool writeCsv(const std::string& path, const std::vector<Row>& rows, unsigned threads) {
+    FILE* out = fopen(path.c_str(), "wb");
+    if (!out) return false;
+
+    fputs("date;board;tier;", out);
+    for (uint8_t f = 0; f < FIELD_COUNT; f++) fprintf(out, "%s;", FIELD_SPECS[f].column);
+    fputs("qualite;\n", out);
+
+    // Formatage en parallèle par blocs de lignes, écriture dans l'ordre
+    const size_t blockRows = 1 << 16;
+    size_t blocks = (rows.size() + blockRows - 1) / blockRows;
+    bool ok = true;
+    for (size_t first = 0; first < blocks && ok; first += threads) {
+        size_t count = std::min<size_t>(threads, blocks - first);
+        std::vector<std::string> text(count);
+        parallelFor(count, threads, [&](size_t b) {
+            size_t begin = (first + b) * blockRows;
+            size_t end = std::min(rows.size(), begin + blockRows);
+            std::string& buffer = text[b];
+            buffer.resize((end - begin) * 96);
+            char* p = &buffer[0];
+            for (size_t r = begin; r < end; r++) {
+                const Row& row = rows[r];
+                p = appendIsoTime(p, row.time);
+                *p++ = ';';
+                for (const char* name = boardName(row.board); *name; ) *p++ = *name++;
+                *p++ = ';';
+                for (const char* name = TIER_NAMES[row.tier]; *name; ) *p++ = *name++;
+                *p++ = ';';
+                for (uint8_t f = 0; f < FIELD_COUNT; f++) p = appendCenti(p, row.values[f]);
+                if (row.quality != QUALITY_UNKNOWN) {
+                    for (uint8_t f = 0; f < FIELD_COUNT; f++) {
+                        *p++ = QUALITY_LETTERS[std::min<uint8_t>(qualityCode(row.quality, f), QUALITY_CODE_COUNT - 1)];
+                    }
+                }
+                *p++ = ';';
+                *p++ = '\n';
+            }
+            buffer.resize(p - &buffer[0]);
+        });
+        for (size_t b = 0; b < count && ok; b++) {
+            ok = fwrite(text[b].data(), 1, text[b].size(), out) == text[b].size();
+        }
+    }
+    return fclose(out) == 0 && ok;
+}
+
+// Format colonnes (petit boutiste) :
+//   "SDCOL1\0\0"                       magie, 8 octets
+//   uint32 colonnes, uint32 nul, uint64 lignes
+//   par colonne : char nom[16], uint8 type (1 = u8, 2 = u16, 4 = i32, 5 = u32), 7 octets nuls
+//   puis les colonnes l'une après l'autre, chacune complétée à 8 octets
+// Valeurs en centièmes (INT32_MIN si absente), qualité 0xFFFF si inconnue.
+enum ColumnType : uint8_t { COL_U8 = 1, COL_U16 = 2, COL_I32 = 4, COL_U32 = 5 };
+
+struct ColumnHeader {
+    char name[16];
+    uint8_t type;
+    uint8_t reserved[7];
+};
+
+template <typename T, typename Get>
+static bool writeColumn(FILE* out, const std::vector<Row>& rows, Get get) {
+    std::vector<T> column(rows.size());
+    for (size_t r = 0; r < rows.size(); r++) column[r] = get(rows[r]);
+    size_t bytes = column.size() * sizeof(T);
+    static const uint8_t padding[8] = {0};
+    return fwrite(column.data(), 1, bytes, out) == bytes &&
+           fwrite(padding, 1, (8 - bytes % 8) % 8, out) == (8 - bytes % 8) % 8;
+}
+
+static bool writeColumns(const std::string& path, const std::vector<Row>& rows) {
+    FILE* out = fopen(path.c_str(), "wb");
+    if (!out) return false;
+
+    const uint32_t columns = 4 + FIELD_COUNT;
+    const uint32_t reserved = 0;
+    uint64_t count = rows.size();
+    bool ok = fwrite("SDCOL1\0\0", 1, 8, out) == 8 &&
+              fwrite(&columns, sizeof(columns), 1, out) == 1 &&
+              fwrite(&reserved, sizeof(reserved), 1, out) == 1 &&
+              fwrite(&count, sizeof(count), 1, out) == 1;
+
+    const char* names[4] = {"time", "board", "tier", "quality"};
+    const uint8_t types[4] = {COL_U32, COL_U8, COL_U8, COL_U16};
+    for (uint32_t c = 0; c < columns && ok; c++) {
+        ColumnHeader header;
+        memset(&header, 0, sizeof(header));
+        strncpy(header.name, c < 4 ? names[c] : FIELD_SPECS[c - 4].column, sizeof(header.name) - 1);
+        header.type = c < 4 ? types[c] : (uint8_t)COL_I32;
+        ok = fwrite(&header, sizeof(header), 1, out) == 1;
+    }
+
+    ok = ok && writeColumn<uint32_t>(out, rows, [](const Row& row) { return row.time; });
+    ok = ok && writeColumn<uint8_t>(out, rows, [](const Row& row) { return row.board; });
+    ok = ok && writeColumn<uint8_t>(out, rows, [](const Row& row) { return row.tier; });
+    ok = ok && writeColumn<uint16_t>(out, rows, [](const Row& row) { return row.quality; });
+    for (uint8_t f = 0; f < FIELD_COUNT && ok; f++) {
+        ok = writeColumn<int32_t>(out, rows, [f](const Row& row) { return row.values[f]; });
+    }
+    return fclose(out) == 0 && ok;
+}
+
+// ==========================================
+// LIGNE DE COMMANDE
+// ==========================================
+struct Options {
+    std::string out = "timeline";
+    unsigned threads = 0;               // 0 = un par cœur
+    bool csv = true;
+    bool columns = true;
+    std::vector<std::string> roots;
+};
+
+static void printUsage() {
+    printf("Usage: sdingest [--out <prefix>] [--threads <n>] [--format csv|col|both] <root>...\n\n");
+    printf("  <root>      mounted SD card or copy of its files (several cards are merged)\n");
+    printf("  --out       output prefix (<prefix>.csv, <prefix>.col), default \"timeline\"\n");
+    printf("  --threads   worker threads, default one per core\n");
+    printf("  --format    outputs to write, default both\n");
+}
+
+static bool parseArgs(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+            printUsage();
+            exit(0);
+        }
+        if (strncmp(arg, "--", 2) != 0) {
+            options.roots.push_back(arg);
+            continue;
+        }
+        if (i + 1 >= argc) {
+            fprintf(stderr, "[INGEST] Missing value for %s\n", arg);
+            return false;
+        }
+        const char* value = argv[++i];
+        if (strcmp(arg, "--out") == 0) {
+            options.out = value;
+        } else if (strcmp(arg, "--threads") == 0) {
+            char* end;
+            long threads = strtol(value, &end, 10);
+            if (*end != '\0' || threads < 1 || threads > 1024) {
+                fprintf(stderr, "[INGEST] Bad value for --threads: %s\n", value);
+                return false;
+            }
+            options.threads = (unsigned)threads;
+        } else if (strcmp(arg, "--format") == 0) {
+            options.csv = strcmp(value, "csv") == 0 || strcmp(value, "both") == 0;
+            options.columns = strcmp(value, "col") == 0 || strcmp(value, "both") == 0;
+            if (!options.csv && !options.columns) {
+                fprintf(stderr, "[INGEST] Bad value for --format: %s\n", value);
+                return false;
+            }
+        } else {
+            fprintf(stderr, "[INGEST] Unknown option: %s\n", arg);
+            return false;
+        }
+    }
+    if (options.roots.empty()) {
+        fprintf(stderr, "[INGEST] No input directory\n");
+        return false;
+    }
+    return true;
+}
+
+// ==========================================
+// MAIN
+// ==========================================
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseArgs(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+    if (options.threads == 0) options.threads = std::max(1u, std::thread::hardware_concurrency());
+    std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+
+    // Les fichiers ne bougent plus : les tâches gardent un pointeur sur eux
+    std::vector<MappedFile> files;
+    for (const std::string& root : options.roots) findFiles(root, files);
+    if (files.empty()) {
+        fprintf(stderr, "[INGEST] No SD files found\n");
+        return 1;
+    }
+
+    uint64_t inputBytes = 0;
+    std::vector<Task> tasks;
+    for (MappedFile& file : files) {
+        inputBytes += file.size;
+        splitFile(file, tasks);
+    }
+
+    parallelFor(tasks.size(), options.threads, [&](size_t i) {
+        Task& task = tasks[i];
+        if (task.file->blocks) {
+            readBlocks(task);
+        } else {
+            readCsvChunk(task);
+        }
+        if (!std::is_sorted(task.rows.begin(), task.rows.end(), rowBefore)) {
+            std::stable_sort(task.rows.begin(), task.rows.end(), rowBefore);
+        }
+    });
+    std::chrono::steady_clock::time_point parsed = std::chrono::steady_clock::now();
+
+    IngestStats stats;
+    std::vector<std::vector<Row> > runs;
+    for (Task& task : tasks) {
+        stats.rows += task.stats.rows;
+        stats.repaired += task.stats.repaired;
+        stats.dropped += task.stats.dropped;
+        if (!task.rows.empty()) runs.push_back(std::vector<Row>());
+        if (!task.rows.empty()) runs.back().swap(task.rows);
+    }
+    for (MappedFile& file : files) unmapFile(file);
+
+    std::vector<Row> rows = mergeRuns(runs, options.threads);
+    size_t unique = std::unique(rows.begin(), rows.end(), sameKey) - rows.begin();
+    uint64_t duplicates = rows.size() - unique;
+    rows.resize(unique);
+
+    bool ok = true;
+    if (options.csv && !writeCsv(options.out + ".csv", rows, options.threads)) {
+        fprintf(stderr, "[INGEST] Cannot write %s.csv\n", options.out.c_str());
+        ok = false;
+    }
+    if (options.columns && !writeColumns(options.out + ".col", rows)) {
+        fprintf(stderr, "[INGEST] Cannot write %s.col\n", options.out.c_str());
+        ok = false;
+    }
+
+    double parseS = std::chrono::duration<double>(parsed - started).count();
+    double totalS = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    printf("sdingest: %zu files, %.1f MB, %u threads\n", files.size(), inputBytes / 1e6, options.threads);
+    printf("  rows        %llu read, %llu duplicates, %zu written\n",
+           (unsigned long long)stats.rows, (unsigned long long)duplicates, rows.size());
+    printf("  torn lines  %llu repaired, %llu dropped\n",
+           (unsigned long long)stats.repaired, (unsigned long long)stats.dropped);
+    if (!rows.empty()) {
+        char first[ISO8601_LENGTH + 1];
+        char last[ISO8601_LENGTH + 1];
+        formatISO8601(first, epochToDateTime(rows.front().time));
+        formatISO8601(last, epochToDateTime(rows.back().time));
+        printf("  span        %s -> %s\n", first, last);
+    }
+    printf("  time        %.2f s parse (%.0f MB/s), %.2f s total\n",
+           parseS, parseS > 0 ? inputBytes / 1e6 / parseS : 0.0, totalS);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,31 @@
+# Ingestion des deux cartes de test/ et comparaison avec expected.csv :
+#   cardA  ligne tronquée suivie d'une mesure collée (réparée), ligne coupée
+#          avant sa colonne qualité, code qualité inconnu, valeur hors int32
+#   cardB  mesures déjà présentes sur cardA (doublons), puis une nouvelle
+# Appelé par ctest : cmake -DSDINGEST=... -DFIXTURE=... -DOUT=... -P check_fixture.cmake
+
+execute_process(
+  COMMAND ${SDINGEST} --threads 2 --format csv --out ${OUT} ${FIXTURE}/cardA ${FIXTURE}/cardB
+  RESULT_VARIABLE result
+  OUTPUT_VARIABLE output
+)
+message("${output}")
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "sdingest failed (${result})")
+endif()
+
+if(NOT output MATCHES "7 read, 2 duplicates, 5 written")
+  message(FATAL_ERROR "unexpected row counts")
+endif()
+if(NOT output MATCHES "1 repaired, 1 dropped")
+  message(FATAL_ERROR "unexpected torn line counts")
+endif()
+
+execute_process(
+  COMMAND ${CMAKE_COMMAND} -E compare_files ${OUT}.csv ${FIXTURE}/expected.csv
+  RESULT_VARIABLE different
+)
+if(different)
+  file(READ ${OUT}.csv actual)
+  message(FATAL_ERROR "${OUT}.csv differs from expected.csv:\n${actual}")
+endif()